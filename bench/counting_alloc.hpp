@@ -0,0 +1,77 @@
+#ifndef COUNTING_ALLOC_HPP
+#define COUNTING_ALLOC_HPP
+
+/*
+ * Description: Replaces the global `operator new` and `operator delete` with versions that count heap allocations, for the
+ * allocation benchmarks. Every form of `new` (plain, array, aligned, nothrow) takes its block from `malloc` or `aligned_alloc`,
+ * and every form of `delete` gives it back with `free`, so any pairing the library makes is a matching one.
+ *
+ * The replacements are ordinary (non-inline) definitions, as the standard requires, so include this header in the one source
+ * file of a benchmark and nowhere else.
+ *
+ * Both ends are kept out of line: once either is inlined into a caller, GCC sees `free` applied to the result of a `new`
+ * expression (or `delete` to the result of `malloc`) and warns with -Wmismatched-new-delete, although the pair matches.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace counting_alloc {
+
+inline std::atomic<size_t> allocations{0};  // Blocks handed out since the start of the process
+
+// Heap allocations made by `work`
+template<typename Work>
+size_t count(Work work){
+    size_t before=allocations.load(std::memory_order_relaxed);
+    work();
+    return allocations.load(std::memory_order_relaxed)-before;
+}
+
+[[gnu::noinline]] inline void* take(std::size_t size){
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+[[gnu::noinline]] inline void* take(std::size_t size, std::align_val_t align){
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t alignment=static_cast<size_t>(align);
+    return std::aligned_alloc(alignment, (size+alignment-1)/alignment*alignment);
+}
+
+[[gnu::noinline]] inline void give_back(void* p) noexcept {
+    std::free(p);
+}
+
+inline void* checked(void* p){
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+
+}
+
+void* operator new(std::size_t size){ return counting_alloc::checked(counting_alloc::take(size)); }
+void* operator new[](std::size_t size){ return counting_alloc::checked(counting_alloc::take(size)); }
+void* operator new(std::size_t size, std::align_val_t align){ return counting_alloc::checked(counting_alloc::take(size, align)); }
+void* operator new[](std::size_t size, std::align_val_t align){ return counting_alloc::checked(counting_alloc::take(size, align)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counting_alloc::take(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counting_alloc::take(size); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return counting_alloc::take(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return counting_alloc::take(size, align); }
+
+[[gnu::noinline]] void operator delete(void* p) noexcept { counting_alloc::give_back(p); }
+[[gnu::noinline]] void operator delete[](void* p) noexcept { counting_alloc::give_back(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { counting_alloc::give_back(p); }
+[[gnu::noinline]] void operator delete[](void* p, std::size_t) noexcept { counting_alloc::give_back(p); }
+[[gnu::noinline]] void operator delete(void* p, std::align_val_t) noexcept { counting_alloc::give_back(p); }
+[[gnu::noinline]] void operator delete[](void* p, std::align_val_t) noexcept { counting_alloc::give_back(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t, std::align_val_t) noexcept { counting_alloc::give_back(p); }
+[[gnu::noinline]] void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { counting_alloc::give_back(p); }
+[[gnu::noinline]] void operator delete(void* p, const std::nothrow_t&) noexcept { counting_alloc::give_back(p); }
+[[gnu::noinline]] void operator delete[](void* p, const std::nothrow_t&) noexcept { counting_alloc::give_back(p); }
+[[gnu::noinline]] void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { counting_alloc::give_back(p); }
+[[gnu::noinline]] void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { counting_alloc::give_back(p); }
+
+#endif
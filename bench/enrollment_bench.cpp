@@ -0,0 +1,89 @@
+/*
+ * Description: The enrollment check behind `/join_classroom_post` and the quiz attempt routes. For classes of a few sizes it
+ * times a first-week rush, R students joining an empty class one after another (check, then insert), and R "is this student
+ * enrolled" checks against the full class. Each is run on a plain `std::vector<symbol_id>` searched with `std::find`, as the join
+ * route used to do, and on the `roster_set` the classrooms use now. Best of five rounds.
+ *
+ * Usage: enrollment_bench [largest_class]   (default 5000)
+ */
+
+#include "RosterSet.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The roster as it was: join order only
+struct vector_roster {
+    std::vector<symbol_id> order;
+
+    bool contains(symbol_id student) const { return std::find(order.begin(), order.end(), student)!=order.end(); }
+
+    bool insert(symbol_id student){
+        if(contains(student)) return false;
+        order.push_back(student);
+        return true;
+    }
+};
+
+// Microseconds for the best of five runs of `work`
+template<typename Work>
+double best_us(Work work){
+    double best=1e18;
+    for(int r=0;r<5;r++){
+        auto start=std::chrono::steady_clock::now();
+        work();
+        best=std::min(best, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now()-start).count());
+    }
+    return best;
+}
+
+template<typename Roster>
+void run(const char* label, const std::vector<symbol_id>& joining, const std::vector<symbol_id>& checks){
+    size_t joined=0, enrolled=0;
+    Roster full;
+    double rush=best_us([&]{
+        Roster roster;
+        joined=0;
+        for(symbol_id student:joining) joined+=roster.insert(student);
+        full=roster;
+    });
+    double check=best_us([&]{
+        enrolled=0;
+        for(symbol_id student:checks) enrolled+=full.contains(student);
+    });
+    std::cout<<"    "<<std::left<<std::setw(12)<<label<<std::right<<std::fixed<<std::setprecision(1)
+             <<"join rush "<<std::setw(10)<<rush<<" us   "<<std::setw(6)<<checks.size()<<" checks "<<std::setw(8)<<check<<" us"
+             <<"  ("<<joined<<" joined, "<<enrolled<<" enrolled)\n";
+}
+
+}
+
+int main(int argc, char** argv){
+    size_t largest=argc>1 ? std::stoul(argv[1]) : 5000;
+    std::mt19937 rng(21);
+
+    // Students are interned in signup order, not in the order they join a class
+    std::vector<symbol_id> students;
+    for(size_t i=0;i<2*largest;i++) students.push_back(symbol_table::instance().intern("student_"+std::to_string(i)));
+
+    for(size_t size:{size_t(30), size_t(300), size_t(2000), largest}){
+        if(size>largest) continue;
+        std::vector<symbol_id> joining(students.begin(), students.end());
+        std::shuffle(joining.begin(), joining.end(), rng);
+        joining.resize(size);
+        // Half the checks are for enrolled students (attempting a quiz), half for others (a join to be accepted)
+        std::vector<symbol_id> checks;
+        for(size_t i=0;i<size;i++) checks.push_back(i%2 ? joining[rng()%size] : students[rng()%students.size()]);
+
+        std::cout<<"class of "<<size<<"\n";
+        run<vector_roster>("std::find", joining, checks);
+        run<roster_set>("roster_set", joining, checks);
+        if(size==largest) break;
+    }
+}
@@ -0,0 +1,132 @@
+/*
+ * Description: Checks that the generic `EntityTable` (see `EntityTable.hpp`) is no slower than the hand-written tables it
+ * replaced. For each storage layout it loads N records into an `EntityTable` and into a bare storage driven the way the old
+ * tables drove it (hash the key, `find` with an inline equality lambda), then times the same random lookups through both,
+ * alternating for a few rounds and reporting the best of each:
+ *   - users keyed by interned username, looked up by the text of the name (`symbol_hash`),
+ *   - quizzes keyed by `entity_id` (`entity_id_hash`).
+ * The tables use `no_persist`, so nothing is read from or written to disk.
+ *
+ * Usage: entity_table_bench [record_count]   (default 250000)
+ */
+
+#include "EntityTable.hpp"
+#include "FlatStorage.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Stand-ins for `student_data` and `quiz_data` with the same key fields
+struct bench_user {
+    symbol_id username;
+    std::string name;
+    std::string email;
+
+    bench_user(std::string_view theusername, std::string_view thename, std::string_view theemail):
+    username(symbol_table::instance().intern(theusername)), name(thename), email(theemail){}
+};
+
+struct bench_quiz {
+    entity_id quizId;
+    std::string quizTitle;
+
+    bench_quiz(entity_id id, std::string_view title): quizId(id), quizTitle(title){}
+};
+
+symbol_id entity_key(const bench_user& u){ return u.username; }
+entity_id entity_key(const bench_quiz& q){ return q.quizId; }
+
+template<typename Lookup, typename Key>
+double time_lookups(const std::vector<Key>& keys, size_t& hits, Lookup lookup){
+    auto start=std::chrono::steady_clock::now();
+    for(const auto& key:keys){
+        if(lookup(key)) hits++;
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-start).count()/keys.size();
+}
+
+// Times the two lookups alternately for a few rounds and keeps each one's best, so neither benefits from running second
+template<typename Key, typename Hand, typename Generic>
+void compare(const char* label, const std::vector<Key>& keys, Hand hand, Generic generic){
+    const int rounds=5;
+    double hand_ns=1e9, generic_ns=1e9;
+    size_t hand_hits=0, generic_hits=0;
+    for(int r=0;r<rounds;r++){
+        hand_hits=generic_hits=0;
+        hand_ns=std::min(hand_ns, time_lookups(keys, hand_hits, hand));
+        generic_ns=std::min(generic_ns, time_lookups(keys, generic_hits, generic));
+    }
+    std::cout<<label<<": hand-written "<<hand_ns<<" ns, EntityTable "<<generic_ns<<" ns ("<<hand_hits<<"/"<<generic_hits<<" hits)\n";
+}
+
+template<template<typename> class Storage>
+void run_users(const char* label, size_t n, const std::vector<std::string>& keys){
+    // Hand-written: the old user_hashTable's storage, hash and equality lambda
+    slab_pool<bench_user> records;
+    Storage<bench_user*> storage(100);
+    EntityTable<symbol_id, bench_user, symbol_hash, Storage, no_persist> table(100);
+    for(size_t i=0;i<n;i++){
+        std::string username="student_"+std::to_string(i);
+        bench_user* u=records.create(username, "Name", username+"@example.edu");
+        storage.insert(key_hash::hash(u->username.view()), u);
+        table.emplace(username, "Name", username+"@example.edu");
+    }
+
+    compare((std::string(label)+" users by name ").c_str(), keys, [&storage](const std::string& s){
+        std::string_view key(s);
+        bench_user* found=nullptr;
+        return storage.find(key_hash::hash(key), [key](bench_user* u){ return u->username.view()==key; }, found);
+    }, [&table](const std::string& s){
+        return table.find(std::string_view(s))!=nullptr;
+    });
+    storage.for_each([&records](bench_user* u){ records.destroy(u); });
+}
+
+template<template<typename> class Storage>
+void run_quizzes(const char* label, const std::vector<entity_id>& ids, const std::vector<entity_id>& keys){
+    slab_pool<bench_quiz> records;
+    Storage<bench_quiz*> storage(100);
+    EntityTable<entity_id, bench_quiz, entity_id_hash, Storage, no_persist> table(100);
+    for(entity_id id:ids){
+        bench_quiz* q=records.create(id, "Quiz");
+        storage.insert(id.hash(), q);
+        table.emplace(id, "Quiz");
+    }
+
+    compare((std::string(label)+" quizzes by id").c_str(), keys, [&storage](entity_id id){
+        bench_quiz* found=nullptr;
+        return storage.find(id.hash(), [id](bench_quiz* q){ return q->quizId==id; }, found);
+    }, [&table](entity_id id){
+        return table.find(id)!=nullptr;
+    });
+    storage.for_each([&records](bench_quiz* q){ records.destroy(q); });
+}
+
+}
+
+int main(int argc, char** argv){
+    size_t n=argc>1 ? std::stoul(argv[1]) : 250000;
+    std::mt19937 rng(42);
+
+    // Lookups in random order, half of them misses
+    std::vector<std::string> user_keys;
+    for(size_t i=0;i<n;i++) user_keys.push_back("student_"+std::to_string(rng()%(2*n)));
+
+    std::vector<entity_id> ids;
+    for(size_t i=0;i<n;i++) ids.push_back(entity_id::random(rng));
+    std::vector<entity_id> quiz_keys;
+    for(size_t i=0;i<n;i++) quiz_keys.push_back(rng()%2 ? ids[rng()%n] : entity_id::random(rng));
+
+    std::cout<<n<<" records, lookups in ns each\n";
+    run_users<chained_storage>("chained_storage", n, user_keys);
+    run_users<flat_storage>("flat_storage   ", n, user_keys);
+    run_quizzes<chained_storage>("chained_storage", ids, quiz_keys);
+    run_quizzes<flat_storage>("flat_storage   ", ids, quiz_keys);
+    run_quizzes<rcu_storage>("rcu_storage    ", ids, quiz_keys);
+}
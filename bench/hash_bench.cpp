@@ -0,0 +1,96 @@
+/*
+ * Description: Microbenchmark of the two hash policies in `KeyHash.hpp` (`word_hash` and the original `fnv1a_hash`) on keys shaped like
+ * the ones the tables really hold:
+ *   - usernames such as "Abhishek_111" (first name, underscore, digits),
+ *   - institute emails such as "106124018@nitt.edu" (9-digit roll number, fixed domain),
+ *   - 6-character class codes / quiz IDs, hashed as text (old tables) and as `entity_id` integers (current tables).
+ * For each set it reports nanoseconds per hash and the bucket spread at the tables' 0.75 load factor: the longest chain and the
+ * share of empty buckets, next to the share an ideal random hash would leave empty (e^-load).
+ *
+ * Usage: hash_bench [key_count]   (default 200000)
+ */
+
+#include "KeyHash.hpp"
+#include "EntityId.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> make_usernames(size_t n, std::mt19937& rng){
+    const char* names[]={"Abhishek", "Ankit", "Yuvraj", "Priya", "Rahul", "Sneha", "Arjun", "Kavya", "Rohan", "Isha", "Aditya", "Meera"};
+    std::vector<std::string> keys;
+    for(size_t i=0;i<n;i++){
+        keys.push_back(std::string(names[rng()%12])+"_"+std::to_string(i));
+    }
+    return keys;
+}
+
+std::vector<std::string> make_emails(size_t n){
+    std::vector<std::string> keys;
+    for(size_t i=0;i<n;i++){
+        // Roll numbers are dense: batch prefix plus a sequence number
+        keys.push_back(std::to_string(106120000+i)+"@nitt.edu");
+    }
+    return keys;
+}
+
+std::vector<entity_id> make_ids(size_t n, std::mt19937& rng){
+    std::vector<entity_id> ids;
+    for(size_t i=0;i<n;i++) ids.push_back(entity_id::random(rng));
+    return ids;
+}
+
+template<typename Key, typename HashFn>
+void measure(const char* label, const std::vector<Key>& keys, HashFn hash_fn){
+    // Timing: several passes so short keys are measurable
+    const int passes=20;
+    uint32_t sink=0;
+    auto start=std::chrono::steady_clock::now();
+    for(int p=0;p<passes;p++){
+        for(const auto& key:keys) sink^=hash_fn(key);
+    }
+    double ns=std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-start).count()/(passes*keys.size());
+
+    // Spread: same bucket count rule as the storages (power of two, load <= 0.75)
+    size_t buckets=64;
+    while(keys.size()*4>buckets*3) buckets<<=1;
+    std::vector<uint32_t> chain(buckets, 0);
+    for(const auto& key:keys) chain[hash_fn(key)&(buckets-1)]++;
+    uint32_t longest=*std::max_element(chain.begin(), chain.end());
+    double empty=100.0*std::count(chain.begin(), chain.end(), 0u)/buckets;
+    double ideal=100.0*std::exp(-static_cast<double>(keys.size())/buckets);
+
+    std::cout<<std::left<<std::setw(30)<<label<<std::fixed<<std::setprecision(2)
+             <<std::setw(8)<<ns<<" ns/hash   longest chain "<<std::setw(3)<<longest
+             <<"  empty buckets "<<std::setprecision(1)<<empty<<"% (ideal "<<ideal<<"%)"<<(sink==42 ? " " : "")<<"\n";
+}
+
+}
+
+int main(int argc, char** argv){
+    size_t n=argc>1 ? std::stoul(argv[1]) : 200000;
+    std::mt19937 rng(7);
+
+    std::vector<std::string> usernames=make_usernames(n, rng);
+    std::vector<std::string> emails=make_emails(n);
+    std::vector<entity_id> ids=make_ids(n, rng);
+    std::vector<std::string> id_texts;
+    for(entity_id id:ids) id_texts.push_back(id.to_string());
+
+    std::cout<<n<<" keys per set\n";
+    measure("usernames   fnv1a", usernames, [](const std::string& k){ return fnv1a_hash::hash(k); });
+    measure("usernames   word_hash", usernames, [](const std::string& k){ return word_hash::hash(k); });
+    measure("emails      fnv1a", emails, [](const std::string& k){ return fnv1a_hash::hash(k); });
+    measure("emails      word_hash", emails, [](const std::string& k){ return word_hash::hash(k); });
+    measure("codes text  fnv1a", id_texts, [](const std::string& k){ return fnv1a_hash::hash(k); });
+    measure("codes text  word_hash", id_texts, [](const std::string& k){ return word_hash::hash(k); });
+    measure("codes int   fnv1a (fmix32)", ids, [](entity_id k){ return fnv1a_hash::hash(k.value); });
+    measure("codes int   word_hash", ids, [](entity_id k){ return word_hash::hash(k.value); });
+}
@@ -0,0 +1,179 @@
+/*
+ * Description: Heap allocations made while importing data into the tables: a quiz of Q questions created through
+ * `/create_quiz_post`, the same quiz loaded from an old-format quizzes.json (questions inline), and students, classrooms and
+ * results loaded from their files. Global `operator new` is replaced with a counting version.
+ *
+ * For each file the count of parsing it alone is reported next to the count of loading the table from it; the difference is
+ * what the loader itself allocates on top of the parsed document. Loaders move strings and arrays out of the document, so
+ * this should come down to the records' own blocks (slab pages, the question store, credentials, index nodes).
+ * For `/create_quiz_post` the form parsing is replayed both ways: copying each parsed `Question` into the list, and as the route
+ * does it, with the options reserved and each `Question` moved.
+ *
+ * Usage: import_alloc_bench [question_count] [record_count] [scratch_dir]   (defaults 10000 10000 ./import_alloc_bench_data)
+ */
+
+#include "users.hpp"
+#include "Classroom.hpp"
+#include "Quiz.hpp"
+#include "QuizAttempt.hpp"
+#include "counting_alloc.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+using counting_alloc::count;
+
+// The server defines these in source/*.cpp, which pull in Crow; the benchmark only needs the tables to save on exit
+void to_json(njson& j, const student_data& s){
+    j=njson{{"name", s.name}, {"email", s.credentials->email}, {"password", s.credentials->password}, {"username", s.username}, {"classroomIds", s.classroomIds}};
+}
+
+void to_json(njson& j, const teacher_data& s){
+    j=njson{{"name", s.name}, {"email", s.credentials->email}, {"password", s.credentials->password}, {"username", s.username}, {"classroomIds", s.classroomIds}};
+}
+
+void to_json(njson& j, const classroom_data& c){
+    std::shared_lock<std::shared_mutex> guard(c.lock);
+    j=njson{{"class_name", c.class_name}, {"subject", c.subject}, {"class_code", c.class_code}, {"teacher_username", c.teacher_username},
+            {"student_usernames", c.student_usernames}, {"quizIds", c.quizIds}};
+}
+
+void to_json(njson& j, const quiz_data& q){
+    j=njson{{"quizId", q.quizId}, {"quizTitle", q.quizTitle}, {"classroomId", q.classroomId}, {"timeLimitMinutes", q.timeLimitMins},
+            {"questions", q.questions}};
+}
+
+namespace {
+
+void report(const char* what, size_t made){
+    std::cout<<"  "<<std::left<<std::setw(46)<<what<<std::right<<std::setw(9)<<made<<" allocations\n";
+}
+
+// Reports the allocations of parsing `path` alone and of building `Table` from it. The table saves itself when it is
+// destroyed, outside the count.
+template<typename Table>
+void report_load(const std::string& label, const char* path){
+    std::cout<<label<<"\n";
+    size_t parse=count([path]{
+        std::ifstream file(path);
+        njson data;
+        file>>data;
+    });
+    std::optional<Table> table;
+    size_t load=count([&table]{ table.emplace(); });
+    table.reset();
+    report("parse the file", parse);
+    report("load the table (parse included)", load);
+    report("loader beyond the parse", load-parse);
+}
+
+std::string question_text(size_t i){
+    return "Question "+std::to_string(i)+": which of these gives O(1) average-case lookup by key?";
+}
+
+std::string option_text(size_t i, size_t j){
+    return "Option "+std::to_string(j)+" of question "+std::to_string(i)+", long enough to leave the small-string buffer";
+}
+
+}
+
+int main(int argc, char** argv){
+    size_t question_count=argc>1 ? std::stoul(argv[1]) : 10000;
+    size_t record_count=argc>2 ? std::stoul(argv[2]) : 10000;
+    std::filesystem::path dir=argc>3 ? argv[3] : "import_alloc_bench_data";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir/"Data");
+    std::filesystem::current_path(dir);
+    std::mt19937 rng(22);
+
+    // The form fields of /create_quiz_post as Crow hands them over: one C string per field
+    std::vector<std::string> texts;
+    std::vector<std::string> options;
+    for(size_t i=0;i<question_count;i++){
+        texts.push_back(question_text(i));
+        for(size_t j=0;j<4;j++) options.push_back(option_text(i, j));
+    }
+    // `move` replays the route as it is (options reserved, each `Question` moved into the list); otherwise each is copied
+    auto parse_form=[&](bool move){
+        std::vector<Question> questions_list;
+        for(size_t i=0;i<question_count;i++){
+            Question new_question;
+            new_question.questionText=texts[i].c_str();
+            new_question.correctAnswerIndex=static_cast<int>(i%4);
+            if(move) new_question.options.reserve(4);
+            for(size_t j=0;j<4;j++) new_question.options.emplace_back(options[4*i+j].c_str());
+            if(move) questions_list.push_back(std::move(new_question));
+            else questions_list.push_back(new_question);
+        }
+        return questions_list;
+    };
+
+    std::cout<<"POST /create_quiz_post, "<<question_count<<" questions of 4 options\n";
+    report("parse the form, copying each Question", count([&]{ parse_form(false); }));
+    report("parse the form, moving each Question", count([&]{ parse_form(true); }));
+    {
+        std::vector<Question> questions_list=parse_form(true);
+        std::string quiz_title="Imported question bank";
+        quiz_hashTable quiz_table;
+        report("createQuiz", count([&]{ quiz_table.createQuiz(quiz_title, entity_id::from_string("PSHVJ9"), 30, questions_list); }));
+        std::vector<int> answers(question_count, 1);
+        quiz_result_hashTable results_table;
+        report("addResult (one answer per question)", count([&]{ results_table.addResult(entity_id::from_string("K2M0QX"), "student_0", 0, 60.0, std::move(answers)); }));
+    }
+    std::filesystem::remove("Data/quizzes.json");
+    std::filesystem::remove("Data/questions.json");
+    std::filesystem::remove("Data/quiz_results.json");
+
+    // The same quiz in the old inline format, as an import from another install would bring it
+    {
+        njson questions=njson::array();
+        for(size_t i=0;i<question_count;i++){
+            questions.push_back({{"questionText", texts[i]}, {"options", {options[4*i], options[4*i+1], options[4*i+2], options[4*i+3]}},
+                                 {"correctAnswerIndex", static_cast<int>(i%4)}});
+        }
+        njson quiz={{"quizId", "Q1ZZ01"}, {"quizTitle", "Imported question bank"}, {"classroomId", "PSHVJ9"}, {"timeLimitMinutes", 30},
+                    {"questions", std::move(questions)}};
+        std::ofstream("Data/quizzes.json")<<njson::array({quiz}).dump(4);
+    }
+
+    njson students=njson::array();
+    njson rooms=njson::array();
+    njson results=njson::array();
+    for(size_t i=0;i<record_count;i++){
+        std::string username="student_with_a_long_username_"+std::to_string(i);
+        students.push_back({{"name", "Student Full Name "+std::to_string(i)}, {"username", username}, {"email", username+"@nitt.edu"},
+                            {"password", "a password longer than the buffer"}, {"classroomIds", {"PSHVJ9", "K2M0QX"}}});
+        std::vector<int> answers(25);
+        for(int& a:answers) a=static_cast<int>(rng()%4);
+        results.push_back({{"resultId", entity_id::random(rng)}, {"quizId", "Q1ZZ01"}, {"studentUsername", username}, {"score", 10},
+                           {"timeTakenSeconds", 600.0}, {"submittedAnswers", answers}});
+    }
+    for(size_t r=0;r<record_count/10;r++){
+        njson roster=njson::array();
+        njson quizIds=njson::array();
+        for(size_t s=0;s<30;s++) roster.push_back("student_with_a_long_username_"+std::to_string(rng()%record_count));
+        for(size_t q=0;q<10;q++) quizIds.push_back(entity_id::random(rng));
+        rooms.push_back({{"class_name", "Data Structures and Algorithms, section "+std::to_string(r)}, {"subject", "Computer Science and Engineering"},
+                         {"class_code", entity_id::random(rng)}, {"teacher_username", "teacher_with_a_long_username"},
+                         {"student_usernames", std::move(roster)}, {"quizIds", std::move(quizIds)}});
+    }
+    std::ofstream("Data/students.json")<<students.dump(4);
+    std::ofstream("Data/teachers.json")<<"[]";
+    std::ofstream("Data/classrooms.json")<<rooms.dump(4);
+    std::ofstream("Data/quiz_results.json")<<results.dump(4);
+    students=njson();
+    rooms=njson();
+    results=njson();
+    // Intern the usernames first, so the symbol table's own growth is not counted against any loader
+    { user_hashTable warm; }
+
+    report_load<quiz_hashTable>("quizzes.json, 1 quiz of "+std::to_string(question_count)+" inline questions", "Data/quizzes.json");
+    report_load<user_hashTable>("students.json, "+std::to_string(record_count)+" students", "Data/students.json");
+    report_load<classroom_hashTable>("classrooms.json, "+std::to_string(record_count/10)+" classrooms of 30", "Data/classrooms.json");
+    report_load<quiz_result_hashTable>("quiz_results.json, "+std::to_string(record_count)+" results", "Data/quiz_results.json");
+}
@@ -0,0 +1,88 @@
+/*
+ * Description: Login lookup latency as the user count grows. A login is the two lookups `/login_post` makes: email -> user in the
+ * `emails` index, then username -> record in the user table. For each user count it builds both maps with `chained_storage`,
+ * `flat_storage` and `cuckoo_storage`, times every login of a random sample individually, and reports the median, p99, p99.9 and
+ * worst case. With cuckoo hashing each lookup reads at most two buckets, so its tail should not move as the table grows.
+ *
+ * Usage: login_bench [max_users] [logins_per_size]   (defaults 1000000 and 200000; sizes go up by 10x from 10000)
+ */
+
+#include "HashStorage.hpp"
+#include "FlatStorage.hpp"
+#include "CuckooStorage.hpp"
+#include "KeyHash.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Stand-in for a user record: the two keys login looks up, plus the rest of the record's size
+struct login_record {
+    std::string username;
+    std::string email;
+    std::string name;
+    std::string password;
+};
+
+template<template<typename> class Storage>
+void run(const char* label, const std::vector<login_record*>& users, const std::vector<size_t>& sample){
+    Storage<login_record*> emails(100);
+    Storage<login_record*> usernames(100);
+    emails.reserve(users.size());
+    usernames.reserve(users.size());
+    for(login_record* u:users){
+        emails.insert(key_hash::hash(u->email), u);
+        usernames.insert(key_hash::hash(u->username), u);
+    }
+
+    std::vector<double> ns;
+    ns.reserve(sample.size());
+    size_t ok=0;
+    for(size_t i:sample){
+        std::string_view email=users[i]->email;
+        auto start=std::chrono::steady_clock::now();
+        login_record* by_email=nullptr;
+        login_record* by_name=nullptr;
+        if(emails.find(key_hash::hash(email), [email](login_record* u){ return u->email==email; }, by_email)){
+            std::string_view name=by_email->username;
+            if(usernames.find(key_hash::hash(name), [name](login_record* u){ return u->username==name; }, by_name)) ok++;
+        }
+        ns.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-start).count());
+    }
+    std::sort(ns.begin(), ns.end());
+    auto pct=[&ns](double p){ return ns[std::min(ns.size()-1, static_cast<size_t>(p*ns.size()))]; };
+    std::cout<<"  "<<std::left<<std::setw(16)<<label<<std::fixed<<std::setprecision(0)
+             <<"p50 "<<std::setw(6)<<pct(0.50)<<"p99 "<<std::setw(6)<<pct(0.99)<<"p99.9 "<<std::setw(7)<<pct(0.999)
+             <<"max "<<std::setw(8)<<ns.back()<<" ns  ("<<ok<<" ok)\n";
+}
+
+}
+
+int main(int argc, char** argv){
+    size_t max_users=argc>1 ? std::stoul(argv[1]) : 1000000;
+    size_t logins=argc>2 ? std::stoul(argv[2]) : 200000;
+    std::mt19937 rng(11);
+
+    std::vector<login_record*> users;
+    for(size_t n=10000;n<=max_users;n*=10){
+        while(users.size()<n){
+            size_t i=users.size();
+            std::string username="student_"+std::to_string(i);
+            users.push_back(new login_record{username, std::to_string(106000000+i)+"@nitt.edu", "Full Name", "correct horse battery"});
+        }
+        std::vector<size_t> sample;
+        for(size_t i=0;i<logins;i++) sample.push_back(rng()%n);
+
+        std::cout<<n<<" users, "<<logins<<" logins\n";
+        run<chained_storage>("chained_storage", users, sample);
+        run<flat_storage>("flat_storage", users, sample);
+        run<cuckoo_storage>("cuckoo_storage", users, sample);
+    }
+    for(login_record* u:users) delete u;
+}
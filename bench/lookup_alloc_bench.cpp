@@ -0,0 +1,201 @@
+/*
+ * Description: Allocation count for the table lookups behind each read-only page. It fills the four tables with a few users,
+ * classrooms, quizzes and results in a scratch directory, then replays the find calls each route makes, with the keys in the
+ * form the route gets them (`const std::string&` path segment, `const char*` query parameter, `std::string` session value).
+ * Global `operator new` is replaced with a counting version, so every heap allocation made inside the table calls is counted.
+ * Single lookups should read 0: they hash the caller's `std::string_view` directly and never copy the key. A batched lookup
+ * (`findStudents`, `findQuizzes`) makes exactly one allocation, for the vector of results it returns. Walking a quiz's questions
+ * to render or grade it reads views into its shared question bodies and should also read 0.
+ *
+ * Only the table calls are measured. Crow's own work (copying the session value, building the mustache context, rendering the
+ * page) is outside the tables and is not counted.
+ *
+ * Usage: lookup_alloc_bench [scratch_dir]   (default ./lookup_alloc_bench_data)
+ */
+
+#include "users.hpp"
+#include "Classroom.hpp"
+#include "Quiz.hpp"
+#include "QuizAttempt.hpp"
+#include "counting_alloc.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using counting_alloc::allocations;
+
+// The server defines these in source/*.cpp, which pull in Crow; the benchmark only needs the tables to save on exit
+void to_json(njson& j, const student_data& s){
+    j=njson{{"name", s.name}, {"email", s.credentials->email}, {"password", s.credentials->password}, {"username", s.username}, {"classroomIds", s.classroomIds}};
+}
+
+void to_json(njson& j, const teacher_data& s){
+    j=njson{{"name", s.name}, {"email", s.credentials->email}, {"password", s.credentials->password}, {"username", s.username}, {"classroomIds", s.classroomIds}};
+}
+
+void to_json(njson& j, const classroom_data& c){
+    std::shared_lock<std::shared_mutex> guard(c.lock);
+    j=njson{{"class_name", c.class_name}, {"subject", c.subject}, {"class_code", c.class_code}, {"teacher_username", c.teacher_username},
+            {"student_usernames", c.student_usernames}, {"quizIds", c.quizIds}};
+}
+
+void to_json(njson& j, const Question& q){
+    j=njson{{"questionText", q.questionText}, {"options", q.options}, {"correctAnswerIndex", q.correctAnswerIndex}};
+}
+
+void from_json(const njson& j, Question& q){
+    q.questionText=j.value("questionText", "");
+    q.options=j.value("options", std::vector<std::string>{});
+    q.correctAnswerIndex=j.value("correctAnswerIndex", 0);
+}
+
+void to_json(njson& j, const quiz_data& q){
+    j=njson{{"quizId", q.quizId}, {"quizTitle", q.quizTitle}, {"classroomId", q.classroomId}, {"timeLimitMinutes", q.timeLimitMins},
+            {"questions", q.questions}};
+}
+
+namespace {
+
+// Runs `replay` and prints how many heap allocations its second run made. The first run warms the per-thread scratch
+// buffers of the batched lookups, which a server thread only grows on its first few requests.
+template<typename Replay>
+void count_route(const char* route, Replay replay){
+    replay();
+    size_t before=allocations.load(std::memory_order_relaxed);
+    size_t found=replay();
+    size_t made=allocations.load(std::memory_order_relaxed)-before;
+    std::cout<<std::left<<std::setw(34)<<route<<std::setw(4)<<made<<" allocations  ("<<found<<" records found)\n";
+}
+
+}
+
+int main(int argc, char** argv){
+    std::filesystem::path dir=argc>1 ? argv[1] : "lookup_alloc_bench_data";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir/"Data");
+    std::filesystem::current_path(dir);
+    // `user_hashTable` expects its files to exist; the other tables create theirs
+    std::ofstream("Data/students.json")<<"[]";
+    std::ofstream("Data/teachers.json")<<"[]";
+
+    {
+        user_hashTable user_table;
+        classroom_hashTable classroom_table;
+        quiz_hashTable quiz_table;
+        quiz_result_hashTable results_table;
+
+        // A teacher with two classrooms, a quiz in each, and a roster of students who have all attempted the first quiz.
+        // Usernames and emails are longer than the small-string buffer, so a copied key would always reach the heap.
+        teacher_data* teacher=user_table.addTeacher("Teacher Name", "teacher_with_a_long_username", "teacher.number.one@nitt.edu", "pw");
+        std::vector<Question> questions(3, Question{"What is 2 + 2?", {"3", "4", "5", "22"}, 1});
+        std::vector<entity_id> quiz_ids;
+        for(int c=0;c<2;c++){
+            entity_id code=classroom_table.addClassroom("Data Structures", "CS", teacher);
+            teacher->classroomIds.push_back(code);
+            quiz_data* quiz=quiz_table.createQuiz("Hashing", code, 10, questions);
+            classroom_table.findClassroom(code)->quizIds.push_back(quiz->quizId);
+            quiz_ids.push_back(quiz->quizId);
+        }
+        classroom_data* room=classroom_table.findClassroom(teacher->classroomIds.read()[0]);
+        for(int s=0;s<30;s++){
+            std::string username="student_with_a_long_username_"+std::to_string(s);
+            student_data* student=user_table.addStudent("Student Name", username, username+"@nitt.edu", "pw");
+            for(entity_id code:teacher->classroomIds.read()) student->classroomIds.push_back(code);
+            room->student_usernames.insert(student->username);
+            results_table.addResult(quiz_ids[0], username, 2, 60.0, {1, 1, 0});
+        }
+
+        // Keys as the routes receive them
+        const std::string session_username="student_with_a_long_username_7";
+        const std::string session_teacher="teacher_with_a_long_username";
+        const std::string login_email="student_with_a_long_username_7@nitt.edu";
+        const std::string path_class_code=room->class_code.to_string();
+        const std::string path_quiz_id=quiz_ids[0].to_string();
+        const char* query_class_code=path_class_code.c_str();
+
+        count_route("POST /login_post", [&]{
+            std::optional<std::string_view> user=user_table.findUsername(login_email);
+            return size_t(user.has_value()) + (user && user_table.findStudent(*user));
+        });
+        count_route("GET /student_dashboard", [&]{
+            size_t found=0;
+            student_data* student=user_table.findStudent(session_username);
+            found+=student!=nullptr;
+            for(entity_id code:student->classroomIds.read()) found+=classroom_table.findClassroom(code)!=nullptr;
+            return found;
+        });
+        count_route("GET /my_classrooms", [&]{
+            size_t found=0;
+            teacher_data* t=user_table.findTeacher(session_teacher);
+            found+=t!=nullptr;
+            for(entity_id code:t->classroomIds.read()) found+=classroom_table.findClassroom(code)!=nullptr;
+            return found;
+        });
+        count_route("GET /classroom/<code>", [&]{
+            size_t found=0;
+            classroom_data* r=classroom_table.findClassroom(path_class_code);
+            found+=r!=nullptr;
+            for(student_data* student:user_table.findStudents(r->student_usernames.members())) found+=student!=nullptr;
+            for(quiz_data* quiz:quiz_table.findQuizzes(r->quizIds)) found+=quiz!=nullptr;
+            return found;
+        });
+        count_route("GET /classroom_joined?code=", [&]{
+            return size_t(classroom_table.findClassroom(query_class_code)!=nullptr);
+        });
+        count_route("GET /student/classroom/<code>", [&]{
+            size_t found=0;
+            classroom_data* r=classroom_table.findClassroom(path_class_code);
+            found+=r!=nullptr;
+            for(quiz_data* quiz:quiz_table.findQuizzes(r->quizIds)) found+=quiz!=nullptr;
+            return found;
+        });
+        count_route("GET /student/attempt_quiz/<id>", [&]{
+            entity_id quiz_key=entity_id::from_string(path_quiz_id);
+            size_t found=size_t(results_table.hasStudentAttempted(session_username, quiz_key));
+            quiz_data* quiz=quiz_table.findQuiz(quiz_key);
+            if(!quiz) return found;
+            found+=classroom_table.isEnrolled(quiz->classroomId, symbol_table::instance().find(session_username));
+            // The walk over the questions and options that fills the page
+            size_t text=0;
+            for(quiz_questions::question_view q:quiz->questions){
+                text+=q.text().size();
+                for(size_t o=0;o<q.option_count();o++) text+=q.option(o).size();
+            }
+            return found+(text>0);
+        });
+        count_route("POST /student/submit_quiz", [&]{
+            quiz_data* quiz=quiz_table.findQuiz(path_quiz_id);
+            if(!classroom_table.isEnrolled(quiz->classroomId, symbol_table::instance().find(session_username))) return size_t(0);
+            const int answers[]={1, 1, 0};
+            size_t score=0;
+            for(size_t i=0;i<quiz->questions.size();i++) score+=answers[i]==quiz->questions[i].correct_answer();
+            return score;
+        });
+        count_route("GET /quiz_leaderboard/<id> (find)", [&]{
+            return size_t(quiz_table.findQuiz(path_quiz_id)!=nullptr);
+        });
+
+        // What storing a 100-question quiz costs: the old `std::vector<Question>` copy, against `quiz_questions` for new questions
+        // (one record array plus one body each) and for questions another quiz already uses (the record array only)
+        std::vector<Question> authored;
+        for(int i=0;i<100;i++){
+            authored.push_back(Question{"Question "+std::to_string(i)+": which of these structures gives O(1) average lookup?",
+                                        {"Hash table", "Linked list", "Binary heap", "Sorted array"}, 0});
+        }
+        size_t before=allocations.load(std::memory_order_relaxed);
+        std::vector<Question> copied=authored;
+        size_t vector_made=allocations.load(std::memory_order_relaxed)-before;
+        before=allocations.load(std::memory_order_relaxed);
+        quiz_questions first=quiz_questions::from_questions(authored);
+        size_t first_made=allocations.load(std::memory_order_relaxed)-before;
+        before=allocations.load(std::memory_order_relaxed);
+        quiz_questions reused=quiz_questions::from_questions(authored);
+        size_t reused_made=allocations.load(std::memory_order_relaxed)-before;
+        std::cout<<"\nstore a 100-question quiz: vector<Question> copy "<<vector_made<<" allocations, quiz_questions "<<first_made
+                 <<" (new questions) / "<<reused_made<<" (questions already in the store)\n";
+    }
+    return 0;
+}
@@ -0,0 +1,219 @@
+/*
+ * Description: Checks the memory report of `/admin/memory` (see `MemoryUsage.hpp`) against the heap, and times it. Students,
+ * classrooms, quizzes and results are generated into Data/ and each table is loaded in turn. Global `operator new` is replaced
+ * with a version that tracks the bytes live on the heap, so the growth of the heap across a load (the parsed file is freed by
+ * then) can be set beside the total the table reports for itself. Each report is then timed, best of five, as the price of
+ * one request to the endpoint.
+ *
+ * The two figures differ by what the report leaves out on purpose: capacity the loaders reserved but did not fill shows in
+ * both, while a storage version or slab retired but not yet reclaimed, and the allocator's own overhead, show in neither.
+ *
+ * Usage: memory_report_bench [record_count] [scratch_dir]   (defaults 100000 ./memory_report_bench_data)
+ */
+
+#include "users.hpp"
+#include "Classroom.hpp"
+#include "Quiz.hpp"
+#include "QuizAttempt.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+std::atomic<size_t> live_bytes{0};
+
+// Each block is preceded by a header holding its size; an over-aligned block's header is one alignment unit
+constexpr size_t HEADER = 16;
+
+void* track(void* base, size_t header, size_t size){
+    if(!base) throw std::bad_alloc();
+    char* p=static_cast<char*>(base)+header;
+    reinterpret_cast<size_t*>(p)[-1]=size;
+    live_bytes.fetch_add(size, std::memory_order_relaxed);
+    return p;
+}
+
+void* untrack(void* p, size_t header){
+    live_bytes.fetch_sub(reinterpret_cast<size_t*>(p)[-1], std::memory_order_relaxed);
+    return static_cast<char*>(p)-header;
+}
+
+size_t aligned_header(std::align_val_t align){
+    return std::max(HEADER, static_cast<size_t>(align));
+}
+}
+
+void* operator new(std::size_t size){
+    return track(std::malloc(size+HEADER), HEADER, size);
+}
+
+void* operator new[](std::size_t size){
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align){
+    size_t header=aligned_header(align);
+    size_t alignment=static_cast<size_t>(align);
+    return track(std::aligned_alloc(alignment, (size+header+alignment-1)/alignment*alignment), header, size);
+}
+
+void* operator new[](std::size_t size, std::align_val_t align){
+    return ::operator new(size, align);
+}
+
+// The library's temporary buffers (e.g. of `std::stable_sort`) come from the nothrow forms, and are freed with the plain ones
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try{ return ::operator new(size); } catch(...){ return nullptr; }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try{ return ::operator new(size); } catch(...){ return nullptr; }
+}
+
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try{ return ::operator new(size, align); } catch(...){ return nullptr; }
+}
+
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try{ return ::operator new(size, align); } catch(...){ return nullptr; }
+}
+
+void operator delete(void* p) noexcept { if(p) std::free(untrack(p, HEADER)); }
+void operator delete[](void* p) noexcept { ::operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { ::operator delete(p); }
+void operator delete(void* p, std::align_val_t align) noexcept { if(p) std::free(untrack(p, aligned_header(align))); }
+void operator delete[](void* p, std::align_val_t align) noexcept { ::operator delete(p, align); }
+void operator delete(void* p, std::size_t, std::align_val_t align) noexcept { ::operator delete(p, align); }
+void operator delete[](void* p, std::size_t, std::align_val_t align) noexcept { ::operator delete(p, align); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { ::operator delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { ::operator delete(p); }
+void operator delete(void* p, std::align_val_t align, const std::nothrow_t&) noexcept { ::operator delete(p, align); }
+void operator delete[](void* p, std::align_val_t align, const std::nothrow_t&) noexcept { ::operator delete(p, align); }
+
+// The server defines these in source/*.cpp, which pull in Crow; the benchmark only needs the tables to save on exit
+void to_json(njson& j, const student_data& s){
+    j=njson{{"name", s.name}, {"email", s.credentials->email}, {"password", s.credentials->password}, {"username", s.username}, {"classroomIds", s.classroomIds}};
+}
+
+void to_json(njson& j, const teacher_data& s){
+    j=njson{{"name", s.name}, {"email", s.credentials->email}, {"password", s.credentials->password}, {"username", s.username}, {"classroomIds", s.classroomIds}};
+}
+
+void to_json(njson& j, const classroom_data& c){
+    std::shared_lock<std::shared_mutex> guard(c.lock);
+    j=njson{{"class_name", c.class_name}, {"subject", c.subject}, {"class_code", c.class_code}, {"teacher_username", c.teacher_username},
+            {"student_usernames", c.student_usernames}, {"quizIds", c.quizIds}};
+}
+
+void to_json(njson& j, const quiz_data& q){
+    j=njson{{"quizId", q.quizId}, {"quizTitle", q.quizTitle}, {"classroomId", q.classroomId}, {"timeLimitMinutes", q.timeLimitMins},
+            {"questions", q.questions}};
+}
+
+namespace {
+
+// Microseconds for the best of five runs of `work`
+template<typename Work>
+double best_us(Work work){
+    double best=1e18;
+    for(int r=0;r<5;r++){
+        auto start=std::chrono::steady_clock::now();
+        work();
+        best=std::min(best, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now()-start).count());
+    }
+    return best;
+}
+
+void report(const std::string& label, size_t heap, const memory_usage& usage, double us){
+    std::cout<<std::left<<std::setw(18)<<label<<std::right<<std::setw(9)<<usage.entities<<" entities   heap +"<<std::setw(11)<<heap
+             <<"   reported "<<std::setw(11)<<usage.total()<<" (nodes "<<usage.nodes<<", records "<<usage.records<<", strings "
+             <<usage.strings<<", vectors "<<usage.vectors<<")   "<<std::fixed<<std::setprecision(0)<<us<<" us\n";
+}
+
+// Loads `Table`, then reports the heap growth across the load beside `usage(table)` and the time `usage` takes
+template<typename Table, typename Usage>
+void measure(const std::string& label, Usage usage){
+    std::optional<Table> table;
+    size_t before=live_bytes.load();
+    table.emplace();
+    size_t heap=live_bytes.load()-before;
+    memory_usage reported=usage(*table);
+    double us=best_us([&]{ usage(*table); });
+    report(label, heap, reported, us);
+}
+
+}
+
+int main(int argc, char** argv){
+    size_t record_count=argc>1 ? std::stoul(argv[1]) : 100000;
+    std::filesystem::path dir=argc>2 ? argv[2] : "memory_report_bench_data";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir/"Data");
+    std::filesystem::current_path(dir);
+    std::mt19937 rng(24);
+
+    {
+        njson students=njson::array();
+        njson rooms=njson::array();
+        njson quizzes=njson::array();
+        njson results=njson::array();
+        for(size_t i=0;i<record_count;i++){
+            std::string username="student_"+std::to_string(i);
+            students.push_back({{"name", "Student Full Name "+std::to_string(i)}, {"username", username}, {"email", username+"@nitt.edu"},
+                                {"password", "a password longer than the buffer"}, {"classroomIds", {"PSHVJ9", "K2M0QX"}}});
+            std::vector<int> answers(10);
+            for(int& a:answers) a=static_cast<int>(rng()%4);
+            results.push_back({{"resultId", entity_id::random(rng)}, {"quizId", "Q1ZZ01"}, {"studentUsername", username}, {"score", 10},
+                               {"timeTakenSeconds", 600.0}, {"submittedAnswers", answers}});
+        }
+        for(size_t r=0;r<record_count/30;r++){
+            njson roster=njson::array();
+            for(size_t s=0;s<30;s++) roster.push_back("student_"+std::to_string(rng()%record_count));
+            njson questions=njson::array();
+            for(size_t q=0;q<10;q++){
+                // A third of the questions are drawn from a common bank, so some bodies are shared
+                size_t topic=q%3==0 ? rng()%50 : r*10+q;
+                questions.push_back({{"questionText", "Question "+std::to_string(topic)+": which structure answers this in O(1)?"},
+                                     {"options", {"Hash table", "Sorted array", "Linked list", "Binary heap"}}, {"correctAnswerIndex", 0}});
+            }
+            entity_id code=entity_id::random(rng);
+            entity_id quiz=entity_id::random(rng);
+            rooms.push_back({{"class_name", "Data Structures, section "+std::to_string(r)}, {"subject", "Computer Science and Engineering"},
+                             {"class_code", code}, {"teacher_username", "teacher_0"}, {"student_usernames", std::move(roster)}, {"quizIds", {quiz}}});
+            quizzes.push_back({{"quizId", quiz}, {"quizTitle", "Weekly quiz "+std::to_string(r)}, {"classroomId", code}, {"timeLimitMinutes", 30},
+                               {"questions", std::move(questions)}});
+        }
+        std::ofstream("Data/students.json")<<students.dump();
+        std::ofstream("Data/teachers.json")<<"[]";
+        std::ofstream("Data/classrooms.json")<<rooms.dump();
+        std::ofstream("Data/quizzes.json")<<quizzes.dump();
+        std::ofstream("Data/quiz_results.json")<<results.dump();
+    }
+
+    // Intern the usernames first, so the symbol table's growth is reported on its own row, not against a table
+    size_t before=live_bytes.load();
+    { user_hashTable warm; }
+    report("usernames", live_bytes.load()-before, symbol_table::instance().memory(),
+           best_us([]{ symbol_table::instance().memory(); }));
+
+    measure<user_hashTable>("students, emails", [](user_hashTable& t){
+        memory_usage u=t.studentMemory();
+        u+=t.emailMemory();
+        u+=t.usernameClaimMemory();
+        return u;
+    });
+    measure<classroom_hashTable>("classrooms", [](classroom_hashTable& t){ return t.memoryUsage(); });
+    measure<quiz_hashTable>("quizzes, questions", [](quiz_hashTable& t){ memory_usage u=t.memoryUsage(); u+=t.questionMemoryUsage(); return u; });
+    measure<quiz_result_hashTable>("results", [](quiz_result_hashTable& t){ return t.memoryUsage(); });
+}
@@ -0,0 +1,82 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+/*
+ * Description: Hardware cache-miss counters shared by the benchmarks. `perf_counter` reads one event for the calling thread
+ * through `perf_event_open`, the interface behind `perf stat`. Where the counters are unavailable (e.g. `perf_event_paranoid` > 2,
+ * or in a VM without a PMU, or off Linux) `available()` is false and `per_lookup` prints "n/a".
+ */
+
+#include <cstdint>
+#include <string>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// One hardware event counted for this thread in user space, as `perf stat` would
+class perf_counter {
+    int fd=-1;
+
+public:
+    perf_counter(uint32_t type, uint64_t config){
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.size=sizeof(attr);
+        attr.type=type;
+        attr.config=config;
+        attr.disabled=1;
+        attr.exclude_kernel=1;
+        attr.exclude_hv=1;
+        fd=static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+        (void)type;
+        (void)config;
+#endif
+    }
+
+    perf_counter(const perf_counter&) = delete;
+    perf_counter& operator=(const perf_counter&) = delete;
+
+    ~perf_counter(){
+#ifdef __linux__
+        if(fd>=0) close(fd);
+#endif
+    }
+
+    bool available() const { return fd>=0; }
+
+    void start(){
+#ifdef __linux__
+        if(fd<0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    uint64_t stop(){
+        uint64_t value=0;
+#ifdef __linux__
+        if(fd<0) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if(read(fd, &value, sizeof(value))!=static_cast<ssize_t>(sizeof(value))) value=0;
+#endif
+        return value;
+    }
+};
+
+// L1 data cache read misses and last-level cache misses, per lookup
+struct miss_counts {
+    double l1d=-1;
+    double llc=-1;
+};
+
+inline std::string per_lookup(double v){
+    if(v<0) return "n/a";
+    std::string text=std::to_string(v);
+    return text.substr(0, text.find('.')+3);
+}
+
+#endif
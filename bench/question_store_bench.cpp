@@ -0,0 +1,118 @@
+/*
+ * Description: What sharing question bodies saves. It writes a quizzes.json in the old inline format: Q quizzes of K questions,
+ * each drawn from a bank of B distinct questions, as sections and semesters reusing a question bank would. It then loads it
+ * into `quiz_hashTable` and saves it again, and reports:
+ *   - the distinct bodies held by the `question_store`, and the question text bytes held against those the quizzes reference;
+ *   - the RSS the load added;
+ *   - the size of the inline quizzes.json against the new quizzes.json plus questions.json.
+ *
+ * Usage: question_store_bench [quiz_count] [questions_per_quiz] [bank_size] [scratch_dir]   (defaults 2000 25 3000 ./question_store_bench_data)
+ */
+
+#include "Quiz.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// The server defines this in source/Quiz.cpp, which pulls in Crow
+void to_json(njson& j, const quiz_data& q){
+    j=njson{{"quizId", q.quizId}, {"quizTitle", q.quizTitle}, {"classroomId", q.classroomId}, {"timeLimitMinutes", q.timeLimitMins},
+            {"questions", q.questions}};
+}
+
+namespace {
+
+// Hands freed heap pages back to the system, so the RSS figures count only what is still in use
+void trim_heap(){
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+}
+
+// Resident set size in KiB, or 0 where /proc is unavailable
+long rss_kib(){
+    std::ifstream status("/proc/self/status");
+    std::string field;
+    while(status>>field){
+        if(field=="VmRSS:"){
+            long kib=0;
+            status>>kib;
+            return kib;
+        }
+    }
+    return 0;
+}
+
+double mib(uintmax_t bytes){ return bytes/(1024.0*1024.0); }
+
+}
+
+int main(int argc, char** argv){
+    size_t quiz_count=argc>1 ? std::stoul(argv[1]) : 2000;
+    size_t per_quiz=argc>2 ? std::stoul(argv[2]) : 25;
+    size_t bank_size=argc>3 ? std::stoul(argv[3]) : 3000;
+    std::filesystem::path dir=argc>4 ? argv[4] : "question_store_bench_data";
+
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir/"Data");
+    std::filesystem::current_path(dir);
+
+    std::mt19937 rng(20);
+    njson bank=njson::array();
+    for(size_t b=0;b<bank_size;b++){
+        bank.push_back({
+            {"questionText", "Question "+std::to_string(b)+": which of these data structures gives O(1) average-case lookup by key?"},
+            {"options", {"Hash table "+std::to_string(b), "Singly linked list", "Binary min-heap", "Unsorted dynamic array"}},
+            {"correctAnswerIndex", static_cast<int>(b%4)}
+        });
+    }
+    njson quizzes=njson::array();
+    size_t referenced_chars=0;
+    for(size_t q=0;q<quiz_count;q++){
+        njson questions=njson::array();
+        for(size_t k=0;k<per_quiz;k++){
+            const njson& question=bank[rng()%bank_size];
+            referenced_chars+=question["questionText"].get_ref<const std::string&>().size();
+            for(const auto& option:question["options"]) referenced_chars+=option.get_ref<const std::string&>().size();
+            questions.push_back(question);
+        }
+        quizzes.push_back({{"quizId", entity_id::random(rng)}, {"quizTitle", "Quiz "+std::to_string(q)}, {"classroomId", "PSHVJ9"},
+                           {"timeLimitMinutes", 30}, {"questions", std::move(questions)}});
+    }
+    std::ofstream("Data/quizzes.json")<<quizzes.dump(4);
+    bank=njson();
+    quizzes=njson();
+    uintmax_t inline_bytes=std::filesystem::file_size("Data/quizzes.json");
+
+    trim_heap();
+    long rss_before=rss_kib();
+    {
+        quiz_hashTable quiz_table;
+        trim_heap();    // Drops the parsed JSON document
+        long rss_after=rss_kib();
+
+        size_t held_chars=0;
+        quiz_table.saveQuizzesToFile();
+        njson saved;
+        std::ifstream("Data/questions.json")>>saved;
+        for(const auto& body:saved){
+            held_chars+=body["questionText"].get_ref<const std::string&>().size();
+            for(const auto& option:body["options"]) held_chars+=option.get_ref<const std::string&>().size();
+        }
+
+        std::cout<<quiz_count<<" quizzes x "<<per_quiz<<" questions from a bank of "<<bank_size<<"\n"
+                 <<"  question bodies held: "<<question_store::instance().size()<<" (referenced "<<quiz_count*per_quiz<<" times)\n"
+                 <<"  question text held: "<<mib(held_chars)<<" MiB, referenced: "<<mib(referenced_chars)<<" MiB\n";
+        if(rss_after) std::cout<<"  RSS +"<<(rss_after-rss_before)/1024.0<<" MiB after load\n";
+    }
+    uintmax_t quiz_bytes=std::filesystem::file_size("Data/quizzes.json");
+    uintmax_t question_bytes=std::filesystem::file_size("Data/questions.json");
+    std::cout<<"  inline quizzes.json "<<mib(inline_bytes)<<" MiB -> quizzes.json "<<mib(quiz_bytes)<<" MiB + questions.json "
+             <<mib(question_bytes)<<" MiB\n";
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * Description: Quiz lookup cost with the minimal perfect hash of `PerfectHashStorage.hpp` against the other catalog layouts.
+ * For each quiz count it loads random quiz IDs into `rcu_storage`, `flat_storage` and `perfect_storage`, then times the same
+ * random lookups (half of them misses) through each, best of a few rounds. For `perfect_storage` it also reports how long one
+ * rebuild takes, and the lookup cost while `OVERLAY` fresh quizzes are still waiting in the overlay.
+ *
+ * Usage: quiz_catalog_bench [max_quizzes] [lookups]   (defaults 100000 and 1000000; sizes go up by 10x from 1000)
+ */
+
+#include "RcuStorage.hpp"
+#include "FlatStorage.hpp"
+#include "PerfectHashStorage.hpp"
+#include "EntityId.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t OVERLAY = 32;
+
+struct bench_quiz {
+    entity_id quizId;
+    std::string quizTitle;
+};
+
+template<typename Storage>
+double time_lookups(Storage& storage, const std::vector<entity_id>& keys, size_t& hits){
+    const int rounds=3;
+    double best=1e9;
+    for(int r=0;r<rounds;r++){
+        hits=0;
+        auto start=std::chrono::steady_clock::now();
+        for(entity_id id:keys){
+            bench_quiz* found=nullptr;
+            if(storage.find(id.hash(), [id](bench_quiz* q){ return q->quizId==id; }, found)) hits++;
+        }
+        best=std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-start).count()/keys.size());
+    }
+    return best;
+}
+
+template<template<typename> class Storage>
+void run(const char* label, const std::vector<bench_quiz*>& quizzes, size_t n, const std::vector<entity_id>& keys){
+    Storage<bench_quiz*> storage(100);
+    storage.reserve(n);
+    for(size_t i=0;i<n;i++) storage.insert(quizzes[i]->quizId.hash(), quizzes[i]);
+    size_t hits=0;
+    double ns=time_lookups(storage, keys, hits);
+    std::cout<<"  "<<std::left<<std::setw(16)<<label<<std::fixed<<std::setprecision(1)<<ns<<" ns ("<<hits<<" hits)\n";
+}
+
+void run_perfect(const std::vector<bench_quiz*>& quizzes, size_t n, const std::vector<entity_id>& keys){
+    perfect_storage<bench_quiz*> storage(100);
+    storage.reserve(n);
+    for(size_t i=0;i<n;i++) storage.insert(quizzes[i]->quizId.hash(), quizzes[i]);
+    // Build now rather than waiting for the worker's quiet period
+    auto start=std::chrono::steady_clock::now();
+    storage.rebuild();
+    double build_ms=std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+    size_t hits=0;
+    double ns=time_lookups(storage, keys, hits);
+    std::cout<<"  "<<std::left<<std::setw(16)<<"perfect_storage"<<std::fixed<<std::setprecision(1)<<ns<<" ns ("<<hits
+             <<" hits), rebuild "<<build_ms<<" ms\n";
+
+    for(size_t i=n;i<n+OVERLAY;i++) storage.insert(quizzes[i]->quizId.hash(), quizzes[i]);
+    ns=time_lookups(storage, keys, hits);
+    std::cout<<"  "<<std::left<<std::setw(16)<<"  + overlay"<<ns<<" ns ("<<OVERLAY<<" quizzes not yet rebuilt)\n";
+}
+
+}
+
+int main(int argc, char** argv){
+    size_t max_quizzes=argc>1 ? std::stoul(argv[1]) : 100000;
+    size_t lookups=argc>2 ? std::stoul(argv[2]) : 1000000;
+    std::mt19937 rng(7);
+
+    std::vector<bench_quiz*> quizzes;
+    for(size_t i=0;i<max_quizzes+OVERLAY;i++) quizzes.push_back(new bench_quiz{entity_id::random(rng), "Quiz"});
+
+    for(size_t n=1000;n<=max_quizzes;n*=10){
+        std::vector<entity_id> keys;
+        for(size_t i=0;i<lookups;i++) keys.push_back(rng()%2 ? quizzes[rng()%n]->quizId : entity_id::random(rng));
+
+        std::cout<<n<<" quizzes, "<<lookups<<" lookups, ns each\n";
+        run<rcu_storage>("rcu_storage", quizzes, n, keys);
+        run<flat_storage>("flat_storage", quizzes, n, keys);
+        run_perfect(quizzes, n, keys);
+    }
+    for(bench_quiz* q:quizzes) delete q;
+}
@@ -0,0 +1,129 @@
+/*
+ * Description: The lookups behind a large `/classroom/<code>` page: a roster of R students resolved against a table of N users,
+ * one `find` per student (as the route used to do) against one `find_many` batch (as it does now). Each layout is timed with
+ * the caches flushed before every page, as for a request that finds the table cold, and again warm. Best of a few rounds.
+ * A quiz list of the same length is timed the same way against the catalog layouts.
+ *
+ * Usage: roster_bench [user_count] [roster_size]   (defaults 400000 and 5000)
+ */
+
+#include "EntityTable.hpp"
+#include "FlatStorage.hpp"
+#include "CuckooStorage.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Stand-ins for `student_data` and `quiz_data` with the fields the page reads
+struct bench_student {
+    symbol_id username;
+    std::string name;
+    std::string email;
+    std::string password;
+
+    bench_student(std::string_view theusername, std::string_view thename):
+    username(symbol_table::instance().intern(theusername)), name(thename), email(std::string(theusername)+"@nitt.edu"), password("x"){}
+};
+
+struct bench_quiz {
+    entity_id quizId;
+    std::string quizTitle;
+
+    bench_quiz(entity_id id, std::string_view title): quizId(id), quizTitle(title){}
+};
+
+symbol_id entity_key(const bench_student& s){ return s.username; }
+entity_id entity_key(const bench_quiz& q){ return q.quizId; }
+
+// Evicts the tables from every cache level by walking a buffer larger than the last-level cache
+void flush_caches(){
+    static std::vector<char> buffer(64<<20);
+    volatile char sink=0;
+    for(size_t i=0;i<buffer.size();i+=64){
+        buffer[i]++;
+        sink=sink+buffer[i];
+    }
+}
+
+// Microseconds for the best of `rounds` runs of `page`, optionally with the caches flushed first
+template<typename Page>
+double best_us(bool cold, Page page){
+    const int rounds=5;
+    double best=1e18;
+    for(int r=0;r<rounds;r++){
+        if(cold) flush_caches();
+        auto start=std::chrono::steady_clock::now();
+        page();
+        best=std::min(best, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now()-start).count());
+    }
+    return best;
+}
+
+template<typename Table, typename Key>
+void compare(const char* label, Table& table, const std::vector<Key>& keys){
+    size_t found_one=0, found_many=0;
+    auto one_by_one=[&]{
+        found_one=0;
+        for(const Key& key:keys) found_one+=table.find(key)!=nullptr;
+    };
+    auto batched=[&]{
+        found_many=0;
+        for(auto* record:table.find_many(keys)) found_many+=record!=nullptr;
+    };
+    std::cout<<"  "<<std::left<<std::setw(16)<<label<<std::fixed<<std::setprecision(0)
+             <<"cold: find "<<std::setw(6)<<best_us(true, one_by_one)<<"us  find_many "<<std::setw(6)<<best_us(true, batched)<<"us   "
+             <<"warm: find "<<std::setw(6)<<best_us(false, one_by_one)<<"us  find_many "<<std::setw(6)<<best_us(false, batched)<<"us"
+             <<"  ("<<found_one<<"/"<<found_many<<" found)\n";
+}
+
+template<template<typename> class Storage>
+void run_roster(const char* label, size_t n, const std::vector<std::string>& names, const std::vector<size_t>& roster){
+    EntityTable<symbol_id, bench_student, symbol_hash, Storage, no_persist> table(100);
+    table.reserve(n);
+    for(size_t i=0;i<n;i++) table.emplace(names[i], "Full Name");
+    std::vector<symbol_id> keys;
+    for(size_t i:roster) keys.push_back(symbol_table::instance().find(names[i]));
+    compare(label, table, keys);
+}
+
+template<template<typename> class Storage>
+void run_quizzes(const char* label, const std::vector<entity_id>& ids, const std::vector<entity_id>& keys){
+    EntityTable<entity_id, bench_quiz, entity_id_hash, Storage, no_persist> table(100);
+    table.reserve(ids.size());
+    for(entity_id id:ids) table.emplace(id, "Quiz");
+    compare(label, table, keys);
+}
+
+}
+
+int main(int argc, char** argv){
+    size_t n=argc>1 ? std::stoul(argv[1]) : 400000;
+    size_t roster_size=argc>2 ? std::stoul(argv[2]) : 5000;
+    std::mt19937 rng(5);
+
+    std::vector<std::string> names;
+    for(size_t i=0;i<n;i++) names.push_back("student_"+std::to_string(i));
+    std::vector<size_t> roster;
+    for(size_t i=0;i<roster_size;i++) roster.push_back(rng()%n);
+
+    std::cout<<"roster of "<<roster_size<<" among "<<n<<" users\n";
+    run_roster<chained_storage>("chained_storage", n, names, roster);
+    run_roster<flat_storage>("flat_storage", n, names, roster);
+    run_roster<cuckoo_storage>("cuckoo_storage", n, names, roster);
+
+    std::vector<entity_id> ids;
+    for(size_t i=0;i<n/4;i++) ids.push_back(entity_id::random(rng));
+    std::vector<entity_id> quiz_keys;
+    for(size_t i=0;i<roster_size;i++) quiz_keys.push_back(ids[rng()%ids.size()]);
+
+    std::cout<<roster_size<<" quizzes among "<<ids.size()<<"\n";
+    run_quizzes<chained_storage>("chained_storage", ids, quiz_keys);
+    run_quizzes<rcu_storage>("rcu_storage", ids, quiz_keys);
+}
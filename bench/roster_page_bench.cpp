@@ -0,0 +1,91 @@
+/*
+ * Description: One page of the alphabetical roster on `/classroom/<code>`. For classes of a few sizes it times fetching a page of
+ * 50 usernames at the start, middle and end of the class: by sorting a copy of the join-order roster on every view and slicing
+ * it, as a route without an ordered index would have to, and from the `roster_set`'s B+ tree after a cursor. It also walks the
+ * whole class page by page both ways. Best of five rounds.
+ *
+ * Usage: roster_page_bench [largest_class]   (default 10000)
+ */
+
+#include "RosterSet.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t PAGE_SIZE = 50;
+
+// Microseconds for the best of five runs of `work`
+template<typename Work>
+double best_us(Work work){
+    double best=1e18;
+    for(int r=0;r<5;r++){
+        auto start=std::chrono::steady_clock::now();
+        work();
+        best=std::min(best, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now()-start).count());
+    }
+    return best;
+}
+
+// The page after `after` by sorting the whole roster, as without an index
+std::vector<symbol_id> sorted_page(const roster_set& roster, std::string_view after, bool& more){
+    std::vector<symbol_id> sorted=roster.members();
+    std::sort(sorted.begin(), sorted.end(), symbol_order());
+    auto from=std::upper_bound(sorted.begin(), sorted.end(), after, symbol_order());
+    size_t left=static_cast<size_t>(sorted.end()-from);
+    more=left>PAGE_SIZE;
+    return std::vector<symbol_id>(from, from+std::min(left, PAGE_SIZE));
+}
+
+template<typename Page>
+size_t walk(const roster_set& roster, Page page){
+    std::string after;
+    size_t seen=0;
+    bool more=true;
+    while(more){
+        std::vector<symbol_id> ids=page(roster, after, more);
+        seen+=ids.size();
+        if(!ids.empty()) after=ids.back().str();
+    }
+    return seen;
+}
+
+}
+
+int main(int argc, char** argv){
+    size_t largest=argc>1 ? std::stoul(argv[1]) : 10000;
+    std::mt19937 rng(25);
+
+    std::vector<symbol_id> students;
+    for(size_t i=0;i<largest;i++) students.push_back(symbol_table::instance().intern("student_"+std::to_string(rng())));
+    auto indexed=[](const roster_set& roster, std::string_view after, bool& more){ return roster.page_by_name(after, PAGE_SIZE, more); };
+
+    for(size_t size:{size_t(30), size_t(300), size_t(2000), largest}){
+        if(size>largest) continue;
+        roster_set roster;
+        roster.assign(std::vector<symbol_id>(students.begin(), students.begin()+size));
+        std::vector<symbol_id> by_name=roster.members();
+        std::sort(by_name.begin(), by_name.end(), symbol_order());
+
+        std::cout<<"class of "<<size<<"\n";
+        for(double at:{0.0, 0.5, 0.99}){
+            std::string after=at==0.0 ? std::string() : by_name[static_cast<size_t>(at*(size-1))].str();
+            bool more;
+            double sorting=best_us([&]{ sorted_page(roster, after, more); });
+            double tree=best_us([&]{ roster.page_by_name(after, PAGE_SIZE, more); });
+            std::cout<<"    page at "<<std::setw(3)<<static_cast<int>(at*100)<<"%   sort per view "<<std::fixed<<std::setprecision(1)
+                     <<std::setw(10)<<sorting<<" us   B+ tree "<<std::setw(8)<<tree<<" us\n";
+        }
+        size_t seen_sorted=0, seen_tree=0;
+        double all_sorted=best_us([&]{ seen_sorted=walk(roster, sorted_page); });
+        double all_tree=best_us([&]{ seen_tree=walk(roster, indexed); });
+        std::cout<<"    every page      sort per view "<<std::setw(10)<<all_sorted<<" us   B+ tree "<<std::setw(8)<<all_tree
+                 <<" us  ("<<seen_sorted<<" / "<<seen_tree<<" students)\n";
+        if(size==largest) break;
+    }
+}
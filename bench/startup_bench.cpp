@@ -0,0 +1,79 @@
+/*
+ * Description: Startup benchmark for `user_hashTable`. It writes N students and N teachers to `Data/...json` in a scratch
+ * directory, then times the table's constructor (parse + load) and reports how much the resident set size grew.
+ *
+ * Usage: startup_bench [user_count] [scratch_dir]   (defaults 200000 and ./startup_bench_data)
+ * RSS is read from /proc/self/status and is only reported on Linux.
+ */
+
+#include "users.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// The server defines these in source/Students.cpp and source/Teachers.cpp, which pull in Crow; the benchmark only needs the fields
+void to_json(njson &j, const student_data &s){
+    j=njson{{"name", s.name}, {"email", s.credentials->email}, {"password", s.credentials->password}, {"username", s.username}, {"classroomIds", s.classroomIds}};
+}
+
+void to_json(njson &j, const teacher_data &s){
+    j=njson{{"name", s.name}, {"email", s.credentials->email}, {"password", s.credentials->password}, {"username", s.username}, {"classroomIds", s.classroomIds}};
+}
+
+namespace {
+
+// Resident set size in KiB, or 0 where /proc is unavailable
+long rss_kib(){
+    std::ifstream status("/proc/self/status");
+    std::string field;
+    while(status>>field){
+        if(field=="VmRSS:"){
+            long kib=0;
+            status>>kib;
+            return kib;
+        }
+    }
+    return 0;
+}
+
+void write_users(const std::string& path, const std::string& prefix, size_t n){
+    njson users=njson::array();
+    for(size_t i=0;i<n;i++){
+        std::string username=prefix+std::to_string(i);
+        users.push_back({
+            {"name", "Full Name "+std::to_string(i)},
+            {"username", username},
+            {"email", username+"@example.edu"},
+            {"password", "correct horse battery"},
+            {"classroomIds", {"PSHVJ9", "K2M0QX"}}
+        });
+    }
+    std::ofstream(path)<<users;
+}
+
+}
+
+int main(int argc, char** argv){
+    size_t n=argc>1 ? std::stoul(argv[1]) : 200000;
+    std::filesystem::path dir=argc>2 ? argv[2] : "startup_bench_data";
+
+    std::filesystem::create_directories(dir/"Data");
+    std::filesystem::current_path(dir);
+    write_users("Data/students.json", "student_", n);
+    write_users("Data/teachers.json", "teacher_", n);
+
+    long rss_before=rss_kib();
+    auto start=std::chrono::steady_clock::now();
+    {
+        user_hashTable users;
+        double load_ms=std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+        long rss_after=rss_kib();
+        std::cout<<2*n<<" users: load "<<load_ms<<" ms";
+        if(rss_after) std::cout<<", RSS +"<<(rss_after-rss_before)/1024.0<<" MiB";
+        std::cout<<"\n";
+        std::cout.flush();
+    }
+    return 0;
+}
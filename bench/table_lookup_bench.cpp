@@ -0,0 +1,109 @@
+/*
+ * Description: Lookup latency benchmark for the two table layouts in `HashStorage.hpp` and `FlatStorage.hpp`.
+ * It loads N student-like records (heap-allocated, keyed by username) into a `chained_storage` and a `flat_storage`,
+ * then times successful and unsuccessful lookups in random order.
+ * On Linux it also reads the same hardware counters as `perf stat -e L1-dcache-load-misses,cache-misses` around each batch of
+ * lookups and reports them per lookup. A record hit costs at least one miss for the record itself; the rest is the table.
+ * Where the counters are unavailable (e.g. `perf_event_paranoid` > 2, or in a VM without a PMU) they print as "n/a".
+ *
+ * Usage: table_lookup_bench [record_count]   (default 250000)
+ */
+
+#include "HashStorage.hpp"
+#include "FlatStorage.hpp"
+#include "perf_counters.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Stand-in for `student_data`: the key plus enough payload to spread records over several cache lines
+struct bench_record {
+    std::string username;
+    std::string name;
+    std::string email;
+    std::string password;
+    std::vector<std::string> classroomIds;
+};
+
+uint32_t fnv1a(const std::string& s){
+    uint32_t hash=2166136261u;
+    for(unsigned char c:s){
+        hash^=c;
+        hash*=16777619u;
+    }
+    return hash;
+}
+
+// Runs every key in `keys` through `storage.find` and returns the mean nanoseconds per lookup, and the cache misses in `misses`
+template<typename Storage>
+double time_lookups(Storage& storage, const std::vector<std::string>& keys, size_t& hits, miss_counts& misses){
+#ifdef __linux__
+    perf_counter l1d(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D|(PERF_COUNT_HW_CACHE_OP_READ<<8)|(PERF_COUNT_HW_CACHE_RESULT_MISS<<16));
+    perf_counter llc(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#else
+    perf_counter l1d(0, 0);
+    perf_counter llc(0, 0);
+#endif
+    l1d.start();
+    llc.start();
+    auto start=std::chrono::steady_clock::now();
+    for(const auto& key:keys){
+        bench_record* found=nullptr;
+        if(storage.find(fnv1a(key), [&key](bench_record* r){ return r->username==key; }, found)) hits++;
+    }
+    auto end=std::chrono::steady_clock::now();
+    uint64_t llc_count=llc.stop();
+    uint64_t l1d_count=l1d.stop();
+    if(l1d.available()) misses.l1d=static_cast<double>(l1d_count)/keys.size();
+    if(llc.available()) misses.llc=static_cast<double>(llc_count)/keys.size();
+    return std::chrono::duration<double, std::nano>(end-start).count()/keys.size();
+}
+
+template<typename Storage>
+void run(const char* label, const std::vector<bench_record*>& records, const std::vector<std::string>& hit_keys, const std::vector<std::string>& miss_keys){
+    Storage storage(100);
+    auto start=std::chrono::steady_clock::now();
+    for(bench_record* r:records){
+        storage.insert(fnv1a(r->username), r);
+    }
+    double load_ms=std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+
+    size_t hits=0;
+    miss_counts hit_misses, miss_misses;
+    double hit_ns=time_lookups(storage, hit_keys, hits, hit_misses);
+    double miss_ns=time_lookups(storage, miss_keys, hits, miss_misses);
+    std::cout<<label<<": insert "<<load_ms<<" ms, hit "<<hit_ns<<" ns/lookup, miss "<<miss_ns<<" ns/lookup ("<<hits<<" hits)\n"
+             <<"    cache misses per lookup: hit L1d "<<per_lookup(hit_misses.l1d)<<" LLC "<<per_lookup(hit_misses.llc)
+             <<", miss L1d "<<per_lookup(miss_misses.l1d)<<" LLC "<<per_lookup(miss_misses.llc)<<"\n";
+}
+
+}
+
+int main(int argc, char** argv){
+    size_t n=argc>1 ? std::stoul(argv[1]) : 250000;
+    std::mt19937 rng(42);
+
+    std::vector<bench_record*> records;
+    records.reserve(n);
+    for(size_t i=0;i<n;i++){
+        std::string username="student_"+std::to_string(rng()%100000000)+"_"+std::to_string(i);
+        records.push_back(new bench_record{username, "Name "+std::to_string(i), username+"@example.edu", "password", {"PSHVJ9"}});
+    }
+
+    // Lookups in random order so the records are not visited in allocation order
+    std::vector<std::string> hit_keys;
+    for(size_t i=0;i<n;i++) hit_keys.push_back(records[rng()%n]->username);
+    std::vector<std::string> miss_keys;
+    for(size_t i=0;i<n;i++) miss_keys.push_back("missing_"+std::to_string(i));
+
+    std::cout<<n<<" records\n";
+    run<chained_storage<bench_record*>>("chained_storage", records, hit_keys, miss_keys);
+    run<flat_storage<bench_record*>>("flat_storage   ", records, hit_keys, miss_keys);
+
+    for(bench_record* r:records) delete r;
+}
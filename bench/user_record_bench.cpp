@@ -0,0 +1,172 @@
+/*
+ * Description: Hot/cold split of the user records. It loads N users into two student tables: one of `combined_record`, the layout
+ * `student_data` had before (email and password inline, between the name and the classroom list), and one of the real, split
+ * `student_data`. For each it reports the record size, the resident set size the load added, and the time and cache misses of
+ * two request shapes over random users:
+ *   - dashboard: find the user and read `name` and `classroomIds`, as the dashboards and rosters do. The combined record takes its
+ *     shared lock for that; the split one reads its `id_list` without a lock, so the request touches nothing but the first line;
+ *   - login: find the user and compare the password, as `/login_post` does.
+ * Each batch runs cold (caches flushed first) or warm, best of five rounds. Cache misses use the counters of `perf_counters.hpp` and print "n/a" without a PMU.
+ *
+ * Usage: user_record_bench [user_count]   (default 250000)
+ */
+
+#include "users.hpp"
+#include "perf_counters.hpp"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+
+// The record as it was before the split, field for field
+struct combined_record {
+    std::string name;
+    symbol_id username;
+    std::string email;
+    std::string password;
+    std::vector<entity_id> classroomIds;
+    mutable std::shared_mutex lock;
+
+    combined_record(std::string_view thename, std::string_view theusername, std::string_view theemail, std::string_view thepassword, const std::vector<entity_id>& theclassroomIds):
+    name(thename), username(symbol_table::instance().intern(theusername)), email(theemail), password(thepassword), classroomIds(theclassroomIds){}
+};
+
+symbol_id entity_key(const combined_record& r){ return r.username; }
+
+const std::string& password_of(const combined_record& r){ return r.password; }
+const std::string& password_of(const student_data& r){ return r.credentials->password; }
+
+// What a dashboard reads of the record, the way each layout has to read it
+size_t dashboard_of(const combined_record& r){
+    std::shared_lock<std::shared_mutex> guard(r.lock);
+    return r.name.size()+r.classroomIds.size();
+}
+size_t dashboard_of(const student_data& r){ return r.name.size()+r.classroomIds.read().size(); }
+
+// Resident set size in KiB, or 0 where /proc is unavailable
+long rss_kib(){
+    std::ifstream status("/proc/self/status");
+    std::string field;
+    while(status>>field){
+        if(field=="VmRSS:"){
+            long kib=0;
+            status>>kib;
+            return kib;
+        }
+    }
+    return 0;
+}
+
+// Evicts the tables from every cache level by walking a buffer larger than the last-level cache
+void flush_caches(){
+    static std::vector<char> buffer(64<<20);
+    volatile char sink=0;
+    for(size_t i=0;i<buffer.size();i+=64){
+        buffer[i]++;
+        sink=sink+buffer[i];
+    }
+}
+
+// Runs `request` for every key, with the caches flushed first or after a warm-up pass. Returns the mean nanoseconds per request
+// of the best of a few rounds, and fills `misses` from that round.
+template<typename Request>
+double time_requests(const std::vector<symbol_id>& keys, bool cold, miss_counts& misses, Request request){
+#ifdef __linux__
+    perf_counter l1d(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D|(PERF_COUNT_HW_CACHE_OP_READ<<8)|(PERF_COUNT_HW_CACHE_RESULT_MISS<<16));
+    perf_counter llc(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#else
+    perf_counter l1d(0, 0);
+    perf_counter llc(0, 0);
+#endif
+    const int rounds=5;
+    double best=1e18;
+    for(int r=0;r<rounds;r++){
+        if(cold) flush_caches();
+        else for(symbol_id key:keys) request(key);
+        l1d.start();
+        llc.start();
+        auto start=std::chrono::steady_clock::now();
+        for(symbol_id key:keys) request(key);
+        double ns=std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-start).count()/keys.size();
+        uint64_t llc_count=llc.stop();
+        uint64_t l1d_count=l1d.stop();
+        if(ns<best){
+            best=ns;
+            if(l1d.available()) misses.l1d=static_cast<double>(l1d_count)/keys.size();
+            if(llc.available()) misses.llc=static_cast<double>(llc_count)/keys.size();
+        }
+    }
+    return best;
+}
+
+template<typename Record>
+void run(const char* label, const std::vector<std::string>& names, const std::vector<symbol_id>& keys, const std::vector<symbol_id>& active){
+    const std::vector<entity_id> classrooms={entity_id::from_string("PSHVJ9"), entity_id::from_string("K2M0QX")};
+    long rss_before=rss_kib();
+    EntityTable<symbol_id, Record, symbol_hash, table_storage, no_persist> table(100);
+    table.reserve(names.size());
+    for(size_t i=0;i<names.size();i++){
+        table.emplace("Full Name "+std::to_string(i), names[i], names[i]+"@example.edu", "correct horse battery", classrooms);
+    }
+    long rss_after=rss_kib();
+
+    // The whole run is one read section, as each request is in the server
+    epoch_guard read_section;
+    size_t sink=0;
+    auto dashboard=[&](symbol_id key){
+        sink+=dashboard_of(*table.find(key));
+    };
+    auto login=[&](symbol_id key){
+        Record* user=table.find(key);
+        std::shared_lock<std::shared_mutex> guard(user->lock);
+        sink+=password_of(*user)=="correct horse battery";
+    };
+    auto report=[&](const char* request, const std::vector<symbol_id>& batch, bool cold, auto shape){
+        miss_counts misses;
+        double ns=time_requests(batch, cold, misses, shape);
+        std::cout<<"    "<<std::left<<std::setw(26)<<request<<std::right<<std::setw(5)<<ns<<" ns  (L1d "<<per_lookup(misses.l1d)<<", LLC "<<per_lookup(misses.llc)<<")\n";
+    };
+
+    std::cout<<label<<": sizeof "<<sizeof(Record)<<" B";
+    if(rss_after) std::cout<<", RSS +"<<std::fixed<<std::setprecision(1)<<(rss_after-rss_before)/1024.0<<" MiB";
+    std::cout<<std::setprecision(0)<<"\n";
+    report("dashboard, cold", keys, true, dashboard);
+    report("dashboard, warm", keys, false, dashboard);
+    report("dashboard, active users", active, false, dashboard);
+    report("login, cold", keys, true, login);
+    report("login, warm", keys, false, login);
+    if(!sink) std::cout<<"";
+}
+
+}
+
+int main(int argc, char** argv){
+    size_t n=argc>1 ? std::stoul(argv[1]) : 250000;
+    std::mt19937 rng(18);
+
+    std::vector<std::string> names;
+    for(size_t i=0;i<n;i++) names.push_back("student_"+std::to_string(i));
+    // Intern every username up front, so neither table pays for the symbol table in its RSS figure
+    for(const std::string& name:names) symbol_table::instance().intern(name);
+    std::vector<symbol_id> keys;
+    for(size_t i=0;i<n;i++) keys.push_back(symbol_table::instance().find(names[rng()%n]));
+
+    // The users active at one time: a tenth of them, requested over and over
+    std::vector<symbol_id> active;
+    for(size_t i=0;i<n;i++) active.push_back(keys[rng()%(n/10)]);
+
+    std::cout<<n<<" users, "<<keys.size()<<" requests of each kind\n";
+    run<combined_record>("combined ", names, keys, active);
+#ifdef __GLIBC__
+    malloc_trim(0);     // Hand the first table's pages back, so they do not hide the second table's growth
+#endif
+    run<student_data>("hot/cold ", names, keys, active);
+}
@@ -0,0 +1,524 @@
+#ifndef BPLUS_TREE_HPP
+#define BPLUS_TREE_HPP
+
+/*
+ * Description: This header defines `bplus_tree`, an ordered set, and `ordered_index`, the same set behind a reader-writer lock.
+ * The hash tables find a record by key but know no order. An ordered index sits beside a table, like the email index beside the
+ * user tables, and keeps its records (or their IDs) sorted by some other field: the students of a roster by username
+ * (`roster_set`), a classroom's quizzes by title (`quiz_hashTable`), a teacher's classrooms by name (`classroom_hashTable`).
+ * It answers range scans and hands out a page at a time, so a 10,000-student roster is shown 50 names per request without
+ * sorting or copying the rest.
+ *
+ * DSA Concepts:
+ * 1.  **B+ Tree:** Items live in leaves of up to `NodeSlots` entries, all at the same depth; inner nodes hold only separator keys.
+ * Finding a position is O(log n) with a wide fan-out (about log base 16 to 32 of n node visits), and each node visit is a scan
+ * of a few cache lines instead of one pointer hop per comparison, as a red-black tree would need.
+ * 2.  **Linked Leaves:** Each leaf points at the next, so a range scan finds its start once and then walks leaves in order.
+ * 3.  **Rebalancing:** Inserting splits a full node in two and pushes a separator up; erasing borrows from a sibling or merges with
+ * one when a node drops below half full, so every node but the root stays at least half full and the height stays O(log n).
+ * 4.  **Cursor Pagination:** A page ends at some item; the next page starts strictly after it (`upper_bound`). The cursor is the
+ * last item's sort key, not an offset, so pages stay correct while items are added or removed in between, and a page costs
+ * O(log n + page size) however deep into the list it is.
+ *
+ * `Less` orders the items and must be a strict weak order under which no two items are equivalent. Like `std::less<>`, it may
+ * also compare items with a probe type (e.g. a username or a cursor decoded from a URL), as `less(probe, item)` and
+ * `less(item, probe)`, so a position can be searched for without an item. It must give the same answer for as long as an item
+ * is in the tree, so it may only read fields of the item that never change.
+ *
+ * Thread safety: `bplus_tree` has none of its own; its owner guards it (`roster_set` by the classroom's lock). `ordered_index`
+ * takes its own lock: shared for scans, exclusive for changes.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+template<typename T, typename Less, size_t NodeSlots = 32>
+class bplus_tree {
+    static_assert(NodeSlots>=4, "a B+ tree node needs room for at least four entries");
+
+    // A node other than the root holds at least MIN_SLOTS entries (keys for an inner node); merging two neighbours below it fits one node
+    static constexpr size_t MIN_SLOTS = NodeSlots/2;
+
+    struct node {
+        bool leaf;
+        uint16_t count=0;   // Items of a leaf, keys of an inner node
+        explicit node(bool isleaf): leaf(isleaf){}
+    };
+
+    struct leaf_node : node {
+        T items[NodeSlots];
+        leaf_node* next=nullptr;    // The leaf with the next larger items
+        leaf_node(): node(true){}
+    };
+
+    // children[i] holds items < keys[i] <= the items of children[i + 1]
+    struct inner_node : node {
+        T keys[NodeSlots];
+        node* children[NodeSlots+1];
+        inner_node(): node(false){}
+    };
+
+    // What a child hands its parent after a split: the first key of the new right sibling, and the sibling
+    struct split_result {
+        node* right=nullptr;
+        T key{};
+    };
+
+    node* root=nullptr;
+    size_t item_count=0;
+    size_t leaf_count=0;
+    size_t inner_count=0;
+    Less less;
+
+    // Index of the child of `n` whose range holds `probe`
+    template<typename Probe>
+    size_t child_of(const inner_node* n, const Probe& probe) const {
+        size_t i=0;
+        while(i<n->count && !less(probe, n->keys[i])) i++;
+        return i;
+    }
+
+    // Position of the first item of `n` not less than `probe`
+    template<typename Probe>
+    size_t lower_in(const leaf_node* n, const Probe& probe) const {
+        size_t i=0;
+        while(i<n->count && less(n->items[i], probe)) i++;
+        return i;
+    }
+
+    // The leaf whose range holds `probe`. The tree is not empty.
+    template<typename Probe>
+    const leaf_node* leaf_of(const Probe& probe) const {
+        const node* n=root;
+        while(!n->leaf){
+            const inner_node* inner=static_cast<const inner_node*>(n);
+            n=inner->children[child_of(inner, probe)];
+        }
+        return static_cast<const leaf_node*>(n);
+    }
+
+    leaf_node* new_leaf(){
+        leaf_count++;
+        return new leaf_node();
+    }
+
+    inner_node* new_inner(){
+        inner_count++;
+        return new inner_node();
+    }
+
+    void delete_node(node* n){
+        if(n->leaf){
+            leaf_count--;
+            delete static_cast<leaf_node*>(n);
+        }
+        else{
+            inner_count--;
+            delete static_cast<inner_node*>(n);
+        }
+    }
+
+    void destroy(node* n){
+        if(!n) return;
+        if(!n->leaf){
+            inner_node* inner=static_cast<inner_node*>(n);
+            for(size_t i=0;i<=inner->count;i++) destroy(inner->children[i]);
+        }
+        delete_node(n);
+    }
+
+    // Inserts `item` under `n`; `inserted` is false if an equivalent item is already there. Splits `n` if it overflows.
+    split_result insert_into(node* n, const T& item, bool& inserted){
+        if(n->leaf){
+            leaf_node* leaf=static_cast<leaf_node*>(n);
+            size_t pos=lower_in(leaf, item);
+            if(pos<leaf->count && !less(item, leaf->items[pos])){
+                inserted=false;
+                return split_result();
+            }
+            inserted=true;
+            if(leaf->count<NodeSlots){
+                for(size_t i=leaf->count;i>pos;i--) leaf->items[i]=leaf->items[i-1];
+                leaf->items[pos]=item;
+                leaf->count++;
+                return split_result();
+            }
+            // Full: the NodeSlots + 1 items are shared between this leaf and a new right sibling
+            T all[NodeSlots+1];
+            for(size_t i=0, j=0;i<=NodeSlots;i++) all[i]=i==pos ? item : leaf->items[j++];
+            leaf_node* right=new_leaf();
+            size_t keep=(NodeSlots+1)/2;
+            for(size_t i=0;i<keep;i++) leaf->items[i]=all[i];
+            for(size_t i=keep;i<=NodeSlots;i++) right->items[i-keep]=all[i];
+            leaf->count=static_cast<uint16_t>(keep);
+            right->count=static_cast<uint16_t>(NodeSlots+1-keep);
+            right->next=leaf->next;
+            leaf->next=right;
+            return split_result{right, right->items[0]};
+        }
+
+        inner_node* inner=static_cast<inner_node*>(n);
+        size_t at=child_of(inner, item);
+        split_result below=insert_into(inner->children[at], item, inserted);
+        if(!below.right) return split_result();
+        if(inner->count<NodeSlots){
+            for(size_t i=inner->count;i>at;i--){
+                inner->keys[i]=inner->keys[i-1];
+                inner->children[i+1]=inner->children[i];
+            }
+            inner->keys[at]=below.key;
+            inner->children[at+1]=below.right;
+            inner->count++;
+            return split_result();
+        }
+        // Full: of the NodeSlots + 1 keys, the middle one moves up and the rest are shared with a new right sibling
+        T keys[NodeSlots+1];
+        node* children[NodeSlots+2];
+        for(size_t i=0, j=0;i<=NodeSlots;i++) keys[i]=i==at ? below.key : inner->keys[j++];
+        for(size_t i=0, j=0;i<=NodeSlots+1;i++) children[i]=i==at+1 ? below.right : inner->children[j++];
+        inner_node* right=new_inner();
+        size_t mid=(NodeSlots+1)/2;
+        for(size_t i=0;i<mid;i++){
+            inner->keys[i]=keys[i];
+            inner->children[i]=children[i];
+        }
+        inner->children[mid]=children[mid];
+        inner->count=static_cast<uint16_t>(mid);
+        for(size_t i=mid+1;i<=NodeSlots;i++){
+            right->keys[i-mid-1]=keys[i];
+            right->children[i-mid-1]=children[i];
+        }
+        right->children[NodeSlots-mid]=children[NodeSlots+1];
+        right->count=static_cast<uint16_t>(NodeSlots-mid);
+        return split_result{right, keys[mid]};
+    }
+
+    // Removes key `k` and child `k + 1` of `n`
+    static void remove_entry(inner_node* n, size_t k){
+        for(size_t i=k;i+1<n->count;i++) n->keys[i]=n->keys[i+1];
+        for(size_t i=k+1;i<n->count;i++) n->children[i]=n->children[i+1];
+        n->count--;
+    }
+
+    // Child `i` of `parent` has dropped below MIN_SLOTS: borrows an entry from a sibling that can spare one, else merges with a sibling
+    void rebalance(inner_node* parent, size_t i){
+        node* child=parent->children[i];
+        node* left=i>0 ? parent->children[i-1] : nullptr;
+        node* right=i<parent->count ? parent->children[i+1] : nullptr;
+
+        if(child->leaf){
+            leaf_node* c=static_cast<leaf_node*>(child);
+            leaf_node* l=static_cast<leaf_node*>(left);
+            leaf_node* r=static_cast<leaf_node*>(right);
+            if(l && l->count>MIN_SLOTS){
+                for(size_t j=c->count;j>0;j--) c->items[j]=c->items[j-1];
+                c->items[0]=l->items[--l->count];
+                c->count++;
+                parent->keys[i-1]=c->items[0];
+            }
+            else if(r && r->count>MIN_SLOTS){
+                c->items[c->count++]=r->items[0];
+                for(size_t j=0;j+1<r->count;j++) r->items[j]=r->items[j+1];
+                r->count--;
+                parent->keys[i]=r->items[0];
+            }
+            else{
+                // Merge the right one of the pair into the left one
+                leaf_node* into=l ? l : c;
+                leaf_node* from=l ? c : r;
+                for(size_t j=0;j<from->count;j++) into->items[into->count++]=from->items[j];
+                into->next=from->next;
+                remove_entry(parent, l ? i-1 : i);
+                delete_node(from);
+            }
+            return;
+        }
+
+        inner_node* c=static_cast<inner_node*>(child);
+        inner_node* l=static_cast<inner_node*>(left);
+        inner_node* r=static_cast<inner_node*>(right);
+        if(l && l->count>MIN_SLOTS){
+            // The separator comes down in front of the child and the left sibling's last key goes up in its place
+            for(size_t j=c->count;j>0;j--) c->keys[j]=c->keys[j-1];
+            for(size_t j=c->count+1;j>0;j--) c->children[j]=c->children[j-1];
+            c->keys[0]=parent->keys[i-1];
+            c->children[0]=l->children[l->count];
+            c->count++;
+            parent->keys[i-1]=l->keys[--l->count];
+        }
+        else if(r && r->count>MIN_SLOTS){
+            c->keys[c->count]=parent->keys[i];
+            c->children[c->count+1]=r->children[0];
+            c->count++;
+            parent->keys[i]=r->keys[0];
+            for(size_t j=0;j+1<r->count;j++) r->keys[j]=r->keys[j+1];
+            for(size_t j=0;j<r->count;j++) r->children[j]=r->children[j+1];
+            r->count--;
+        }
+        else{
+            // Merge the right one of the pair and the separator between them into the left one
+            size_t k=l ? i-1 : i;
+            inner_node* into=l ? l : c;
+            inner_node* from=l ? c : r;
+            into->keys[into->count]=parent->keys[k];
+            for(size_t j=0;j<from->count;j++) into->keys[into->count+1+j]=from->keys[j];
+            for(size_t j=0;j<=from->count;j++) into->children[into->count+1+j]=from->children[j];
+            into->count=static_cast<uint16_t>(into->count+1+from->count);
+            remove_entry(parent, k);
+            delete_node(from);
+        }
+    }
+
+    // Removes the item equivalent to `probe` from under `n`; returns whether there was one
+    template<typename Probe>
+    bool erase_from(node* n, const Probe& probe){
+        if(n->leaf){
+            leaf_node* leaf=static_cast<leaf_node*>(n);
+            size_t pos=lower_in(leaf, probe);
+            if(pos==leaf->count || less(probe, leaf->items[pos])) return false;
+            for(size_t i=pos;i+1<leaf->count;i++) leaf->items[i]=leaf->items[i+1];
+            leaf->count--;
+            return true;
+        }
+        inner_node* inner=static_cast<inner_node*>(n);
+        size_t at=child_of(inner, probe);
+        if(!erase_from(inner->children[at], probe)) return false;
+        if(inner->children[at]->count<MIN_SLOTS) rebalance(inner, at);
+        return true;
+    }
+
+public:
+    // A position in the tree. Any change to the tree invalidates it.
+    class const_iterator {
+        const leaf_node* leaf=nullptr;
+        size_t pos=0;
+
+        friend class bplus_tree;
+
+        const_iterator(const leaf_node* theleaf, size_t thepos): leaf(theleaf), pos(thepos){
+            // A position past the end of a leaf is the first item of the next one
+            if(leaf && pos==leaf->count){
+                leaf=leaf->next;
+                pos=0;
+            }
+        }
+
+    public:
+        const_iterator() = default;
+
+        const T& operator*() const { return leaf->items[pos]; }
+
+        const_iterator& operator++(){
+            if(++pos==leaf->count){
+                leaf=leaf->next;
+                pos=0;
+            }
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return leaf==other.leaf && pos==other.pos; }
+        bool operator!=(const const_iterator& other) const { return !(*this==other); }
+    };
+
+    bplus_tree() = default;
+    bplus_tree(const bplus_tree&) = delete;
+    bplus_tree& operator=(const bplus_tree&) = delete;
+
+    bplus_tree(bplus_tree&& other) noexcept:
+    root(other.root), item_count(other.item_count), leaf_count(other.leaf_count), inner_count(other.inner_count), less(other.less){
+        other.root=nullptr;
+        other.item_count=other.leaf_count=other.inner_count=0;
+    }
+
+    bplus_tree& operator=(bplus_tree&& other) noexcept {
+        if(this!=&other){
+            clear();
+            std::swap(root, other.root);
+            std::swap(item_count, other.item_count);
+            std::swap(leaf_count, other.leaf_count);
+            std::swap(inner_count, other.inner_count);
+        }
+        return *this;
+    }
+
+    ~bplus_tree(){
+        destroy(root);
+    }
+
+    void clear(){
+        destroy(root);
+        root=nullptr;
+        item_count=0;
+    }
+
+    size_t size() const { return item_count; }
+    bool empty() const { return item_count==0; }
+
+    // Bytes of the tree's nodes, for the memory report (see `MemoryUsage.hpp`). O(1).
+    size_t memory_bytes() const { return leaf_count*sizeof(leaf_node)+inner_count*sizeof(inner_node); }
+
+    /*
+     * Adds `item`. Returns false, and changes nothing, if an equivalent item is already there.
+     * Time Complexity: O(log n).
+     */
+    bool insert(const T& item){
+        if(!root) root=new_leaf();
+        bool inserted=false;
+        split_result split=insert_into(root, item, inserted);
+        if(split.right){
+            // The root split: the tree grows one level
+            inner_node* top=new_inner();
+            top->keys[0]=split.key;
+            top->children[0]=root;
+            top->children[1]=split.right;
+            top->count=1;
+            root=top;
+        }
+        if(inserted) item_count++;
+        return inserted;
+    }
+
+    /*
+     * Removes the item equivalent to `probe` (an item or a probe `Less` accepts). Returns false if there is none.
+     * Time Complexity: O(log n).
+     */
+    template<typename Probe>
+    bool erase(const Probe& probe){
+        if(!root || !erase_from(root, probe)) return false;
+        item_count--;
+        // The tree shrinks one level when the root is left with a single child, and is freed when its last item goes
+        if(!root->leaf && root->count==0){
+            node* old=root;
+            root=static_cast<inner_node*>(old)->children[0];
+            delete_node(old);
+        }
+        else if(root->leaf && root->count==0){
+            delete_node(root);
+            root=nullptr;
+        }
+        return true;
+    }
+
+    const_iterator begin() const {
+        if(!root) return end();
+        const node* n=root;
+        while(!n->leaf) n=static_cast<const inner_node*>(n)->children[0];
+        return const_iterator(static_cast<const leaf_node*>(n), 0);
+    }
+
+    const_iterator end() const { return const_iterator(); }
+
+    // The first item not less than `probe`. O(log n).
+    template<typename Probe>
+    const_iterator lower_bound(const Probe& probe) const {
+        if(!root) return end();
+        const leaf_node* leaf=leaf_of(probe);
+        return const_iterator(leaf, lower_in(leaf, probe));
+    }
+
+    // The first item greater than `probe`: where the page after a cursor starts. O(log n).
+    template<typename Probe>
+    const_iterator upper_bound(const Probe& probe) const {
+        if(!root) return end();
+        const leaf_node* leaf=leaf_of(probe);
+        size_t pos=0;
+        while(pos<leaf->count && !less(probe, leaf->items[pos])) pos++;
+        return const_iterator(leaf, pos);
+    }
+
+    /*
+     * Up to `limit` items in order from `from`, stopping early at the first one for which `in_range` is false (the end of a
+     * key prefix). `more` is set if the range has items beyond the page.
+     * Time Complexity: O(limit).
+     */
+    template<typename InRange>
+    std::vector<T> page(const_iterator from, size_t limit, InRange in_range, bool& more) const {
+        std::vector<T> items;
+        more=false;
+        for(const_iterator it=from; it!=end() && in_range(*it); ++it){
+            if(items.size()==limit){
+                more=true;
+                break;
+            }
+            items.push_back(*it);
+        }
+        return items;
+    }
+};
+
+/*
+ * A `bplus_tree` shared between requests, kept by a table beside its records (see the tables' `by_*` members). The table adds a
+ * record's entry after creating it and removes it together with the record; `insert_if` and `erase_with` run the table's own
+ * check or erase under the index's exclusive lock, so an entry can never outlive its record.
+ * Lock order: the index lock is taken before any lock of the table's storage, and no record lock is taken under it.
+ */
+template<typename T, typename Less, size_t NodeSlots = 32>
+class ordered_index {
+    bplus_tree<T, Less, NodeSlots> tree;
+    mutable std::shared_mutex index_lock;   // Shared for scans, exclusive for changes
+
+public:
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> guard(index_lock);
+        return tree.size();
+    }
+
+    size_t memory_bytes() const {
+        std::shared_lock<std::shared_mutex> guard(index_lock);
+        return tree.memory_bytes();
+    }
+
+    // Adds `item`, e.g. while building the index from a freshly loaded table. O(log n).
+    bool insert(const T& item){
+        std::unique_lock<std::shared_mutex> guard(index_lock);
+        return tree.insert(item);
+    }
+
+    /*
+     * Adds `item` if `still_there()` holds, e.g. if its record was not erased by another request since it was created.
+     * Time Complexity: O(log n), plus the check.
+     */
+    template<typename Check>
+    bool insert_if(const T& item, Check still_there){
+        std::unique_lock<std::shared_mutex> guard(index_lock);
+        return still_there() && tree.insert(item);
+    }
+
+    /*
+     * Runs `erase_record()` and, if it erased the record, removes `item`. Returns what `erase_record` returned.
+     * Time Complexity: O(log n), plus the erase.
+     */
+    template<typename Erase>
+    bool erase_with(const T& item, Erase erase_record){
+        std::unique_lock<std::shared_mutex> guard(index_lock);
+        if(!erase_record()) return false;
+        tree.erase(item);
+        return true;
+    }
+
+    /*
+     * Up to `limit` items from the first one not less than `from`, while `in_range` holds. `more` is set if there are more.
+     * Time Complexity: O(log n + limit).
+     */
+    template<typename Probe, typename InRange>
+    std::vector<T> page_from(const Probe& from, size_t limit, InRange in_range, bool& more) const {
+        std::shared_lock<std::shared_mutex> guard(index_lock);
+        return tree.page(tree.lower_bound(from), limit, in_range, more);
+    }
+
+    /*
+     * Up to `limit` items after the cursor `after`, while `in_range` holds. `more` is set if there are more.
+     * Time Complexity: O(log n + limit).
+     */
+    template<typename Probe, typename InRange>
+    std::vector<T> page_after(const Probe& after, size_t limit, InRange in_range, bool& more) const {
+        std::shared_lock<std::shared_mutex> guard(index_lock);
+        return tree.page(tree.upper_bound(after), limit, in_range, more);
+    }
+};
+
+#endif
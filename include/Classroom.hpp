@@ -5,20 +5,39 @@
  * Description: This header defines the data structure for classrooms and the hash table (`classroom_hashTable`) to manage them.
  *
  * DSA Concepts:
- * 1.  **Hash Table:** `classroom_hashTable` maps a unique `class_code` (string) to the corresponding `classroom_data`. This allows for O(1)
- * average-case lookup when a student tries to join a class or a teacher views their class.
+ * 1.  **Hash Table:** `classroom_hashTable` maps a unique `class_code` (an `entity_id`, see `EntityId.hpp`) to the corresponding
+ * `classroom_data`. This allows for O(1) average-case lookup when a student tries to join a class or a teacher views their class.
  * 2.  **Separate Chaining:** Collisions (if two class codes hash to the same index) are handled using a linked list (`classroom_link`).
- * 3.  **Hash Function:** The same `fnv1a` function is used for hashing the `class_code`.
+ * 3.  **Hash Function:** The six-character code is stored as its base-36 integer, hashed with `entity_id::hash` and compared as an integer.
+ * The string overload of `findClassroom` decodes the code once and does the same lookup.
+ * 4.  **Read-Copy-Update:** `findClassroom` runs on almost every page view while classrooms are created rarely, so the table uses
+ * `catalog_storage`: by default the lock-free `rcu_storage` (see `RcuStorage.hpp`), otherwise the growable `table_storage`.
+ * 5.  **Slab Allocation:** `classroom_data` records are created in the `slab_pool` of the underlying `EntityTable` (see `EntityTable.hpp`)
+ * and freed in bulk.
+ * 6.  **String Interning:** The owner and the roster hold interned `symbol_id`s (see `SymbolTable.hpp`), so a roster entry is 4 bytes
+ * and the "already joined" check compares integers.
+ * 7.  **Hash Set:** The roster is a `roster_set` (see `RosterSet.hpp`): the students in join order plus an open-addressing set of
+ * their ids, so checking a student's enrollment is O(1) even in a lecture class of thousands (`isEnrolled`).
+ * 8.  **Ordered Index:** `by_name` is a B+ tree of the classrooms ordered by (teacher, class name, code) (see `BPlusTree.hpp`), so a
+ * teacher's classrooms are one contiguous range of it, already in name order (`classroomsByName`).
  */
 
-#include "crow.h"
-#include "crow/middlewares/cookie_parser.h"
-#include "crow/middlewares/session.h"
 #include <iostream>
 #include <filesystem>
+#include <fstream>
+#include <random>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <any>
+#include <mutex>
+#include <shared_mutex>
+#include "EntityTable.hpp"
+#include "EntityId.hpp"
+#include "SymbolTable.hpp"
+#include "RosterSet.hpp"
+#include "BPlusTree.hpp"
+#include "JsonFile.hpp"
 
 using njson = nlohmann::json;
 
@@ -26,153 +45,120 @@ using njson = nlohmann::json;
 struct classroom_data {
     std::string class_name;
     std::string subject;
-    std::string class_code; // The primary key for the hash table
-    std::string teacher_username;   // The "owner" of the class
-    std::vector<std::string> student_usernames; // List of joined students
-    std::vector<std::string> quizIds;   // List of quizzes in this class
+    entity_id class_code; // The primary key for the hash table
+    symbol_id teacher_username;   // The "owner" of the class
+    roster_set student_usernames; // Joined students, in join order, with an O(1) membership check
+    std::vector<entity_id> quizIds;   // List of quizzes in this class
+    mutable std::shared_mutex lock;     // Guards `student_usernames` and `quizIds`; hold it shared while iterating them
 
-    classroom_data(const std::string& theclass_name, const std::string& thesubject, const std::string& theclass_code, const std::string& theteacher_username, const std::vector<std::string>& thequizIds)
-        : class_name(theclass_name), subject(thesubject), class_code(theclass_code), teacher_username(theteacher_username), quizIds(thequizIds) {}
+    classroom_data(std::string theclass_name, std::string thesubject, entity_id theclass_code, symbol_id theteacher_username, std::vector<entity_id> thequizIds)
+        : class_name(std::move(theclass_name)), subject(std::move(thesubject)), class_code(theclass_code), teacher_username(theteacher_username), quizIds(std::move(thequizIds)) {}
 };
 
 // Linked list node for the classroom hash table (separate chaining)
-struct classroom_link {
-    classroom_data* data = nullptr;
-    classroom_link* next = nullptr;
-};
+using classroom_link = hash_link<classroom_data*>;
 
 void to_json(njson& j, const classroom_data& c);
 
+// The classroom table is keyed by the class code
+inline entity_id entity_key(const classroom_data& c) { return c.class_code; }
+
+// Heap bytes a classroom owns (see `EntityTable::memory`): its name and subject, the roster and the quiz list
+inline void entity_memory(const classroom_data& c, memory_usage& usage) {
+    std::shared_lock<std::shared_mutex> guard(c.lock);
+    usage.strings += heap_bytes(c.class_name) + heap_bytes(c.subject);
+    usage.vectors += c.student_usernames.heap_bytes() + heap_bytes(c.quizIds);
+}
+
+// A place in the (teacher, class name, code) order of `classroom_hashTable::by_name`
+struct classroom_position {
+    symbol_id teacher;
+    std::string_view name;
+    entity_id code;
+
+    static classroom_position of(const classroom_data& c) { return classroom_position{c.teacher_username, c.class_name, c.class_code}; }
+
+    bool operator<(const classroom_position& other) const {
+        if (teacher.value != other.teacher.value) return teacher.value < other.teacher.value;
+        if (name != other.name) return name < other.name;
+        return code.value < other.code.value;
+    }
+};
+
+// Orders classrooms by teacher, then name, then code. None of the three changes once a classroom is created.
+struct classroom_name_order {
+    bool operator()(const classroom_data* a, const classroom_data* b) const { return classroom_position::of(*a) < classroom_position::of(*b); }
+    bool operator()(const classroom_data* a, const classroom_position& b) const { return classroom_position::of(*a) < b; }
+    bool operator()(const classroom_position& a, const classroom_data* b) const { return a < classroom_position::of(*b); }
+};
+
+// File format of the classroom table (see `json_file_persist`)
+struct classroom_file : json_file_format {
+    static constexpr const char* path = "Data/classrooms.json";
+    static constexpr bool required = false;
+
+    template<typename Table>
+    static void read(Table& table, njson& room) {
+        // 1. Extract data from JSON, moving the strings out of the parsed element
+        std::string class_name = takeText(room, "class_name");
+        std::string subject = takeText(room, "subject");
+        entity_id class_code = room.value("class_code", entity_id());
+        symbol_id teacher_username = room.value("teacher_username", symbol_id());
+        std::vector<entity_id> quizIds = room.value("quizIds", std::vector<entity_id>{});
+        std::vector<symbol_id> student_usernames = room.value("student_usernames", std::vector<symbol_id>{});
+
+        // 2. Create the data object in place and insert it under its class code; the lists are moved in, not copied
+        classroom_data* new_room = table.emplace(std::move(class_name), std::move(subject), class_code, teacher_username, std::move(quizIds));
+        new_room->student_usernames.assign(std::move(student_usernames));
+    }
+};
+
 
 // Description: Implements a hash table to store all classroom data.
 // The key is the `class_code`.
 class classroom_hashTable {
 private:
-    classroom_link** classrooms;
-    int size;
-
-    // FNV-1a hash function
-    uint32_t fnv1a(const std::string& s) {
-        const uint32_t basis = 2166136261u;
-        const uint32_t prime = 16777619u;
-        uint32_t hash = basis;
-        for (unsigned char c : s) {
-            hash ^= c;
-            hash *= prime;
-        }
-        return hash;
-    }
-    
-    // Generates a random 6-character string for the class code
-    std::string generate_class_code() {
-        const std::string chars = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    // Lock-free lookups in the default (RCU) build
+    EntityTable<entity_id, classroom_data, entity_id_hash, catalog_storage, json_file_persist<classroom_file>> classrooms;
+    ordered_index<classroom_data*, classroom_name_order> by_name;   // Every classroom, by teacher and name
+
+    // Generates a random class code (six base-36 characters, held as their integer value)
+    entity_id generate_class_code() {
         std::random_device rd;
         std::mt19937 generator(rd());
-        std::uniform_int_distribution<> distribution(0, chars.size() - 1);
-        
-        std::stringstream ss;
-        for (int i = 0; i < 6; ++i) {
-            ss << chars[distribution(generator)];
-        }
-        return ss.str();
-    }
-
-    // Loads classroom data from JSON file and populates the hash table
-    void makeClassrooms_hashtable(int& table_size, std::ifstream& file) {
-        njson data;
-
-        file>>data;
-        for (const auto& room : data) {
-            // 1. Extract data from JSON
-            std::string class_name = room.value("class_name", "");
-            std::string subject = room.value("subject", "");
-            std::string class_code = room.value("class_code", "");
-            std::string teacher_username = room.value("teacher_username", "");
-            std::vector<std::string> quizIds = room.value("quizIds", std::vector<std::string>{});
-            std::vector<std::string> student_usernames = room.value("student_usernames", std::vector<std::string>{});
-
-            // 2. Hash the key (class_code)
-            uint32_t index = fnv1a(class_code) % table_size;
-
-            // 3. Create the data object
-            classroom_data* new_room = new classroom_data(class_name, subject, class_code, teacher_username, quizIds);
-            new_room->student_usernames = student_usernames;
-
-            // 4. Insert into hash table (add to front of list)
-            classroom_link* newnode = new classroom_link;
-            newnode->data=new_room;
-            if (classrooms[index]) {
-                newnode->next = classrooms[index];
-                classrooms[index]=newnode;
-            }
-            else{
-                classrooms[index] = newnode;
-            }
-        }
+        return entity_id::random(generator);
     }
 
 public:
-    // Constructor: Initializes and populates the hash table
-    classroom_hashTable() {
-        size = 50;
-        classrooms = new classroom_link*[size];
-
-        // Initialize all list heads to nullptr
-        for(int i=0; i<size; i++){
-            classrooms[i]=nullptr;
-        }
-        std::ifstream classroomFile("Data/classrooms.json");
-        if (classroomFile.is_open()) {
-            makeClassrooms_hashtable(size, classroomFile);
-        } else {
-            // If file doesn't exist, create an empty one
-            std::ofstream newFile("Data/classrooms.json");
-            newFile << "[]";
-            newFile.close();
+    // Constructor: Initializes and populates the hash table (or creates an empty classrooms.json), then indexes the classrooms by name
+    classroom_hashTable(): classrooms(50) {
+        // Collected first: the index is never updated under the table's storage locks (see `ordered_index`)
+        std::vector<classroom_data*> loaded;
+        classrooms.for_each([&loaded](classroom_data* room) { loaded.push_back(room); });
+        for (classroom_data* room : loaded) {
+            by_name.insert(room);
         }
     }
 
-    // Saves all classroom data back to the JSON file
+    // Saves all classroom data back to the JSON file.
+    // Records are serialised after the table locks are released, since `to_json` locks each classroom.
     void saveClassroomsToFile() {
-        njson classrooms_json_array = njson::array();
-        // Traverse the entire hash table array
-        for (int i = 0; i < size; ++i) {
-            classroom_link* curr = classrooms[i];
-            // Traverse the linked list at this index
-            while (curr != nullptr) {
-                classrooms_json_array.push_back(*(curr->data));
-                classroom_link* next = curr->next;
-                curr = next;
-            }
-        }
-
-        std::ofstream classroomFile("Data/classrooms.json");
-        classroomFile << classrooms_json_array.dump(4);
-        classroomFile.close();
+        classrooms.save();
     }
 
 
     /*
-     * Creates a new classroom, adds it to the hash table, and returns the code.
+     * Creates a new classroom, adds it to the hash table, and returns the code. The name and subject are moved into the record.
      * Time Complexity: O(1) average. (Generation + Hash + Insertion)
-     * Note: In a very rare case, `generate_class_code` could create a duplicate. A robust implementation would check for this and regenerate, but for this project, the collision chance is negligible.
+     * Note: In a very rare case, `generate_class_code` creates a code already in use. The insert checks for this atomically
+     * (`emplace_unique`) and gives the record a new code.
      */
-    std::string addClassroom(const std::string& name, const std::string& subject, teacher_data* teacher) {
-        std::string code = generate_class_code();
-        uint32_t index = fnv1a(code) % size;
-
-        // Create new data and node
-        classroom_data* new_room_data = new classroom_data(name, subject, code, teacher->username,{});
-        classroom_link* newnode = new classroom_link;
-        newnode->data=new_room_data;
-
-        // Insert at the head of the linked list
-        if (classrooms[index]) {
-            newnode->next = classrooms[index];
-        }
-        classrooms[index] = newnode;
-
-        return code;
+    entity_id addClassroom(std::string name, std::string subject, teacher_data* teacher) {
+        classroom_data* room = classrooms.emplace_unique([this](classroom_data& taken) { taken.class_code = generate_class_code(); },
+                                                         std::move(name), std::move(subject), generate_class_code(), teacher->username, std::vector<entity_id>{});
+        // Unless a concurrent delete has already taken it out again
+        by_name.insert_if(room, [this, room] { return classrooms.find(room->class_code) == room; });
+        return room->class_code;
     }
 
     /*
@@ -181,37 +167,91 @@ public:
      * - Average: O(1).
      * - Worst: O(n), where n is the total number of classrooms.
      */
-    classroom_data* findClassroom(const std::string& code) {
-        uint32_t index = fnv1a(code) % size;
-        classroom_link* node = classrooms[index];
-        // Traverse the linked list at the calculated index
-        while (node) {
-            if (node->data->class_code == code) return node->data;
-            node = node->next;
+    classroom_data* findClassroom(entity_id code) {
+        return classrooms.find(code);
+    }
+
+    // Finds a classroom by the text of its code (from a URL, a form or a user's `classroomIds`). Malformed codes are never found.
+    classroom_data* findClassroom(std::string_view code) {
+        entity_id id = entity_id::from_string(code);
+        return id.valid() ? findClassroom(id) : nullptr;
+    }
+
+    /*
+     * Whether `room` is still in the table, i.e. has not been removed. Checked under the classroom's lock before linking a
+     * student or a quiz to it: the removal erases the record before it reads the roster and `quizIds` under that lock, so the
+     * link is either made in time to be cleaned up with the classroom or not made at all.
+     * Time Complexity: O(1) average.
+     */
+    bool isLive(const classroom_data& room) {
+        return findClassroom(room.class_code) == &room;
+    }
+
+    /*
+     * Checks whether a student is enrolled in a classroom, e.g. before letting them attempt one of its quizzes.
+     * A classroom that no longer exists has nobody enrolled.
+     * Time Complexity: O(1) average.
+     */
+    bool isEnrolled(entity_id code, symbol_id student) {
+        classroom_data* room = findClassroom(code);
+        if (!room) {
+            return false;
         }
-        return nullptr;
+        std::shared_lock<std::shared_mutex> room_guard(room->lock);
+        return room->student_usernames.contains(student);
     }
 
-    // Destructor: Saves data and deallocates all memory
-    ~classroom_hashTable() {
-        std::cout << "Saving classroom data to file..." << std::endl;
+    /*
+     * Finds a batch of classrooms (e.g. a user's `classroomIds`): entry `i` is the classroom of `codes[i]`, or nullptr.
+     * Time Complexity: O(n) average, with the cache misses of different classrooms overlapping.
+     */
+    std::vector<classroom_data*> findClassrooms(const std::vector<entity_id>& codes) {
+        return classrooms.find_many(codes);
+    }
 
-        njson classrooms_json_array = njson::array();
-        for (int i = 0; i < size; ++i) {
-            classroom_link* curr = classrooms[i];
-            while (curr != nullptr) {
-                classrooms_json_array.push_back(*(curr->data));
-                classroom_link* next = curr->next;
-                delete curr->data;
-                delete curr;
-                curr = next;
-            }
+    // Same, for a snapshot of a user's `classroomIds` (see `IdList.hpp`), read without copying it
+    std::vector<classroom_data*> findClassrooms(id_list::view codes) {
+        return classrooms.find_many(codes);
+    }
+
+    /*
+     * Removes a classroom. Returns false if it is already gone.
+     * The record stays readable until the caller's request ends, so the caller can still read its roster and `quizIds`
+     * to clean up the students' `classroomIds`, the teacher's, and the quizzes.
+     * Time Complexity: O(log n) average.
+     */
+    bool removeClassroom(entity_id code) {
+        // Keeps the record alive while it is compared on its way out of the index, even outside a request
+        epoch_guard read_section;
+        classroom_data* room = findClassroom(code);
+        if (!room) {
+            return false;
         }
-        std::ofstream classroomFile("Data/classrooms.json");
-        classroomFile << classrooms_json_array.dump(4);
-        classroomFile.close();
+        return by_name.erase_with(room, [this, code] { return classrooms.erase(code); });
+    }
 
-        delete[] classrooms;
+    /*
+     * Finds a teacher's classrooms in name order (ties in code order).
+     * Time Complexity: O(log n + k), for n classrooms in the system and k of the teacher's.
+     */
+    std::vector<classroom_data*> classroomsByName(symbol_id teacher) {
+        bool more = false;
+        return by_name.page_from(classroom_position{teacher, std::string_view(), entity_id(0)}, SIZE_MAX,
+                                 [teacher](const classroom_data* room) { return room->teacher_username == teacher; }, more);
+    }
+
+    // Bytes held by the classroom table, for the memory report (see `MemoryUsage.hpp`). O(n).
+    memory_usage memoryUsage() {
+        memory_usage usage = classrooms.memory();
+        usage.nodes += by_name.memory_bytes();
+        return usage;
+    }
+
+    // Destructor: Saves data and deallocates all memory
+    ~classroom_hashTable() {
+        std::cout << "Saving classroom data to file..." << std::endl;
+        saveClassroomsToFile();
+        // The table destructs its own records
     }
 };
 
@@ -4,7 +4,7 @@
 /*
  * Description: This is a central header file. Its main purpose is to:
  * 1.  Include all the major components of the application (Crow, Session, and all our custom data structure headers).
- * 2.  Define a common type alias for the Crow Session.
+ * 2.  Define common type aliases for the Crow Session and the application, and the `ReadSection` middleware.
  * 3.  Provide forward declarations for all the route registration functions (which are defined in their respective .cpp files).
  *
  * This helps to reduce code duplication in the .cpp files, as they can all just `#include "Common_Route.hpp"` to get access to everything they need.
@@ -17,23 +17,49 @@
 #include "Classroom.hpp"
 #include "Quiz.hpp"
 #include "QuizAttempt.hpp"
+#include "EpochReclaim.hpp"
 
 using Session=crow::SessionMiddleware<crow::InMemoryStore>;
 
+/*
+ * Runs every request inside one epoch read section (see `EpochReclaim.hpp`). A record erased by another request is only destroyed
+ * once every request that might have looked it up has finished (see `EntityTable::erase`), so a handler can use the record pointers
+ * it found until it returns. Handlers must produce their response on the thread that runs them, as all of ours do.
+ */
+struct ReadSection {
+    struct context {};
+
+    void before_handle(crow::request&, crow::response&, context&){
+        epoch_domain::instance().enter();
+    }
+
+    void after_handle(crow::request&, crow::response&, context&){
+        epoch_domain::instance().exit();
+    }
+};
+
+using App=crow::App<crow::CookieParser,Session,ReadSection>;
+
 // Registers all routes related to classrooms (create, join, view)
-void registerClassroomRoutes(crow::App<crow::CookieParser,Session>& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table);
+void registerClassroomRoutes(App& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table);
 
 // Registers all routes related to quizzes (create, view)
-void registerQuizRoutes(crow::App<crow::CookieParser,Session>& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table);
+void registerQuizRoutes(App& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table);
 
 // Registers all routes related to attempting a quiz (start, submit, leaderboard)
-void registerQuizAttemptRoutes(crow::App<crow::CookieParser,Session>& app, quiz_hashTable& quiz_table, quiz_result_hashTable& results_table
+void registerQuizAttemptRoutes(App& app, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table, quiz_result_hashTable& results_table
 );
 
 // Registers all routes specific to students (dashboard, etc.)
-void registerStudentsRoutes(crow::App<crow::CookieParser,Session>& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table);
+void registerStudentsRoutes(App& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table);
+
+// Registers the routes that delete quizzes, classrooms and accounts, and clean up every reference to them
+void registerRemovalRoutes(App& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table, quiz_result_hashTable& results_table);
 
 // Registers all routes specific to teachers (dashboard, etc.)
-void registerTeachersRoutes(crow::App<crow::CookieParser,Session>& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table);
+void registerTeachersRoutes(App& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table);
+
+// Registers the admin-only routes (memory report)
+void registerAdminRoutes(App& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table, quiz_result_hashTable& results_table);
 
 #endif
\ No newline at end of file
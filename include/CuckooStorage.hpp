@@ -0,0 +1,338 @@
+#ifndef CUCKOO_STORAGE_HPP
+#define CUCKOO_STORAGE_HPP
+
+/*
+ * Description: This header defines `cuckoo_storage`, a bucketized cuckoo hash table with the same interface as `chained_storage`.
+ * It backs the login path (the `emails` index and the student and teacher tables) when built with `EDUMAZE_CUCKOO_LOGIN`
+ * (see `login_storage` below).
+ *
+ * DSA Concepts:
+ * 1.  **Cuckoo Hashing:** Every key has exactly two candidate buckets, one from its hash and one from a second mix of the same hash.
+ * An item is always stored in one of the two, so a lookup reads at most two buckets, whatever the table size or the key set.
+ * There is no chain or probe sequence whose length could grow.
+ * 2.  **Displacement (Random Walk):** If both buckets are full, the insert evicts an item from one of them and moves it to its other
+ * bucket, which may evict another item, and so on. After `MAX_KICKS` moves without finding a free slot the table doubles and
+ * the insert is retried. All of this happens under the write lock, so readers never see an item in transit.
+ * 3.  **Bucketized Slots:** Each bucket holds `SLOTS` items next to their cached hashes, in one 64-byte cache line for pointer
+ * items. With four slots per bucket the table stays insertable up to well over 90% full; it grows at `MAX_LOAD_NUM / MAX_LOAD_DEN`.
+ * 4.  **Hash Tags:** The full 32-bit hash of every item is kept in its bucket. A lookup only calls `equals` on slots whose hash
+ * matches, and a relocation computes the item's other bucket from the stored hash without touching the key.
+ *
+ * Growth rehashes the whole array at once, as in `flat_storage`; the loaders' `reserve` calls keep this off the request path at
+ * startup, and afterwards only signups (inserts) can trigger it.
+ *
+ * Thread safety: a displacement chain touches arbitrary buckets, so the array is guarded by one reader-writer lock. Lookups run in
+ * parallel; writes are serialised. The same callback rule as the other storages applies: callbacks must not lock a record or call
+ * back into the storage.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <initializer_list>
+#include <mutex>
+#include <shared_mutex>
+#include "Prefetch.hpp"
+
+template<typename T>
+class cuckoo_storage {
+    static constexpr size_t SLOTS = 4;          // Items per bucket
+    static constexpr size_t MIN_BUCKETS = 16;
+    // Grow once the table is 90% full
+    static constexpr size_t MAX_LOAD_NUM = 9;
+    static constexpr size_t MAX_LOAD_DEN = 10;
+    // Displacements tried before an insert gives up and doubles the table
+    static constexpr size_t MAX_KICKS = 256;
+
+    struct alignas(64) bucket {
+        uint32_t hashes[SLOTS];
+        uint8_t used=0;     // Bit `s` is set when slot `s` holds an item
+        T items[SLOTS];
+    };
+
+    bucket* buckets;
+    size_t bucket_count;    // Always a power of two
+    size_t count=0;
+    uint32_t kick_state=0x9E3779B9u;    // xorshift state for choosing eviction victims (guarded by the write lock)
+    mutable std::shared_mutex table_lock;
+
+    static size_t round_up_pow2(size_t n){
+        size_t p=MIN_BUCKETS;
+        while(p<n) p<<=1;
+        return p;
+    }
+
+    // Second, independent bucket choice: the hash passed through a MurmurHash3-style finaliser
+    static uint32_t alt_hash(uint32_t hash){
+        hash^=hash>>16;
+        hash*=0x85ebca6bu;
+        hash^=hash>>13;
+        hash*=0xc2b2ae35u;
+        hash^=hash>>16;
+        return hash;
+    }
+
+    size_t primary(uint32_t hash) const { return hash&(bucket_count-1); }
+    size_t secondary(uint32_t hash) const { return alt_hash(hash)&(bucket_count-1); }
+
+    uint32_t next_random(){
+        kick_state^=kick_state<<13;
+        kick_state^=kick_state>>17;
+        kick_state^=kick_state<<5;
+        return kick_state;
+    }
+
+    // Puts the item into a free slot of bucket `b`, if it has one
+    bool try_put(size_t b, uint32_t hash, const T& item){
+        bucket& target=buckets[b];
+        for(size_t s=0;s<SLOTS;s++){
+            if(!(target.used&(1u<<s))){
+                target.hashes[s]=hash;
+                target.items[s]=item;
+                target.used|=static_cast<uint8_t>(1u<<s);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*
+     * Stores an item in one of its two buckets, displacing others if needed.
+     * Returns false after `MAX_KICKS` displacements; `hash` and `item` then hold the item left without a slot
+     * (not necessarily the one passed in), which the caller must place after growing.
+     */
+    bool place(uint32_t& hash, T& item){
+        size_t from=primary(hash);
+        for(size_t kick=0;kick<MAX_KICKS;kick++){
+            size_t b1=primary(hash);
+            size_t b2=secondary(hash);
+            if(try_put(b1, hash, item) || try_put(b2, hash, item)) return true;
+
+            // Both full: evict a random item from the bucket this item did not just come from
+            size_t b=(b1==from) ? b2 : b1;
+            size_t s=next_random()%SLOTS;
+            bucket& victim=buckets[b];
+            uint32_t victim_hash=victim.hashes[s];
+            T victim_item=victim.items[s];
+            victim.hashes[s]=hash;
+            victim.items[s]=item;
+            hash=victim_hash;
+            item=victim_item;
+            from=b;
+        }
+        return false;
+    }
+
+    // Moves every item into a new array of at least `new_count` buckets, doubling again if some item cannot be placed
+    void rehash(size_t new_count){
+        bucket* old_buckets=buckets;
+        size_t old_count=bucket_count;
+        for(;;new_count*=2){
+            buckets=new bucket[new_count];
+            bucket_count=new_count;
+            bool placed_all=true;
+            for(size_t b=0;b<old_count && placed_all;b++){
+                for(size_t s=0;s<SLOTS;s++){
+                    if(!(old_buckets[b].used&(1u<<s))) continue;
+                    uint32_t hash=old_buckets[b].hashes[s];
+                    T item=old_buckets[b].items[s];
+                    if(!place(hash, item)){
+                        placed_all=false;
+                        break;
+                    }
+                }
+            }
+            if(placed_all) break;
+            delete[] buckets;
+        }
+        delete[] old_buckets;
+    }
+
+    template<typename Equals>
+    bool match_in(const bucket& candidate, uint32_t hash, Equals& equals, T& out) const {
+        for(size_t s=0;s<SLOTS;s++){
+            if((candidate.used&(1u<<s)) && candidate.hashes[s]==hash && equals(candidate.items[s])){
+                out=candidate.items[s];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Grows the table if needed and places the item. Caller holds table_lock exclusively.
+    void insert_locked(uint32_t hash, const T& item){
+        if((count+1)*MAX_LOAD_DEN > bucket_count*SLOTS*MAX_LOAD_NUM){
+            rehash(bucket_count*2);
+        }
+        uint32_t homeless_hash=hash;
+        T homeless=item;
+        while(!place(homeless_hash, homeless)){
+            rehash(bucket_count*2);
+        }
+        count++;
+    }
+
+public:
+    // `initial_buckets` is the expected number of items, as for the other storages
+    explicit cuckoo_storage(size_t initial_buckets):
+    bucket_count(round_up_pow2(initial_buckets/SLOTS+1)){
+        buckets=new bucket[bucket_count];
+    }
+
+    cuckoo_storage(const cuckoo_storage&) = delete;
+    cuckoo_storage& operator=(const cuckoo_storage&) = delete;
+
+    // Frees the array only. The items themselves are owned by the table using this storage.
+    ~cuckoo_storage(){
+        delete[] buckets;
+    }
+
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> guard(table_lock);
+        return count;
+    }
+
+    // Bytes of the bucket array. O(1).
+    size_t memory_bytes() const {
+        std::shared_lock<std::shared_mutex> guard(table_lock);
+        return bucket_count*sizeof(bucket);
+    }
+
+    // Presizes the table so `expected` items fit without growing
+    void reserve(size_t expected){
+        std::unique_lock<std::shared_mutex> guard(table_lock);
+        size_t needed=round_up_pow2(expected*MAX_LOAD_DEN/(MAX_LOAD_NUM*SLOTS)+1);
+        if(needed>bucket_count){
+            rehash(needed);
+        }
+    }
+
+    /*
+     * Inserts an item into one of its two buckets.
+     * Time Complexity: O(1) amortised. A displacement chain is at most `MAX_KICKS` long; a failed one doubles the table.
+     */
+    void insert(uint32_t hash, const T& item){
+        std::unique_lock<std::shared_mutex> guard(table_lock);
+        insert_locked(hash, item);
+    }
+
+    /*
+     * Inserts `item` unless an item for which `equals(item)` is true is already stored, in which case that one is copied into
+     * `existing` and false is returned. The check and the insert happen under one exclusive lock, so of two concurrent calls for
+     * the same key exactly one inserts.
+     * Time Complexity: O(1) amortised; the check reads the same two buckets as `find`.
+     */
+    template<typename Equals>
+    bool insert_if_absent(uint32_t hash, Equals equals, const T& item, T& existing){
+        std::unique_lock<std::shared_mutex> guard(table_lock);
+        size_t b1=primary(hash);
+        size_t b2=secondary(hash);
+        if(match_in(buckets[b1], hash, equals, existing) || (b2!=b1 && match_in(buckets[b2], hash, equals, existing))){
+            return false;
+        }
+        insert_locked(hash, item);
+        return true;
+    }
+
+    /*
+     * Looks for the item for which `equals(item)` is true and copies it into `out`. Returns false if there is none.
+     * Time Complexity: O(1) worst case: at most two buckets (2 * SLOTS hash compares) are examined.
+     */
+    template<typename Equals>
+    bool find(uint32_t hash, Equals equals, T& out){
+        std::shared_lock<std::shared_mutex> guard(table_lock);
+        size_t b1=primary(hash);
+        size_t b2=secondary(hash);
+        return match_in(buckets[b1], hash, equals, out) || (b2!=b1 && match_in(buckets[b2], hash, equals, out));
+    }
+
+    /*
+     * Looks up `n` keys at once: `hashes[i]` is the hash of key `i` and `equals(i, item)` tells whether `item` is key `i`'s.
+     * `out[i]` receives the match, and is left untouched when there is none. Both buckets, then the matching records, of later
+     * keys are prefetched while earlier ones are resolved (see `Prefetch.hpp`); the lock is taken once for the batch.
+     * Time Complexity: O(n).
+     */
+    template<typename Equals>
+    void find_many(const uint32_t* hashes, size_t n, Equals equals, T* out){
+        std::shared_lock<std::shared_mutex> guard(table_lock);
+        auto prefetch_matches=[this](size_t b, uint32_t hash){
+            for(size_t s=0;s<SLOTS;s++){
+                if((buckets[b].used&(1u<<s)) && buckets[b].hashes[s]==hash) prefetch_item(buckets[b].items[s]);
+            }
+        };
+        batch_pipeline(n, [&](size_t i){
+            prefetch_line(&buckets[primary(hashes[i])]);
+            prefetch_line(&buckets[secondary(hashes[i])]);
+        }, [&](size_t i){
+            prefetch_matches(primary(hashes[i]), hashes[i]);
+            prefetch_matches(secondary(hashes[i]), hashes[i]);
+        }, [&](size_t i){
+            auto key_equals=[&equals, i](const T& item){ return equals(i, item); };
+            size_t b1=primary(hashes[i]);
+            size_t b2=secondary(hashes[i]);
+            if(!match_in(buckets[b1], hashes[i], key_equals, out[i]) && b2!=b1) match_in(buckets[b2], hashes[i], key_equals, out[i]);
+        });
+    }
+
+    /*
+     * Removes the item for which `equals(item)` is true and copies it into `out`. Returns false if there is none.
+     * Time Complexity: O(1) worst case: the same two buckets as `find`.
+     */
+    template<typename Equals>
+    bool erase(uint32_t hash, Equals equals, T& out){
+        std::unique_lock<std::shared_mutex> guard(table_lock);
+        for(size_t b:{primary(hash), secondary(hash)}){
+            bucket& candidate=buckets[b];
+            for(size_t s=0;s<SLOTS;s++){
+                if((candidate.used&(1u<<s)) && candidate.hashes[s]==hash && equals(candidate.items[s])){
+                    out=candidate.items[s];
+                    candidate.used&=static_cast<uint8_t>(~(1u<<s));
+                    count--;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Copies the first stored item for which `matches(item)` is true into `out`, scanning the whole table. O(N).
+    template<typename Predicate>
+    bool find_if(Predicate matches, T& out){
+        std::shared_lock<std::shared_mutex> guard(table_lock);
+        for(size_t b=0;b<bucket_count;b++){
+            for(size_t s=0;s<SLOTS;s++){
+                if((buckets[b].used&(1u<<s)) && matches(buckets[b].items[s])){
+                    out=buckets[b].items[s];
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Calls `visit(item)` for every stored item, on a consistent snapshot.
+    template<typename Visitor>
+    void for_each(Visitor visit){
+        std::shared_lock<std::shared_mutex> guard(table_lock);
+        for(size_t b=0;b<bucket_count;b++){
+            for(size_t s=0;s<SLOTS;s++){
+                if(buckets[b].used&(1u<<s)) visit(buckets[b].items[s]);
+            }
+        }
+    }
+};
+
+/*
+ * `login_storage` backs the tables `/login_post` reads: the `emails` index and the student and teacher tables.
+ * Building with `EDUMAZE_CUCKOO_LOGIN` makes them `cuckoo_storage`, so each login lookup reads at most two buckets;
+ * otherwise they use `table_storage` like every other table.
+ */
+#include "HashStorage.hpp"
+#ifdef EDUMAZE_CUCKOO_LOGIN
+template<typename T>
+using login_storage = cuckoo_storage<T>;
+#else
+template<typename T>
+using login_storage = table_storage<T>;
+#endif
+
+#endif
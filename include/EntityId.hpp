@@ -0,0 +1,115 @@
+#ifndef ENTITY_ID_HPP
+#define ENTITY_ID_HPP
+
+/*
+ * Description: This header defines `entity_id`, the compact key of the classroom, quiz and result tables.
+ * Class codes, quiz IDs and result IDs are always six characters from `0-9A-Z`. Read as a base-36 number that is at most
+ * 36^6 - 1 = 2,176,782,335, which fits in 31 bits, so the ID is stored as one `uint32_t` instead of a heap `std::string`.
+ *
+ * DSA Concepts:
+ * 1.  **Base-36 Encoding:** `from_string` turns "PSHVJ9" into an integer with six multiply-adds; `to_string` turns it back with six
+ * divisions. The text form only exists at the edges (URLs, HTML, JSON files).
+ * 2.  **Compile-time Lookup Tables:** The character-to-digit table (`base36::DECODE`) and the digit-to-character table
+ * (`base36::DIGITS`) are `constexpr`, so decoding a character is one array load and nothing is built at startup.
+ * 3.  **Integer Hashing:** `hash()` passes the 32 bits through the shared `key_hash` policy (see `KeyHash.hpp`). A lookup is one mix
+ * and one integer compare per candidate, where FNV-1a needed one multiply per character and a string compare.
+ * 4.  **Trivially Copyable Value Type:** An `entity_id` is one plain `uint32_t` with no constructor, copy or destructor logic of its
+ * own, so a list of IDs (`quizIds`, `classroomIds`) is 4 bytes per element and is copied, grown and moved with one `memmove`.
+ * The static assertions below keep it that way.
+ */
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "json.hpp"
+#include "KeyHash.hpp"
+
+namespace base36 {
+    constexpr size_t ID_LENGTH = 6;
+    constexpr uint32_t ID_SPACE = 36u*36u*36u*36u*36u*36u;  // Number of distinct IDs
+    constexpr char DIGITS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    constexpr int8_t INVALID_DIGIT = -1;
+
+    // Character -> digit value, or INVALID_DIGIT for anything outside 0-9A-Z (IDs are upper case only, as generated)
+    constexpr std::array<int8_t, 256> make_decode_table(){
+        std::array<int8_t, 256> table{};
+        for(auto& entry:table) entry=INVALID_DIGIT;
+        for(int8_t digit=0;digit<36;digit++){
+            table[static_cast<unsigned char>(DIGITS[digit])]=digit;
+        }
+        return table;
+    }
+
+    constexpr std::array<int8_t, 256> DECODE = make_decode_table();
+}
+
+struct entity_id {
+    static constexpr uint32_t INVALID = UINT32_MAX;     // Value of an ID that failed to parse; never matches a stored record
+
+    uint32_t value=INVALID;
+
+    constexpr entity_id() = default;
+    constexpr explicit entity_id(uint32_t v): value(v){}
+
+    constexpr bool valid() const { return value<base36::ID_SPACE; }
+
+    /*
+     * Parses a six-character code. Anything else (wrong length, lower case, punctuation) gives an invalid ID.
+     * Time Complexity: O(1), six table lookups.
+     */
+    static constexpr entity_id from_string(std::string_view text){
+        if(text.size()!=base36::ID_LENGTH) return entity_id();
+        uint32_t v=0;
+        for(char c:text){
+            int8_t digit=base36::DECODE[static_cast<unsigned char>(c)];
+            if(digit==base36::INVALID_DIGIT) return entity_id();
+            v=v*36+static_cast<uint32_t>(digit);
+        }
+        return entity_id(v);
+    }
+
+    // The six-character code, or "" for an invalid ID
+    std::string to_string() const {
+        if(!valid()) return std::string();
+        std::string text(base36::ID_LENGTH, '0');
+        uint32_t v=value;
+        for(size_t i=base36::ID_LENGTH;i-->0;){
+            text[i]=base36::DIGITS[v%36];
+            v/=36;
+        }
+        return text;
+    }
+
+    // A uniformly random valid ID (the integer form of the old six random characters)
+    template<typename Generator>
+    static entity_id random(Generator& generator){
+        std::uniform_int_distribution<uint32_t> distribution(0, base36::ID_SPACE-1);
+        return entity_id(distribution(generator));
+    }
+
+    // Spreads every input bit over the whole word, so `hash & (buckets - 1)` is well distributed
+    uint32_t hash() const { return key_hash::hash(value); }
+
+    constexpr bool operator==(const entity_id& other) const { return value==other.value; }
+    constexpr bool operator!=(const entity_id& other) const { return value!=other.value; }
+};
+
+static_assert(entity_id::from_string("000000").value==0, "base36 decode");
+static_assert(entity_id::from_string("ZZZZZZ").value==base36::ID_SPACE-1, "base36 decode");
+static_assert(!entity_id::from_string("abcdef").valid(), "IDs are upper case");
+static_assert(sizeof(entity_id)==sizeof(uint32_t), "an entity_id is one 4-byte word");
+static_assert(std::is_trivially_copyable_v<entity_id>, "lists of IDs must copy with memmove");
+
+// IDs are stored in the JSON files as their six-character text, so the file format is unchanged
+inline void to_json(nlohmann::json& j, const entity_id& id){
+    j=id.to_string();
+}
+
+inline void from_json(const nlohmann::json& j, entity_id& id){
+    id=j.is_string() ? entity_id::from_string(j.get_ref<const std::string&>()) : entity_id();
+}
+
+#endif
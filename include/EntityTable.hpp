@@ -0,0 +1,347 @@
+#ifndef ENTITY_TABLE_HPP
+#define ENTITY_TABLE_HPP
+
+/*
+ * Description: This header defines `EntityTable`, the one hash table template behind all four tables of the project
+ * (`user_hashTable`, `classroom_hashTable`, `quiz_hashTable` and `quiz_result_hashTable`). Each of them holds one or two
+ * instantiations of it and only adds its own domain methods (ID generation, the email index, result scans).
+ *
+ * DSA Concepts:
+ * 1.  **Policy-based Design:** Everything that used to differ between the hand-written tables is a template parameter, fixed at
+ * compile time, so the compiler inlines each policy and the generic table costs nothing over the hand-written one:
+ *     - `HashPolicy` hashes a key (and any other probe type it accepts, such as the text of a username) and compares a probe
+ *       with a record's key. See `entity_id_hash` and `symbol_hash` below.
+ *     - `StoragePolicy` is the bucket layout: `chained_storage`, `flat_storage`, `rcu_storage`, `cuckoo_storage`,
+ *       `perfect_storage`, or the `table_storage` / `catalog_storage` / `login_storage` / `quiz_storage` build-time aliases.
+ *     - `PersistPolicy` loads the table when it is created and saves it on request: `json_file_persist<Format>` for the
+ *       JSON files under `Data/`, or `no_persist` for tables that live only in memory.
+ * 2.  **Heterogeneous Lookup:** `find` takes any probe the hash policy can hash and compare. The users table is keyed by
+ * `symbol_id` but can be searched with a `std::string_view` directly, without interning it first.
+ * 3.  **Batched Lookup:** `find_many` resolves a whole list of keys (a roster, a classroom's quizzes) in one pass, prefetching
+ * ahead (see `Prefetch.hpp`).
+ * 4.  **Slab Allocation:** Records are created in the table's `slab_pool` (see `SlabPool.hpp`) and freed in bulk.
+ * 5.  **Atomic Check-and-insert:** `insert_if_absent`, `find_or_insert` and `emplace_unique` look for the key and insert under the
+ * same storage lock, so a key can never be added twice, even by concurrent requests.
+ * 6.  **Deferred Reclamation:** `erase` unlinks a record at once but destroys it through `epoch_domain` (see `EpochReclaim.hpp`),
+ * only after every read section that could have found it has ended. Each request runs in one such section (see `Common_Route.hpp`),
+ * so a handler can keep using the record pointers it looked up even if another request erases them meanwhile.
+ *
+ * A record type `V` tells the table its key through a free function `entity_key(const V&)`, declared next to the struct.
+ * The key must never change once the record is indexed. Tables whose `memory()` is reported also need
+ * `entity_memory(const V&, memory_usage&)`, which adds the heap bytes the record owns (see `MemoryUsage.hpp`).
+ *
+ * Records are constructed in place from the arguments of `emplace` and its variants, which are forwarded untouched, so strings and
+ * vectors passed as rvalues are moved into the record rather than copied.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "json.hpp"
+#include "HashStorage.hpp"
+#include "RcuStorage.hpp"
+#include "SlabPool.hpp"
+#include "EpochReclaim.hpp"
+#include "KeyHash.hpp"
+#include "EntityId.hpp"
+#include "SymbolTable.hpp"
+#include "JsonFile.hpp"
+#include "MemoryUsage.hpp"
+
+// Hash policy for tables keyed by an `entity_id` (classrooms, quizzes, results)
+struct entity_id_hash {
+    static uint32_t hash(entity_id id){ return id.hash(); }
+    static bool equal(entity_id key, entity_id probe){ return key==probe; }
+};
+
+// Hash policy for tables keyed by an interned username. The text of the name hashes to the same value as its id,
+// so a table can be searched with either: ids compare as integers, text compares against the interned string.
+struct symbol_hash {
+    static uint32_t hash(symbol_id id){ return key_hash::hash(id.view()); }
+    static uint32_t hash(std::string_view name){ return key_hash::hash(name); }
+    static bool equal(symbol_id key, symbol_id probe){ return key==probe; }
+    static bool equal(symbol_id key, std::string_view probe){ return key.view()==probe; }
+};
+
+// Persistence policy for a table that is never written to disk
+struct no_persist {
+    template<typename Table> static void load(Table&){}
+    template<typename Table> static void save(Table&){}
+};
+
+/*
+ * Base of every `json_file_persist` format, with the optional hooks a format may hide with its own static functions:
+ *   - `before_load()` / `after_load()`: run around reading the file, e.g. to load a side file the records refer into;
+ *   - `before_write(records)`: runs with the snapshot of records about to be written, before the file itself is replaced.
+ */
+struct json_file_format {
+    static void before_load(){}
+    static void after_load(){}
+    template<typename Record> static void before_write(const std::vector<Record*>&){}
+};
+
+/*
+ * Persistence policy for a table kept in a JSON array file. `Format` derives from `json_file_format` and supplies:
+ *   - `static constexpr const char* path`: the file, e.g. "Data/classrooms.json";
+ *   - `static constexpr bool required`: whether a missing file is an error (otherwise an empty one is created);
+ *   - `static void read(Table&, njson&)`: adds the record of one array element, normally with `table.emplace`. The parsed file
+ *     is discarded after loading, so `read` may move strings and arrays out of the element (see `takeText`) instead of copying them.
+ * Records are written with their `to_json`.
+ */
+template<typename Format>
+struct json_file_persist {
+    template<typename Table>
+    static void load(Table& table){
+        Format::before_load();
+        read_file(table);
+        Format::after_load();
+    }
+
+    template<typename Table>
+    static void read_file(Table& table){
+        std::ifstream file(Format::path);
+        if(!file.is_open()){
+            if(Format::required){
+                throw std::runtime_error(std::string("Could not open ")+Format::path);
+            }
+            // If file doesn't exist, create an empty one
+            std::ofstream(Format::path)<<"[]";
+            return;
+        }
+        nlohmann::json data;
+        file>>data;
+        // Presize from the record count so loading never triggers a resize
+        table.reserve(data.size());
+        for(auto& element:data){
+            Format::read(table, element);
+        }
+    }
+
+    // The record pointers are collected first and serialised after the storage locks are released, because a record's
+    // `to_json` may take the record's own lock.
+    template<typename Table>
+    static void save(Table& table){
+        // Records erased meanwhile stay valid until the section ends
+        epoch_guard read_section;
+        std::vector<typename Table::value_type*> records;
+        table.for_each([&records](typename Table::value_type* record){ records.push_back(record); });
+        Format::before_write(records);
+        nlohmann::json array=nlohmann::json::array();
+        for(auto* record:records) array.push_back(*record);
+        saveJsonFile(Format::path, array);
+    }
+};
+
+template<typename Key, typename Value, typename HashPolicy, template<typename> class StoragePolicy, typename PersistPolicy>
+class EntityTable {
+    StoragePolicy<Value*> entries;
+    slab_pool<Value> records;   // Owns every record
+    std::mutex file_mutex;  // Serialises saves
+
+    // Indexes a freshly created record under `hash` unless a record matching `probe` is already there, in which case the new one
+    // is destroyed (nothing else has seen it) and the existing one returned
+    template<typename Probe>
+    std::pair<Value*, bool> insert_unique(uint32_t hash, const Probe& probe, Value* record){
+        Value* existing=nullptr;
+        if(entries.insert_if_absent(hash, [&probe](Value* other){ return HashPolicy::equal(entity_key(*other), probe); }, record, existing)){
+            return {record, true};
+        }
+        records.destroy(record);
+        return {existing, false};
+    }
+
+    // Gives an erased record back to the pool of `table`; run by `epoch_domain` once no reader can still hold it
+    static void release_record(void* record, void* table){
+        static_cast<EntityTable*>(table)->records.destroy(static_cast<Value*>(record));
+    }
+
+public:
+    using key_type = Key;
+    using value_type = Value;
+
+    // The bucket count is only a floor; loading presizes from the file and the storage grows on demand
+    explicit EntityTable(size_t initial_buckets=50): entries(initial_buckets){
+        PersistPolicy::load(*this);
+    }
+
+    EntityTable(const EntityTable&) = delete;
+    EntityTable& operator=(const EntityTable&) = delete;
+
+    // Destructs the records, including erased ones still waiting for readers; the pool then frees the slabs in bulk.
+    // Saving is up to the owner.
+    ~EntityTable(){
+        epoch_domain::instance().release_owned(this);
+        entries.for_each([this](Value* record){ records.destroy(record); });
+    }
+
+    size_t size() const { return entries.size(); }
+
+    void reserve(size_t expected){
+        entries.reserve(expected);
+        records.reserve(expected);
+    }
+
+    /*
+     * Creates a record from `args` and indexes it under `entity_key(record)`.
+     * Time Complexity: O(1) average.
+     */
+    template<typename... Args>
+    Value* emplace(Args&&... args){
+        Value* record=records.create(std::forward<Args>(args)...);
+        entries.insert(HashPolicy::hash(entity_key(*record)), record);
+        return record;
+    }
+
+    /*
+     * Creates a record from `args` and indexes it only if no record with the same key exists. The check and the insert are one
+     * storage operation, so of two concurrent calls with the same key exactly one succeeds. Returns the record now holding the
+     * key and whether it is the new one. A new record that loses is destroyed without ever having been visible.
+     * Time Complexity: O(1) average; the key is hashed once.
+     */
+    template<typename... Args>
+    std::pair<Value*, bool> insert_if_absent(Args&&... args){
+        Value* record=records.create(std::forward<Args>(args)...);
+        Key key=entity_key(*record);
+        return insert_unique(HashPolicy::hash(key), key, record);
+    }
+
+    /*
+     * Creates a record from `args` and indexes it under a key no other record has. While its key is taken, `rekey(record)` gives
+     * the new record, which nothing else has seen yet, another key (e.g. a fresh random ID) and the insert is retried. The record
+     * is built only once, so the caller can move its data in even though the first key may collide.
+     * Time Complexity: O(1) average per attempt.
+     */
+    template<typename Rekey, typename... Args>
+    Value* emplace_unique(Rekey rekey, Args&&... args){
+        Value* record=records.create(std::forward<Args>(args)...);
+        try {
+            for(;;){
+                Key key=entity_key(*record);
+                Value* existing=nullptr;
+                if(entries.insert_if_absent(HashPolicy::hash(key), [&key](Value* other){ return HashPolicy::equal(entity_key(*other), key); }, record, existing)){
+                    return record;
+                }
+                rekey(*record);
+            }
+        }
+        catch(...){
+            records.destroy(record);
+            throw;
+        }
+    }
+
+    /*
+     * Returns the record whose key matches `probe`, creating it from `args` if there is none. `args` must build a record whose
+     * key matches `probe`. The probe is hashed once for both the lookup and the insert; like `insert_if_absent`, two concurrent
+     * calls for the same key end up with the same record. Returns whether the record was created.
+     * Time Complexity: O(1) average.
+     */
+    template<typename Probe, typename... Args>
+    std::pair<Value*, bool> find_or_insert(const Probe& probe, Args&&... args){
+        uint32_t hash=HashPolicy::hash(probe);
+        Value* found=nullptr;
+        if(entries.find(hash, [&probe](Value* record){ return HashPolicy::equal(entity_key(*record), probe); }, found)){
+            return {found, false};
+        }
+        return insert_unique(hash, probe, records.create(std::forward<Args>(args)...));
+    }
+
+    /*
+     * Finds the record whose key matches `probe` (a `Key` or any other type `HashPolicy` accepts).
+     * Time Complexity: O(1) average.
+     */
+    template<typename Probe>
+    Value* find(const Probe& probe){
+        Value* found=nullptr;
+        entries.find(HashPolicy::hash(probe), [&probe](Value* record){ return HashPolicy::equal(entity_key(*record), probe); }, found);
+        return found;
+    }
+
+    /*
+     * Finds the records of a batch of probes: entry `i` of the result is the record whose key matches `probes[i]`, or nullptr.
+     * `probes` is any list with `size()` and `operator[]`, e.g. a `std::vector` or an `id_list::view`.
+     * Every probe is hashed first, then the storage's `find_many` resolves them with the buckets and records of later probes
+     * prefetched, so the cache misses of different probes overlap instead of running one after another.
+     * Time Complexity: O(n) average.
+     */
+    template<typename Probes>
+    std::vector<Value*> find_many(const Probes& probes){
+        // Scratch space reused by every batch on this thread
+        thread_local std::vector<uint32_t> hashes;
+        hashes.resize(probes.size());
+        for(size_t i=0;i<probes.size();i++) hashes[i]=HashPolicy::hash(probes[i]);
+        std::vector<Value*> found(probes.size(), nullptr);
+        entries.find_many(hashes.data(), probes.size(), [&probes](size_t i, Value* record){
+            return HashPolicy::equal(entity_key(*record), probes[i]);
+        }, found.data());
+        return found;
+    }
+
+    /*
+     * Removes the record whose key matches `probe`. Returns false if there is none, e.g. when a concurrent erase got there first,
+     * so of two requests erasing the same record exactly one sees true.
+     * The record is retired rather than destroyed: a caller inside a read section can still use a pointer to it until the section
+     * ends, which is how the owners read its cross-references after erasing it.
+     * Time Complexity: O(1) average (O(n) with `perfect_storage`, which rebuilds).
+     */
+    template<typename Probe>
+    bool erase(const Probe& probe){
+        Value* removed=nullptr;
+        if(!entries.erase(HashPolicy::hash(probe), [&probe](Value* record){ return HashPolicy::equal(entity_key(*record), probe); }, removed)){
+            return false;
+        }
+        epoch_domain::instance().retire(removed, &release_record, this);
+        return true;
+    }
+
+    /*
+     * Finds any record satisfying `matches`, for searches not by key.
+     * Time Complexity: O(N).
+     */
+    template<typename Predicate>
+    Value* find_if(Predicate matches){
+        Value* found=nullptr;
+        entries.find_if(matches, found);
+        return found;
+    }
+
+    // Visits every record. The same locking rule as the storages applies: `visit` must not lock a record.
+    template<typename Visitor>
+    void for_each(Visitor visit){
+        entries.for_each(visit);
+    }
+
+    /*
+     * Reports the bytes the table holds (see `MemoryUsage.hpp`): the storage's index, the record slabs, and the strings and arrays
+     * each record owns, added by `entity_memory(record, usage)`. As in `save`, the records are collected first and accounted after
+     * the storage locks are released, because `entity_memory` may take the record's own lock.
+     * Time Complexity: O(n).
+     */
+    memory_usage memory(){
+        // Records erased meanwhile stay valid until the section ends
+        epoch_guard read_section;
+        std::vector<Value*> all;
+        all.reserve(size());
+        entries.for_each([&all](Value* record){ all.push_back(record); });
+        memory_usage usage;
+        usage.entities=all.size();
+        usage.nodes=entries.memory_bytes();
+        usage.records=records.bytes();
+        for(Value* record:all) entity_memory(*record, usage);
+        return usage;
+    }
+
+    // Writes the table out through `PersistPolicy`. Concurrent saves are serialised so an older snapshot never overwrites a newer one.
+    void save(){
+        std::lock_guard<std::mutex> file_guard(file_mutex);
+        PersistPolicy::save(*this);
+    }
+};
+
+#endif
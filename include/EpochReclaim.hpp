@@ -0,0 +1,171 @@
+#ifndef EPOCH_RECLAIM_HPP
+#define EPOCH_RECLAIM_HPP
+
+/*
+ * Description: Epoch-based reclamation (EBR) for the lock-free read paths of the tables.
+ *
+ * A lock-free reader may still be walking memory that a writer has just unlinked, so the writer cannot free it right away.
+ * Instead it `retire`s the memory, and it is freed once every reader that could have seen it has finished.
+ *
+ * DSA Concepts:
+ * 1.  **Global Epoch:** A counter bumped on every retirement. Memory retired at epoch `e` was unlinked before the bump, so a reader
+ * that starts afterwards (and reads an epoch greater than `e`) can no longer reach it.
+ * 2.  **Reader Slots:** Every thread owns one cache-line-sized slot and publishes the epoch it entered at. Entering and leaving a read
+ * section only writes to the thread's own slot, so readers never write to a cache line shared with another thread.
+ * 3.  **Reclamation:** A retired item is freed once every active slot shows an epoch greater than the item's epoch.
+ *
+ * Usage: readers wrap their traversal in an `epoch_guard`; writers call `epoch_domain::instance().retire(ptr)`. Memory that is
+ * not released with `delete` (a record of a table's `slab_pool`) is retired with its own release function and owner instead.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class epoch_domain {
+    static constexpr uint64_t IDLE = UINT64_MAX;    // Slot epoch of a thread outside any read section
+
+    struct alignas(64) reader_slot {
+        std::atomic<uint64_t> epoch{IDLE};
+        std::atomic<bool> in_use{true};
+        reader_slot* next=nullptr;  // Slots form a push-only linked list and are reused, never freed
+        unsigned depth=0;   // Nesting depth of read sections; only touched by the owning thread
+    };
+
+    struct retired_item {
+        void* ptr;
+        void (*release)(void* ptr, void* owner);
+        void* owner;    // Passed to `release`; nullptr for plain `delete`
+        uint64_t epoch;
+    };
+
+    std::atomic<uint64_t> global_epoch{1};
+    std::atomic<reader_slot*> slots{nullptr};
+    std::mutex retire_mutex;
+    std::vector<retired_item> retired;
+
+    // Claims a free slot, or adds a new one to the list
+    reader_slot* acquire_slot(){
+        for(reader_slot* s=slots.load(std::memory_order_acquire); s; s=s->next){
+            bool expected=false;
+            if(!s->in_use.load(std::memory_order_relaxed) && s->in_use.compare_exchange_strong(expected, true)){
+                return s;
+            }
+        }
+        reader_slot* s=new reader_slot;
+        reader_slot* head=slots.load(std::memory_order_relaxed);
+        do{
+            s->next=head;
+        }while(!slots.compare_exchange_weak(head, s, std::memory_order_release, std::memory_order_relaxed));
+        return s;
+    }
+
+    // The calling thread's slot, claimed on first use and handed back when the thread exits
+    reader_slot* local_slot(){
+        struct slot_owner {
+            reader_slot* slot=nullptr;
+            ~slot_owner(){
+                if(slot) slot->in_use.store(false, std::memory_order_release);
+            }
+        };
+        thread_local slot_owner owner;
+        if(!owner.slot) owner.slot=acquire_slot();
+        return owner.slot;
+    }
+
+    // Frees every retired item no active reader can still see. Caller holds retire_mutex.
+    void reclaim(){
+        // Pairs with the fence in `enter`: a slot read here as idle belongs to a reader that will see the unlink
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t oldest=global_epoch.load();
+        for(reader_slot* s=slots.load(std::memory_order_acquire); s; s=s->next){
+            uint64_t e=s->epoch.load();
+            if(e<oldest) oldest=e;
+        }
+        size_t kept=0;
+        for(retired_item& item:retired){
+            if(item.epoch<oldest) item.release(item.ptr, item.owner);
+            else retired[kept++]=item;
+        }
+        retired.resize(kept);
+    }
+
+public:
+    static epoch_domain& instance(){
+        static epoch_domain domain;
+        return domain;
+    }
+
+    epoch_domain() = default;
+    epoch_domain(const epoch_domain&) = delete;
+    epoch_domain& operator=(const epoch_domain&) = delete;
+
+    // Runs at program exit, after the server has stopped: nothing can be reading any more
+    ~epoch_domain(){
+        for(retired_item& item:retired) item.release(item.ptr, item.owner);
+        reader_slot* s=slots.load();
+        while(s){
+            reader_slot* next=s->next;
+            delete s;
+            s=next;
+        }
+    }
+
+    void enter(){
+        reader_slot* s=local_slot();
+        if(s->depth++==0){
+            s->epoch.store(global_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+            // The published epoch must be visible before any shared pointer is read
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void exit(){
+        reader_slot* s=local_slot();
+        if(--s->depth==0){
+            s->epoch.store(IDLE, std::memory_order_release);
+        }
+    }
+
+    /*
+     * Hands an unlinked object to the domain; it is deleted once no reader can still hold it.
+     * Must be called after the object has been made unreachable for new readers.
+     */
+    template<typename P>
+    void retire(P* ptr){
+        retire(ptr, [](void* p, void*){ delete static_cast<P*>(p); }, nullptr);
+    }
+
+    // Same, for an object that `release(ptr, owner)` gives back, e.g. to the pool of the table that `owner` points at
+    void retire(void* ptr, void (*release)(void*, void*), void* owner){
+        std::lock_guard<std::mutex> guard(retire_mutex);
+        retired.push_back({ptr, release, owner, global_epoch.fetch_add(1)});
+        reclaim();
+    }
+
+    /*
+     * Releases every object still waiting that was retired with `owner`, without waiting for readers.
+     * For an owner that is being destroyed, when nothing can be reading its objects any more.
+     */
+    void release_owned(void* owner){
+        std::lock_guard<std::mutex> guard(retire_mutex);
+        size_t kept=0;
+        for(retired_item& item:retired){
+            if(item.owner==owner) item.release(item.ptr, item.owner);
+            else retired[kept++]=item;
+        }
+        retired.resize(kept);
+    }
+};
+
+// RAII read section: memory reachable when the guard is created stays valid until it is destroyed
+class epoch_guard {
+public:
+    epoch_guard(){ epoch_domain::instance().enter(); }
+    ~epoch_guard(){ epoch_domain::instance().exit(); }
+    epoch_guard(const epoch_guard&) = delete;
+    epoch_guard& operator=(const epoch_guard&) = delete;
+};
+
+#endif
@@ -0,0 +1,358 @@
+#ifndef FLAT_STORAGE_HPP
+#define FLAT_STORAGE_HPP
+
+/*
+ * Description: This header defines `flat_storage`, an open-addressing alternative to `chained_storage` with the same interface.
+ * It is selected for all tables by building with `EDUMAZE_FLAT_TABLES` (see `table_storage` in `HashStorage.hpp`).
+ *
+ * DSA Concepts:
+ * 1.  **Open Addressing:** Items are stored directly in one flat `slots` array instead of in separately allocated linked list nodes,
+ * so a lookup touches the control bytes and one slot instead of a bucket pointer, a node and the record.
+ * 2.  **Control Bytes (Swiss table):** A parallel `ctrl` byte array holds, for every slot, either `EMPTY` or the low 7 bits of the
+ * key's hash (`h2`). The remaining hash bits (`h1`) choose the first group to probe.
+ * 3.  **SIMD Group Probing:** Slots are probed one group at a time. A group is 16 control bytes compared in one SSE2 instruction,
+ * or 32 bytes with AVX2. The compare gives a bitmask of slots whose `h2` matches, and only those slots are checked against the key.
+ * 4.  **Triangular Probing:** If a group is full and holds no match, the next group is `i` groups further on the i-th step.
+ * With a power-of-two group count this visits every group exactly once.
+ * 5.  **Tombstones:** An erased slot is marked `DELETED` rather than `EMPTY` when other keys' probe sequences may pass through its
+ * group, so lookups keep probing past it; inserts reuse it. Tombstones count towards the load factor and are dropped by the next rehash.
+ *
+ * Unlike `chained_storage`, growth here rehashes the whole array at once (when it is 7/8 full); the loaders' `reserve` calls keep
+ * this off the request path at startup.
+ *
+ * Thread safety: a probe sequence crosses group boundaries, so buckets cannot be split into independent lock stripes as in
+ * `chained_storage`. The whole array is guarded by one reader-writer lock instead: lookups still run in parallel, writes are serialised.
+ * The same callback rule applies: callbacks must not lock a record or call back into the storage.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include "Prefetch.hpp"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace flat_ctrl {
+    constexpr int8_t EMPTY = -128;  // 0b10000000: top bit set marks a free slot; full slots hold h2 (0..127)
+    constexpr int8_t DELETED = -2;  // 0b11111110: a free slot that probe sequences must continue past
+
+#if defined(__AVX2__)
+    constexpr size_t GROUP_WIDTH = 32;
+
+    // Bitmask of the slots in the group whose control byte equals `h2`
+    inline uint32_t match(const int8_t* group, int8_t h2){
+        __m256i ctrl=_mm256_loadu_si256(reinterpret_cast<const __m256i*>(group));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(ctrl, _mm256_set1_epi8(h2))));
+    }
+
+    // Bitmask of the empty slots in the group
+    inline uint32_t match_empty(const int8_t* group){
+        return match(group, EMPTY);
+    }
+
+    // Bitmask of the free slots in the group, empty or deleted (the only bytes with the top bit set)
+    inline uint32_t match_free(const int8_t* group){
+        __m256i ctrl=_mm256_loadu_si256(reinterpret_cast<const __m256i*>(group));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(ctrl));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    constexpr size_t GROUP_WIDTH = 16;
+
+    inline uint32_t match(const int8_t* group, int8_t h2){
+        __m128i ctrl=_mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2))));
+    }
+
+    inline uint32_t match_empty(const int8_t* group){
+        return match(group, EMPTY);
+    }
+
+    inline uint32_t match_free(const int8_t* group){
+        __m128i ctrl=_mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+    }
+#else
+    // Portable fallback for targets without SSE2: the same bitmasks, one byte at a time
+    constexpr size_t GROUP_WIDTH = 16;
+
+    inline uint32_t match(const int8_t* group, int8_t h2){
+        uint32_t mask=0;
+        for(size_t i=0;i<GROUP_WIDTH;i++){
+            if(group[i]==h2) mask|=1u<<i;
+        }
+        return mask;
+    }
+
+    inline uint32_t match_empty(const int8_t* group){
+        return match(group, EMPTY);
+    }
+
+    inline uint32_t match_free(const int8_t* group){
+        uint32_t mask=0;
+        for(size_t i=0;i<GROUP_WIDTH;i++){
+            if(group[i]<0) mask|=1u<<i;
+        }
+        return mask;
+    }
+#endif
+
+    // Index of the lowest set bit of a non-zero mask
+    inline unsigned lowest_bit(uint32_t mask){
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+        unsigned i=0;
+        while(!(mask&1u)){ mask>>=1; i++; }
+        return i;
+#endif
+    }
+}
+
+template<typename T>
+class flat_storage {
+    struct slot {
+        T data{};
+        uint32_t hash=0;    // Full hash, kept so growing never has to hash the key again
+    };
+
+    static constexpr size_t GROUP_WIDTH = flat_ctrl::GROUP_WIDTH;
+    // Grow once more than 7 of every 8 slots are full
+    static constexpr size_t MAX_LOAD_NUM = 7;
+    static constexpr size_t MAX_LOAD_DEN = 8;
+
+    int8_t* ctrl;   // One control byte per slot
+    slot* slots;
+    size_t capacity;    // Number of slots, a power of two and a multiple of GROUP_WIDTH
+    size_t count=0;
+    size_t tombstones=0;    // Slots marked DELETED
+    mutable std::shared_mutex table_lock;  // Shared for lookups and scans, exclusive for inserts and growth
+
+    static size_t round_up_capacity(size_t n){
+        size_t p=GROUP_WIDTH;
+        while(p<n) p<<=1;
+        return p;
+    }
+
+    static int8_t h2(uint32_t hash){ return static_cast<int8_t>(hash&0x7F); }
+    static size_t h1(uint32_t hash){ return hash>>7; }
+
+    void allocate(size_t n){
+        capacity=n;
+        ctrl=new int8_t[capacity];
+        std::memset(ctrl, flat_ctrl::EMPTY, capacity);
+        slots=new slot[capacity];
+    }
+
+    // Places an item in the first free (empty or deleted) slot of its probe sequence. The caller guarantees there is room.
+    void place(uint32_t hash, const T& item){
+        size_t group_mask=capacity/GROUP_WIDTH-1;
+        size_t group=h1(hash)&group_mask;
+        for(size_t step=1;;step++){
+            uint32_t free_slots=flat_ctrl::match_free(ctrl+group*GROUP_WIDTH);
+            if(free_slots){
+                size_t i=group*GROUP_WIDTH+flat_ctrl::lowest_bit(free_slots);
+                if(ctrl[i]==flat_ctrl::DELETED) tombstones--;
+                ctrl[i]=h2(hash);
+                slots[i].data=item;
+                slots[i].hash=hash;
+                return;
+            }
+            group=(group+step)&group_mask;
+        }
+    }
+
+    // Grows the table if needed and places the item. Caller holds table_lock exclusively.
+    void insert_locked(uint32_t hash, const T& item){
+        if((count+tombstones+1)*MAX_LOAD_DEN > capacity*MAX_LOAD_NUM){
+            // Mostly tombstones: rehashing at the same size is enough to make room
+            rehash((count+1)*MAX_LOAD_DEN > capacity*MAX_LOAD_NUM/2 ? capacity*2 : capacity);
+        }
+        place(hash, item);
+        count++;
+    }
+
+    // Rebuilds the table with `new_capacity` slots
+    void rehash(size_t new_capacity){
+        int8_t* old_ctrl=ctrl;
+        slot* old_slots=slots;
+        size_t old_capacity=capacity;
+        allocate(new_capacity);
+        tombstones=0;
+        for(size_t i=0;i<old_capacity;i++){
+            if(old_ctrl[i]>=0) place(old_slots[i].hash, old_slots[i].data);
+        }
+        delete[] old_ctrl;
+        delete[] old_slots;
+    }
+
+    // Walks the probe sequence of `hash` until `equals` matches or an empty slot ends it, and returns the index of the match
+    // (or `capacity`). Caller holds table_lock.
+    template<typename Equals>
+    size_t locate(uint32_t hash, Equals& equals) const {
+        size_t group_mask=capacity/GROUP_WIDTH-1;
+        size_t group=h1(hash)&group_mask;
+        int8_t tag=h2(hash);
+        for(size_t step=1;step<=group_mask+1;step++){
+            const int8_t* group_ctrl=ctrl+group*GROUP_WIDTH;
+            for(uint32_t candidates=flat_ctrl::match(group_ctrl, tag); candidates; candidates&=candidates-1){
+                size_t i=group*GROUP_WIDTH+flat_ctrl::lowest_bit(candidates);
+                if(slots[i].hash==hash && equals(slots[i].data)) return i;
+            }
+            // An empty slot ends the probe sequence: the key would have been placed there
+            if(flat_ctrl::match_empty(group_ctrl)) return capacity;
+            group=(group+step)&group_mask;
+        }
+        return capacity;
+    }
+
+    template<typename Equals>
+    bool probe(uint32_t hash, Equals& equals, T& out) const {
+        size_t i=locate(hash, equals);
+        if(i==capacity) return false;
+        out=slots[i].data;
+        return true;
+    }
+
+public:
+    explicit flat_storage(size_t initial_buckets){
+        allocate(round_up_capacity(initial_buckets));
+    }
+
+    flat_storage(const flat_storage&) = delete;
+    flat_storage& operator=(const flat_storage&) = delete;
+
+    // Frees the arrays only. The items themselves are owned by the table using this storage.
+    ~flat_storage(){
+        delete[] ctrl;
+        delete[] slots;
+    }
+
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> guard(table_lock);
+        return count;
+    }
+
+    // Bytes of the control bytes and the slot array. O(1).
+    size_t memory_bytes() const {
+        std::shared_lock<std::shared_mutex> guard(table_lock);
+        return capacity*(sizeof(int8_t)+sizeof(slot));
+    }
+
+    // Presizes the table so `expected` items fit without growing
+    void reserve(size_t expected){
+        std::unique_lock<std::shared_mutex> guard(table_lock);
+        size_t needed=round_up_capacity(expected*MAX_LOAD_DEN/MAX_LOAD_NUM+1);
+        if(needed>capacity){
+            rehash(needed);
+        }
+    }
+
+    /*
+     * Inserts an item into the first empty slot of its probe sequence.
+     * Time Complexity: O(1) amortised.
+     */
+    void insert(uint32_t hash, const T& item){
+        std::unique_lock<std::shared_mutex> guard(table_lock);
+        insert_locked(hash, item);
+    }
+
+    /*
+     * Inserts `item` unless an item for which `equals(item)` is true is already stored, in which case that one is copied into
+     * `existing` and false is returned. The check and the insert happen under one exclusive lock, so of two concurrent calls for
+     * the same key exactly one inserts.
+     * Time Complexity: O(1) amortised.
+     */
+    template<typename Equals>
+    bool insert_if_absent(uint32_t hash, Equals equals, const T& item, T& existing){
+        std::unique_lock<std::shared_mutex> guard(table_lock);
+        if(probe(hash, equals, existing)) return false;
+        insert_locked(hash, item);
+        return true;
+    }
+
+    /*
+     * Looks for the item for which `equals(item)` is true and copies it into `out`. Returns false if there is none.
+     * Time Complexity: O(1) average; usually a single group compare and a single slot check.
+     */
+    template<typename Equals>
+    bool find(uint32_t hash, Equals equals, T& out){
+        std::shared_lock<std::shared_mutex> guard(table_lock);
+        return probe(hash, equals, out);
+    }
+
+    /*
+     * Looks up `n` keys at once: `hashes[i]` is the hash of key `i` and `equals(i, item)` tells whether `item` is key `i`'s.
+     * `out[i]` receives the match, and is left untouched when there is none. The first control group and candidate slots of
+     * later keys are prefetched while earlier ones are resolved (see `Prefetch.hpp`); the lock is taken once for the batch.
+     * Time Complexity: O(n) average.
+     */
+    template<typename Equals>
+    void find_many(const uint32_t* hashes, size_t n, Equals equals, T* out){
+        std::shared_lock<std::shared_mutex> guard(table_lock);
+        size_t group_mask=capacity/GROUP_WIDTH-1;
+        batch_pipeline(n, [&](size_t i){
+            prefetch_line(ctrl+(h1(hashes[i])&group_mask)*GROUP_WIDTH);
+        }, [&](size_t i){
+            size_t group=h1(hashes[i])&group_mask;
+            for(uint32_t candidates=flat_ctrl::match(ctrl+group*GROUP_WIDTH, h2(hashes[i])); candidates; candidates&=candidates-1){
+                prefetch_line(&slots[group*GROUP_WIDTH+flat_ctrl::lowest_bit(candidates)]);
+            }
+        }, [&](size_t i){
+            auto key_equals=[&equals, i](const T& item){ return equals(i, item); };
+            probe(hashes[i], key_equals, out[i]);
+        });
+    }
+
+    /*
+     * Removes the item for which `equals(item)` is true and copies it into `out`. Returns false if there is none.
+     * The slot goes back to `EMPTY` if its group still has an empty slot (then no probe sequence ever continued past the group),
+     * otherwise it becomes a tombstone.
+     * Time Complexity: O(1) average.
+     */
+    template<typename Equals>
+    bool erase(uint32_t hash, Equals equals, T& out){
+        std::unique_lock<std::shared_mutex> guard(table_lock);
+        size_t i=locate(hash, equals);
+        if(i==capacity) return false;
+        out=slots[i].data;
+        slots[i].data=T{};
+        if(flat_ctrl::match_empty(ctrl+(i/GROUP_WIDTH)*GROUP_WIDTH)){
+            ctrl[i]=flat_ctrl::EMPTY;
+        }
+        else{
+            ctrl[i]=flat_ctrl::DELETED;
+            tombstones++;
+        }
+        count--;
+        return true;
+    }
+
+    // Copies the first stored item for which `matches(item)` is true into `out`, scanning the whole table. O(N).
+    template<typename Predicate>
+    bool find_if(Predicate matches, T& out){
+        std::shared_lock<std::shared_mutex> guard(table_lock);
+        for(size_t i=0;i<capacity;i++){
+            if(ctrl[i]>=0 && matches(slots[i].data)){
+                out=slots[i].data;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Calls `visit(item)` for every stored item, on a consistent snapshot.
+    template<typename Visitor>
+    void for_each(Visitor visit){
+        std::shared_lock<std::shared_mutex> guard(table_lock);
+        for(size_t i=0;i<capacity;i++){
+            if(ctrl[i]>=0) visit(slots[i].data);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,498 @@
+#ifndef HASH_STORAGE_HPP
+#define HASH_STORAGE_HPP
+
+/*
+ * Description: This header defines `chained_storage`, the bucket array that backs every hash table in the project
+ * (`user_hashTable`, `classroom_hashTable`, `quiz_hashTable` and `quiz_result_hashTable`).
+ *
+ * DSA Concepts:
+ * 1.  **Separate Chaining with Inline Slots:** Each bucket is one 64-byte aligned cache line holding its first `INLINE_SLOTS` items
+ * (four for the record pointers the tables store) next to their full 32-bit hashes. Only items beyond those spill to a singly linked
+ * list of `hash_link` nodes. A lookup that used to load the bucket pointer, the node and then the record now loads the bucket line
+ * and the record; the hash compare filters out the others without touching them.
+ * 2.  **Load Factor:** The number of stored items divided by the number of inline slots. When it passes 0.75 (`MAX_LOAD_NUM / MAX_LOAD_DEN`)
+ * the table doubles its bucket count, so only a few percent of items ever sit in an overflow node.
+ * 3.  **Incremental Rehashing:** Doubling does not move every node at once. The old bucket array is kept alongside the new one and
+ * `MIGRATE_STEP` old buckets are moved on every insert and lookup. No single request pays for a full-table migration; lookups check
+ * the new array first and then the not-yet-migrated old bucket.
+ * 4.  **Power-of-two Sizes:** Bucket counts are always powers of two, so the index is `hash & (bucket_count - 1)` instead of a modulo.
+ * 5.  **Lock Striping:** Crow runs the routes on several worker threads, so the buckets are guarded by `LOCK_STRIPES` reader-writer locks.
+ * Bucket `i` belongs to stripe `i & (LOCK_STRIPES - 1)`. Because bucket counts are powers of two and never below `LOCK_STRIPES`,
+ * this equals `hash & (LOCK_STRIPES - 1)`: a key keeps its stripe across resizes, and migrating one old bucket only touches buckets
+ * of the same stripe. Lookups take one stripe shared, inserts take one stripe exclusive, and only swapping in a new bucket array
+ * takes all of them.
+ *
+ * 6.  **Slab-allocated Nodes:** Overflow nodes come from a `slab_pool` (see `SlabPool.hpp`) rather than one `new` each, and are
+ * released slab by slab when the storage is destroyed. A node whose item finds a free inline slot after a resize or an erase is
+ * given back.
+ *
+ * Locking rule: the `equals`/`matches`/`visit` callbacks run while a stripe is held, so they may read the immutable key fields of
+ * a record but must not lock a record or call back into the same storage. Record locks may be held while calling into a table.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include "SlabPool.hpp"
+#include "Prefetch.hpp"
+
+// A node in the overflow list of one bucket (separate chaining)
+template<typename T>
+struct hash_link {
+    T data{};
+    hash_link* next=nullptr;
+    uint32_t hash=0;    // Full hash of the key, cached so a resize never has to hash the key again
+};
+
+template<typename T>
+class chained_storage {
+    using link = hash_link<T>;
+
+    // (hash, item) pairs stored in the bucket itself: as many as fit in one cache line beside the fill count and the
+    // overflow pointer. Four for pointer items.
+    static constexpr size_t INLINE_FIT = (64-sizeof(link*)-alignof(T))/(sizeof(uint32_t)+sizeof(T));
+    static constexpr size_t INLINE_SLOTS = INLINE_FIT>0 ? INLINE_FIT : 1;
+    // Grow once the inline slots are 3/4 used on average
+    static constexpr size_t MAX_LOAD_NUM = 3*INLINE_SLOTS;
+    static constexpr size_t MAX_LOAD_DEN = 4;
+    // Number of old buckets moved to the new array on every insert/lookup while a resize is in progress
+    static constexpr size_t MIGRATE_STEP = 4;
+    // Number of reader-writer locks; also the smallest bucket count
+    static constexpr size_t LOCK_STRIPES = 64;
+
+    // One cache line: the first INLINE_SLOTS items of the bucket and their hashes, then a pointer to the rest
+    struct alignas(64) bucket {
+        uint32_t hashes[INLINE_SLOTS]{};
+        uint8_t filled=0;   // Inline slots in use; always the first `filled`
+        T items[INLINE_SLOTS]{};
+        link* overflow=nullptr;     // Items that did not fit inline, newest first
+    };
+
+    // Each lock on its own cache line so threads working on different stripes do not contend
+    struct alignas(64) stripe_lock {
+        std::shared_mutex lock;
+    };
+
+    bucket* buckets;    // Current bucket array
+    size_t bucket_count;
+    bucket* old_buckets=nullptr;    // Bucket array being drained during a resize (nullptr when no resize is running)
+    size_t old_count=0;
+    size_t migrate_pos=0;   // Next old bucket to move (guarded by resize_mutex)
+    std::atomic<size_t> count{0};     // Number of stored items
+    std::atomic<bool> resizing{false};  // Lets lookups skip the resize mutex when there is nothing to migrate
+
+    stripe_lock stripes[LOCK_STRIPES];
+    std::mutex resize_mutex;    // Serialises migration steps and bucket array swaps. Always taken before any stripe.
+    slab_pool<link> nodes;      // Every overflow node of this storage
+
+    static size_t round_up_pow2(size_t n){
+        size_t p=LOCK_STRIPES;
+        while(p<n) p<<=1;
+        return p;
+    }
+
+    static bucket* allocate(size_t n){
+        return new bucket[n]();
+    }
+
+    bool over_loaded(size_t items, size_t buckets_n) const {
+        return items*MAX_LOAD_DEN > buckets_n*MAX_LOAD_NUM;
+    }
+
+    std::shared_mutex& stripe_of(size_t hash_or_index){
+        return stripes[hash_or_index&(LOCK_STRIPES-1)].lock;
+    }
+
+    // Takes every stripe, always in ascending order so two threads doing this cannot deadlock
+    void lock_all(){
+        for(auto& s:stripes) s.lock.lock();
+    }
+    void unlock_all(){
+        for(auto& s:stripes) s.lock.unlock();
+    }
+    void lock_all_shared(){
+        for(auto& s:stripes) s.lock.lock_shared();
+    }
+    void unlock_all_shared(){
+        for(auto& s:stripes) s.lock.unlock_shared();
+    }
+
+    // Stores an item inline if its bucket has a free slot, otherwise at the head of the overflow list. Caller holds the stripe.
+    void put(bucket& target, uint32_t hash, const T& item){
+        if(target.filled<INLINE_SLOTS){
+            target.hashes[target.filled]=hash;
+            target.items[target.filled]=item;
+            target.filled++;
+            return;
+        }
+        link* node=nodes.create();
+        node->data=item;
+        node->hash=hash;
+        node->next=target.overflow;
+        target.overflow=node;
+    }
+
+    // Moves every item of old bucket `i` to its bucket in the new array. Caller holds the stripe of `i`.
+    void migrate_bucket(size_t i){
+        bucket& from=old_buckets[i];
+        for(size_t s=0;s<from.filled;s++){
+            put(buckets[from.hashes[s]&(bucket_count-1)], from.hashes[s], from.items[s]);
+        }
+        from.filled=0;
+        link* node=from.overflow;
+        while(node){
+            link* next=node->next;
+            bucket& target=buckets[node->hash&(bucket_count-1)];
+            if(target.filled<INLINE_SLOTS){
+                // Room inline after the split: the node is no longer needed
+                put(target, node->hash, node->data);
+                nodes.destroy(node);
+            }
+            else{
+                node->next=target.overflow;
+                target.overflow=node;
+            }
+            node=next;
+        }
+        from.overflow=nullptr;
+    }
+
+    // Frees the drained old array. Caller holds resize_mutex and every stripe.
+    void finish_resize(){
+        delete[] old_buckets;
+        old_buckets=nullptr;
+        old_count=0;
+        migrate_pos=0;
+        resizing.store(false, std::memory_order_release);
+    }
+
+    // Moves up to `steps` old buckets, one stripe at a time. Frees the old array once it is empty.
+    void migrate(size_t steps){
+        if(!resizing.load(std::memory_order_acquire)) return;
+        // Another thread already migrating is doing the same work; never block a request on it
+        std::unique_lock<std::mutex> resize_guard(resize_mutex, std::try_to_lock);
+        if(!resize_guard.owns_lock() || !old_buckets) return;
+        while(steps-- && migrate_pos<old_count){
+            size_t i=migrate_pos++;
+            std::unique_lock<std::shared_mutex> guard(stripe_of(i));
+            migrate_bucket(i);
+        }
+        if(migrate_pos==old_count){
+            // Readers may still be walking the old array, so it is freed with every stripe held
+            lock_all();
+            finish_resize();
+            unlock_all();
+        }
+    }
+
+    // Destructs the overflow nodes of a bucket array; only needed when `T` owns memory (inline items go with the array)
+    void destroy_chains(bucket* array, size_t n){
+        for(size_t i=0;i<n;i++){
+            link* curr=array[i].overflow;
+            while(curr){
+                link* next=curr->next;
+                nodes.destroy(curr);
+                curr=next;
+            }
+        }
+    }
+
+    // Installs a new bucket array of `new_count` buckets. The old one is drained incrementally. Caller holds resize_mutex.
+    void start_resize(size_t new_count){
+        bucket* fresh=allocate(new_count);
+        lock_all();
+        if(old_buckets){
+            // A previous resize must finish before a new one can start
+            while(migrate_pos<old_count) migrate_bucket(migrate_pos++);
+            finish_resize();
+        }
+        if(count.load()==0){
+            delete[] buckets;
+        }
+        else{
+            old_buckets=buckets;
+            old_count=bucket_count;
+            migrate_pos=0;
+            resizing.store(true, std::memory_order_release);
+        }
+        buckets=fresh;
+        bucket_count=new_count;
+        unlock_all();
+    }
+
+    // The rest of an insert, after its stripe is released: doubles the table if the insert pushed it over the load factor,
+    // then moves a few old buckets
+    void finish_insert(bool grow){
+        if(grow){
+            std::lock_guard<std::mutex> resize_guard(resize_mutex);
+            // Another inserter may have grown the table while we waited
+            if(over_loaded(count.load(), bucket_count)){
+                start_resize(bucket_count*2);
+            }
+        }
+        migrate(MIGRATE_STEP);
+    }
+
+    // Looks through one bucket, inline slots first. Nodes and slots whose cached hash differs are skipped without touching the item.
+    template<typename Equals>
+    static bool match_in(const bucket& candidate, uint32_t hash, Equals& equals, T& out){
+        for(size_t s=0;s<candidate.filled;s++){
+            if(candidate.hashes[s]==hash && equals(candidate.items[s])){
+                out=candidate.items[s];
+                return true;
+            }
+        }
+        for(link* node=candidate.overflow; node; node=node->next){
+            if(node->hash==hash && equals(node->data)){
+                out=node->data;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Removes the first item of a bucket for which `equals` holds and copies it into `out`. The last inline item fills the
+    // hole, and the head of the overflow list the freed inline slot, so the inline slots stay the first `filled`.
+    // Caller holds the stripe.
+    template<typename Equals>
+    bool remove_from(bucket& target, uint32_t hash, Equals& equals, T& out){
+        for(size_t s=0;s<target.filled;s++){
+            if(target.hashes[s]!=hash || !equals(target.items[s])) continue;
+            out=target.items[s];
+            size_t last=--target.filled;
+            if(s!=last){
+                target.hashes[s]=target.hashes[last];
+                target.items[s]=target.items[last];
+            }
+            target.items[last]=T{};
+            if(link* node=target.overflow){
+                target.overflow=node->next;
+                put(target, node->hash, node->data);
+                nodes.destroy(node);
+            }
+            return true;
+        }
+        for(link** prev=&target.overflow; *prev; prev=&(*prev)->next){
+            link* node=*prev;
+            if(node->hash==hash && equals(node->data)){
+                out=node->data;
+                *prev=node->next;
+                nodes.destroy(node);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Prefetches the items of a bucket whose cached hash matches, and the first overflow node
+    static void prefetch_matches(const bucket& candidate, uint32_t hash){
+        for(size_t s=0;s<candidate.filled;s++){
+            if(candidate.hashes[s]==hash) prefetch_item(candidate.items[s]);
+        }
+        if(candidate.overflow) prefetch_line(candidate.overflow);
+    }
+
+    // Calls `visit(item)` for every item of a bucket array until it returns true. Caller holds every stripe.
+    template<typename Visitor>
+    static bool visit_until(const bucket* array, size_t n, Visitor& visit){
+        for(size_t i=0;i<n;i++){
+            for(size_t s=0;s<array[i].filled;s++){
+                if(visit(array[i].items[s])) return true;
+            }
+            for(link* node=array[i].overflow; node; node=node->next){
+                if(visit(node->data)) return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    explicit chained_storage(size_t initial_buckets){
+        bucket_count=round_up_pow2(initial_buckets);
+        buckets=allocate(bucket_count);
+    }
+
+    chained_storage(const chained_storage&) = delete;
+    chained_storage& operator=(const chained_storage&) = delete;
+
+    // Frees the buckets and nodes only. The items themselves are owned by the table using this storage.
+    ~chained_storage(){
+        // Nodes holding trivially destructible items (pointers) are released with their slabs, without walking the chains
+        if constexpr(!std::is_trivially_destructible_v<T>){
+            destroy_chains(buckets, bucket_count);
+            if(old_buckets) destroy_chains(old_buckets, old_count);
+        }
+        delete[] buckets;
+        delete[] old_buckets;
+    }
+
+    size_t size() const { return count.load(); }
+
+    // Bytes of the bucket arrays (both while a resize drains the old one) and of the overflow node slabs. O(1).
+    size_t memory_bytes(){
+        std::lock_guard<std::mutex> resize_guard(resize_mutex);
+        return (bucket_count+old_count)*sizeof(bucket)+nodes.bytes();
+    }
+
+    /*
+     * Presizes the table for `expected` items so loading a file of known length never triggers a resize.
+     * Time Complexity: O(1) on an empty table, otherwise the move is spread over later operations.
+     */
+    void reserve(size_t expected){
+        std::lock_guard<std::mutex> resize_guard(resize_mutex);
+        size_t needed=round_up_pow2(expected*MAX_LOAD_DEN/MAX_LOAD_NUM+1);
+        if(needed>bucket_count){
+            start_resize(needed);
+        }
+    }
+
+    /*
+     * Inserts an item into a free inline slot of its bucket, or at the head of the bucket's overflow list.
+     * Time Complexity: O(1) amortised. Doubling is triggered here but paid for MIGRATE_STEP buckets at a time.
+     */
+    void insert(uint32_t hash, const T& item){
+        bool grow;
+        {
+            std::unique_lock<std::shared_mutex> guard(stripe_of(hash));
+            put(buckets[hash&(bucket_count-1)], hash, item);
+            grow=over_loaded(count.fetch_add(1)+1, bucket_count);
+        }
+        finish_insert(grow);
+    }
+
+    /*
+     * Inserts `item` unless an item for which `equals(item)` is true is already stored, in which case that one is copied into
+     * `existing` and false is returned. The check and the insert happen under one exclusive stripe lock, so of two concurrent
+     * calls for the same key exactly one inserts.
+     * Time Complexity: O(1) amortised, as `insert`.
+     */
+    template<typename Equals>
+    bool insert_if_absent(uint32_t hash, Equals equals, const T& item, T& existing){
+        bool grow;
+        {
+            std::unique_lock<std::shared_mutex> guard(stripe_of(hash));
+            bucket& target=buckets[hash&(bucket_count-1)];
+            if(match_in(target, hash, equals, existing) || (old_buckets && match_in(old_buckets[hash&(old_count-1)], hash, equals, existing))){
+                return false;
+            }
+            put(target, hash, item);
+            grow=over_loaded(count.fetch_add(1)+1, bucket_count);
+        }
+        finish_insert(grow);
+        return true;
+    }
+
+    /*
+     * Looks for the item in the key's bucket for which `equals(item)` is true and copies it into `out`.
+     * A bucket is one cache line holding the first few items and their hashes, so a lookup usually reads that line and then
+     * only the matching record. Returns false (leaving `out` untouched) if there is none.
+     * Time Complexity: O(1) average.
+     */
+    template<typename Equals>
+    bool find(uint32_t hash, Equals equals, T& out){
+        bool found;
+        {
+            std::shared_lock<std::shared_mutex> guard(stripe_of(hash));
+            found=match_in(buckets[hash&(bucket_count-1)], hash, equals, out);
+            // Not migrated yet: the item may still be in its old bucket
+            if(!found && old_buckets) found=match_in(old_buckets[hash&(old_count-1)], hash, equals, out);
+        }
+        migrate(MIGRATE_STEP);
+        return found;
+    }
+
+    /*
+     * Looks up `n` keys at once: `hashes[i]` is the hash of key `i` and `equals(i, item)` tells whether `item` is key `i`'s.
+     * `out[i]` receives the match, and is left untouched when there is none. The buckets and records of later keys are
+     * prefetched while earlier ones are resolved (see `Prefetch.hpp`), so their cache misses overlap. Batches of at least
+     * LOCK_STRIPES keys hold every stripe shared for the whole batch; smaller ones take one stripe per key as `find` does.
+     * Time Complexity: O(n) average.
+     */
+    template<typename Equals>
+    void find_many(const uint32_t* hashes, size_t n, Equals equals, T* out){
+        if(n<LOCK_STRIPES){
+            for(size_t i=0;i<n;i++) find(hashes[i], [&equals, i](const T& item){ return equals(i, item); }, out[i]);
+            return;
+        }
+        lock_all_shared();
+        size_t mask=bucket_count-1;
+        batch_pipeline(n, [&](size_t i){
+            prefetch_line(&buckets[hashes[i]&mask]);
+            if(old_buckets) prefetch_line(&old_buckets[hashes[i]&(old_count-1)]);
+        }, [&](size_t i){
+            prefetch_matches(buckets[hashes[i]&mask], hashes[i]);
+            if(old_buckets) prefetch_matches(old_buckets[hashes[i]&(old_count-1)], hashes[i]);
+        }, [&](size_t i){
+            auto key_equals=[&equals, i](const T& item){ return equals(i, item); };
+            if(!match_in(buckets[hashes[i]&mask], hashes[i], key_equals, out[i]) && old_buckets){
+                match_in(old_buckets[hashes[i]&(old_count-1)], hashes[i], key_equals, out[i]);
+            }
+        });
+        unlock_all_shared();
+        migrate(MIGRATE_STEP);
+    }
+
+    /*
+     * Removes the item for which `equals(item)` is true and copies it into `out`. Returns false if there is none.
+     * Only the storage's own slot or node is freed; the item is still the caller's to destroy.
+     * Time Complexity: O(1) average.
+     */
+    template<typename Equals>
+    bool erase(uint32_t hash, Equals equals, T& out){
+        bool removed;
+        {
+            std::unique_lock<std::shared_mutex> guard(stripe_of(hash));
+            removed=remove_from(buckets[hash&(bucket_count-1)], hash, equals, out);
+            if(!removed && old_buckets) removed=remove_from(old_buckets[hash&(old_count-1)], hash, equals, out);
+            if(removed) count.fetch_sub(1);
+        }
+        migrate(MIGRATE_STEP);
+        return removed;
+    }
+
+    // Copies the first stored item for which `matches(item)` is true into `out`, scanning the whole table. O(N).
+    template<typename Predicate>
+    bool find_if(Predicate matches, T& out){
+        auto check=[&matches, &out](const T& item){
+            if(!matches(item)) return false;
+            out=item;
+            return true;
+        };
+        lock_all_shared();
+        bool found=visit_until(buckets, bucket_count, check) || (old_buckets && visit_until(old_buckets, old_count, check));
+        unlock_all_shared();
+        return found;
+    }
+
+    // Calls `visit(item)` for every stored item, on a consistent snapshot. Used for saving to file and for full-table scans.
+    template<typename Visitor>
+    void for_each(Visitor visit){
+        auto all=[&visit](const T& item){
+            visit(item);
+            return false;
+        };
+        lock_all_shared();
+        visit_until(buckets, bucket_count, all);
+        // Migrated old buckets are already empty
+        if(old_buckets) visit_until(old_buckets, old_count, all);
+        unlock_all_shared();
+    }
+};
+
+/*
+ * `table_storage` is the bucket layout every entity table is built on.
+ * Building with `EDUMAZE_FLAT_TABLES` switches all tables to the open-addressing `flat_storage` (see `FlatStorage.hpp`).
+ */
+#ifdef EDUMAZE_FLAT_TABLES
+#include "FlatStorage.hpp"
+template<typename T>
+using table_storage = flat_storage<T>;
+#else
+template<typename T>
+using table_storage = chained_storage<T>;
+#endif
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef ID_LIST_HPP
+#define ID_LIST_HPP
+
+/*
+ * Description: This header defines `id_list`, the list of classroom codes a user record holds (`classroomIds`). The dashboards
+ * read it on every request and it changes only when the user joins, leaves, creates or deletes a classroom, so reads take no lock.
+ *
+ * DSA Concepts:
+ * 1.  **Read-Copy-Update:** The codes live in one immutable block: a count followed by the IDs. A change copies the block with
+ * the change applied and publishes the copy with one atomic store; the old block is retired through `epoch_domain` (see
+ * `EpochReclaim.hpp`) and freed once no request can still be reading it. A reader loads the pointer once and walks a snapshot
+ * that never changes under it.
+ * 2.  **One Word Inline:** The record holds only the pointer, 8 bytes where a `std::vector` took 24, which is what lets the fields
+ * every request reads share one cache line in `student_data` and `teacher_data`.
+ *
+ * Writers must be serialised by the caller (the record's `lock`, held exclusively); a change costs O(n) for n codes, where
+ * n is the handful of classrooms one user is in. Reads are O(1) to start and must happen inside a read section (`epoch_guard`),
+ * as every request does (see `Common_Route.hpp`).
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <vector>
+#include "json.hpp"
+#include "EntityId.hpp"
+#include "EpochReclaim.hpp"
+
+class id_list {
+    struct block {
+        uint32_t size;
+
+        entity_id* ids(){ return reinterpret_cast<entity_id*>(this+1); }
+        const entity_id* ids() const { return reinterpret_cast<const entity_id*>(this+1); }
+    };
+
+    static_assert(alignof(entity_id)<=alignof(block), "the IDs follow the count without padding");
+
+    std::atomic<block*> current{nullptr};   // Null while the list is empty
+
+    // A block holding `first[0, n)` followed by `extra` (if valid); null for an empty list
+    static block* make(const entity_id* first, size_t n, entity_id extra=entity_id()){
+        size_t total=n+(extra.valid() ? 1 : 0);
+        if(total==0) return nullptr;
+        block* built=static_cast<block*>(::operator new(sizeof(block)+total*sizeof(entity_id)));
+        built->size=static_cast<uint32_t>(total);
+        if(n) std::memcpy(built->ids(), first, n*sizeof(entity_id));
+        if(extra.valid()) built->ids()[n]=extra;
+        return built;
+    }
+
+    static void free_block(void* old, void*){
+        ::operator delete(old);
+    }
+
+    // Publishes `next` in place of the current block, which is freed once no reader can still hold it
+    void publish(block* next){
+        block* old=current.exchange(next, std::memory_order_acq_rel);
+        if(old) epoch_domain::instance().retire(old, &free_block, nullptr);
+    }
+
+public:
+    // A read-only snapshot of the codes. Valid until the read section it was taken in ends.
+    class view {
+        const entity_id* first=nullptr;
+        size_t count=0;
+
+    public:
+        view() = default;
+        view(const entity_id* thefirst, size_t thecount): first(thefirst), count(thecount){}
+
+        const entity_id* begin() const { return first; }
+        const entity_id* end() const { return first+count; }
+        size_t size() const { return count; }
+        bool empty() const { return count==0; }
+        entity_id operator[](size_t i) const { return first[i]; }
+
+        std::vector<entity_id> to_vector() const { return std::vector<entity_id>(begin(), end()); }
+    };
+
+    id_list() = default;
+
+    explicit id_list(const std::vector<entity_id>& ids): current(make(ids.data(), ids.size())){}
+
+    id_list(const id_list&) = delete;
+    id_list& operator=(const id_list&) = delete;
+
+    // The record holding the list is unreachable by the time it is destroyed, so the block is freed at once
+    ~id_list(){
+        ::operator delete(current.load(std::memory_order_relaxed));
+    }
+
+    /*
+     * The codes as they are now.
+     * Time Complexity: O(1).
+     */
+    view read() const {
+        const block* now=current.load(std::memory_order_acquire);
+        return now ? view(now->ids(), now->size) : view();
+    }
+
+    /*
+     * Appends `id`. The caller holds the owning record's lock exclusively.
+     * Time Complexity: O(n), for the copy.
+     */
+    void push_back(entity_id id){
+        view now=read();
+        publish(make(now.begin(), now.size(), id));
+    }
+
+    /*
+     * Removes every occurrence of `id`; returns whether there was one. The caller holds the owning record's lock exclusively.
+     * Time Complexity: O(n).
+     */
+    bool erase(entity_id id){
+        view now=read();
+        std::vector<entity_id> kept;
+        kept.reserve(now.size());
+        for(entity_id code:now) if(code!=id) kept.push_back(code);
+        if(kept.size()==now.size()) return false;
+        publish(make(kept.data(), kept.size()));
+        return true;
+    }
+
+    // Heap bytes of the current block, for the memory report (see `MemoryUsage.hpp`)
+    size_t heap_bytes() const {
+        const block* now=current.load(std::memory_order_acquire);
+        return now ? sizeof(block)+now->size*sizeof(entity_id) : 0;
+    }
+};
+
+// Saved as the same array of codes a `std::vector<entity_id>` was, so the file format is unchanged
+inline void to_json(nlohmann::json& j, const id_list& list){
+    j=nlohmann::json::array();
+    for(entity_id code:list.read()) j.push_back(code);
+}
+
+#endif
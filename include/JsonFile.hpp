@@ -0,0 +1,45 @@
+#ifndef JSON_FILE_HPP
+#define JSON_FILE_HPP
+
+/*
+ * Description: Helper shared by all tables for persisting their JSON files.
+ * The file is written to a temporary path first and then renamed over the real one. A rename replaces the file in one step,
+ * so a concurrent reader, or a crash halfway through a save, never sees a half-written (torn) JSON file.
+ * `jsonText` reads a string field without copying it, and `takeText` moves one out of a document that is about to be discarded.
+ */
+
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <system_error>
+#include "json.hpp"
+
+inline void saveJsonFile(const std::string& path, const nlohmann::json& j){
+    std::string tmp_path=path+".tmp";
+    {
+        std::ofstream tmp_file(tmp_path);
+        tmp_file<<j.dump(4);
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if(ec){
+        std::cerr<<"[ERROR] Could not replace "<<path<<": "<<ec.message()<<std::endl;
+    }
+}
+
+// A view of a JSON string value, so loaders can build records without a temporary std::string. Throws if `j` is not a string.
+inline std::string_view jsonText(const nlohmann::json& j){
+    return j.get_ref<const std::string&>();
+}
+
+// Moves the string field `key` out of a parsed object, leaving it empty, so a loader can hand it to a record without copying it.
+// A missing field reads as "". Throws if the field is not a string.
+inline std::string takeText(nlohmann::json& object, const char* key){
+    auto field=object.find(key);
+    if(field==object.end()) return std::string();
+    return std::move(field->get_ref<std::string&>());
+}
+
+#endif
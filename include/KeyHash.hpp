@@ -0,0 +1,124 @@
+#ifndef KEY_HASH_HPP
+#define KEY_HASH_HPP
+
+/*
+ * Description: This header defines the hash policy shared by every table. `key_hash::hash` maps a string key (username, email)
+ * or an integer key (`entity_id`) to the 32-bit hash the storages index with.
+ *
+ * DSA Concepts:
+ * 1.  **Word-at-a-time Hashing:** `word_hash` reads the key 8 bytes at a time and mixes each 64-bit word with one multiply and one
+ * rotate, so an 18-byte email costs three mixing rounds instead of FNV-1a's eighteen dependent byte-by-byte multiplies.
+ * 2.  **Avalanche Finaliser:** After the words are absorbed, the 64-bit state is scrambled (xor-shift / multiply, as in MurmurHash3's
+ * `fmix64`) so that every input bit affects every output bit. The storages index with the low bits, so this matters.
+ * 3.  **Seeding:** The state starts from a random seed drawn once per process (`hash_seed`). Which keys collide changes from run to
+ * run, so nobody can precompute a set of usernames that all land in one chain.
+ *
+ * Building with `EDUMAZE_FNV1A_HASH` switches `key_hash` back to the original unseeded, byte-at-a-time FNV-1a (`fnv1a_hash`).
+ * Hashes are never written to disk, so the two can be swapped freely.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string_view>
+
+// Random per-process seed, fixed for the lifetime of the process (the tables cache hashes in their nodes)
+inline uint64_t make_hash_seed(){
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd())<<32) ^ rd();
+}
+
+inline const uint64_t hash_seed = make_hash_seed();
+
+struct word_hash {
+    static constexpr uint64_t K1 = 0x9E3779B185EBCA87ull;
+    static constexpr uint64_t K2 = 0xC2B2AE3D27D4EB4Full;
+
+    static uint64_t rotl(uint64_t x, int r){ return (x<<r) | (x>>(64-r)); }
+
+    // MurmurHash3 fmix64
+    static uint64_t avalanche(uint64_t h){
+        h^=h>>33;
+        h*=0xff51afd7ed558ccdull;
+        h^=h>>33;
+        h*=0xc4ceb9fe1a85ec53ull;
+        h^=h>>33;
+        return h;
+    }
+
+    static uint64_t mix_word(uint64_t state, uint64_t word){
+        return rotl(state^(word*K2), 31)*K1;
+    }
+
+    // Unaligned-safe fixed-size loads; each compiles to a single mov
+    static uint64_t load8(const char* p){ uint64_t v; std::memcpy(&v, p, 8); return v; }
+    static uint64_t load4(const char* p){ uint32_t v; std::memcpy(&v, p, 4); return v; }
+
+    /*
+     * Hashes a string key. The length is folded in first so "ab" and "ab\0" differ.
+     * The last partial word is read as an overlapping full load instead of byte by byte, so there is no per-byte loop at all.
+     * Time Complexity: O(n / 8).
+     */
+    static uint32_t hash(std::string_view key){
+        const char* p=key.data();
+        size_t n=key.size();
+        uint64_t h=hash_seed ^ (n*K1);
+        if(n>8){
+            const char* last=p+n-8;
+            for(;p<last;p+=8) h=mix_word(h, load8(p));
+            h=mix_word(h, load8(last));     // Overlaps the previous word when n is not a multiple of 8
+        }
+        else if(n==8){
+            h=mix_word(h, load8(p));
+        }
+        else if(n>=4){
+            h=mix_word(h, (load4(p)<<32) | load4(p+n-4));
+        }
+        else if(n>0){
+            uint64_t word=(static_cast<uint64_t>(static_cast<unsigned char>(p[0]))<<16)
+                         | (static_cast<uint64_t>(static_cast<unsigned char>(p[n>>1]))<<8)
+                         | static_cast<unsigned char>(p[n-1]);
+            h=mix_word(h, word);
+        }
+        h=avalanche(h);
+        return static_cast<uint32_t>(h ^ (h>>32));
+    }
+
+    // Hashes an integer key (an `entity_id`'s value). O(1).
+    static uint32_t hash(uint32_t key){
+        uint64_t h=avalanche(hash_seed ^ key);
+        return static_cast<uint32_t>(h ^ (h>>32));
+    }
+};
+
+// The original FNV-1a hash, one byte per step, with no seed
+struct fnv1a_hash {
+    static uint32_t hash(std::string_view key){
+        const uint32_t basis=2166136261u;
+        const uint32_t prime=16777619u;
+        uint32_t hash=basis;
+        for(unsigned char c:key){
+            hash^=c;
+            hash*=prime;
+        }
+        return hash;
+    }
+
+    // Integer keys use the MurmurHash3 32-bit finaliser
+    static uint32_t hash(uint32_t key){
+        key^=key>>16;
+        key*=0x85ebca6bu;
+        key^=key>>13;
+        key*=0xc2b2ae35u;
+        key^=key>>16;
+        return key;
+    }
+};
+
+#ifdef EDUMAZE_FNV1A_HASH
+using key_hash = fnv1a_hash;
+#else
+using key_hash = word_hash;
+#endif
+
+#endif
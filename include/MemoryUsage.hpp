@@ -0,0 +1,56 @@
+#ifndef MEMORY_USAGE_HPP
+#define MEMORY_USAGE_HPP
+
+/*
+ * Description: This header defines `memory_usage`, the bytes one table holds, split by what they are spent on, as reported by
+ * `/admin/memory` (see `source/Admin.cpp`):
+ * - nodes: the index, i.e. the storage's bucket or slot arrays and chain nodes (see `HashStorage.hpp` and the other storages);
+ * - records: the slabs of fixed-size records (see `SlabPool.hpp`), free cells included, and other fixed-size blocks;
+ * - strings: text a record owns on the heap, i.e. beyond the small-string buffer inside the `std::string` itself;
+ * - vectors: arrays a record owns on the heap (ID lists, rosters, answers, question blocks).
+ *
+ * DSA Concepts:
+ * 1.  **On-Demand Accounting:** Nothing is counted on the request path. A report walks each table once, reading the capacities of
+ * the arrays and strings it already has, so leaving the endpoint on costs nothing until someone asks, and O(n) when they do.
+ *
+ * The figures are what the tables asked the allocator for; its own per-block overhead is not included.
+ */
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct memory_usage {
+    size_t entities=0;
+    size_t nodes=0;
+    size_t records=0;
+    size_t strings=0;
+    size_t vectors=0;
+
+    size_t total() const { return nodes+records+strings+vectors; }
+
+    memory_usage& operator+=(const memory_usage& other){
+        entities+=other.entities;
+        nodes+=other.nodes;
+        records+=other.records;
+        strings+=other.strings;
+        vectors+=other.vectors;
+        return *this;
+    }
+};
+
+// Heap bytes of `text`: none while it fits the small-string buffer inside the object, else its capacity and terminator
+inline size_t heap_bytes(const std::string& text){
+    const char* data=text.data();
+    const char* object=reinterpret_cast<const char*>(&text);
+    bool inline_buffer=data>=object && data<object+sizeof(std::string);
+    return inline_buffer ? 0 : text.capacity()+1;
+}
+
+// Heap bytes of the array of `list` (not of what its elements own)
+template<typename T>
+size_t heap_bytes(const std::vector<T>& list){
+    return list.capacity()*sizeof(T);
+}
+
+#endif
@@ -0,0 +1,505 @@
+#ifndef PERFECT_HASH_STORAGE_HPP
+#define PERFECT_HASH_STORAGE_HPP
+
+/*
+ * Description: This header defines `perfect_storage`, a storage for the read-mostly quiz catalog built around a minimal perfect
+ * hash function (MPHF). It has the same interface as the other storages and is selected for `quiz_hashTable` by building with
+ * `EDUMAZE_PERFECT_QUIZZES` (see `quiz_storage` below).
+ *
+ * DSA Concepts:
+ * 1.  **Minimal Perfect Hashing (CHD, "hash, displace and compress"):** For a fixed set of n keys, the build finds a function that
+ * sends every key to its own slot in an array of exactly n slots. Keys are first split into about n / `BUCKET_SIZE` small buckets
+ * by one hash. Buckets are then placed largest first: for each one the build tries seeds 0, 1, 2, ... until a second hash, mixed
+ * with that seed, sends all of the bucket's keys to slots that are still free. Only the seed (4 bytes per bucket) is stored.
+ * 2.  **One-probe Lookup:** A lookup reads its bucket's seed, computes its slot and compares one stored hash and one item. There is
+ * no chain and no probe sequence, hit or miss.
+ * 3.  **Overlay:** Items inserted since the last build go into a small append-only overlay that lookups scan after the probe. A
+ * background thread rebuilds the snapshot over everything once writes have been quiet for `QUIET_PERIOD` (or straight away once
+ * `URGENT_WRITES` have piled up), then publishes it and empties the overlay.
+ * 4.  **Read-Copy-Update:** Every build is a new immutable `snapshot`, published with one atomic store and retired to
+ * `epoch_domain` (see `EpochReclaim.hpp`), so readers never lock, exactly as in `rcu_storage`. Overlay entries are written before
+ * the count that makes them visible is released.
+ *
+ * Two items whose 32-bit hashes collide cannot both have a slot; the second one simply stays in the overlay.
+ * An erase builds and publishes a new snapshot without the item straight away: O(n), but quizzes are seldom deleted.
+ * Writers are serialised by one mutex. A build is O(n) expected and runs outside that mutex, on the worker thread.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "EpochReclaim.hpp"
+#include "Prefetch.hpp"
+
+template<typename T>
+class perfect_storage {
+    static constexpr size_t BUCKET_SIZE = 4;        // Average keys per CHD bucket
+    static constexpr size_t OVERLAY_CAPACITY = 256; // Least overlay room a new snapshot gets
+    static constexpr size_t URGENT_WRITES = 64;     // Rebuild without waiting for quiet once this many writes are pending
+    static constexpr std::chrono::milliseconds QUIET_PERIOD{500};
+    static constexpr uint32_t GOLDEN = 0x9E3779B9u;
+
+    // MurmurHash3 fmix32
+    static uint32_t mix(uint32_t h){
+        h^=h>>16;
+        h*=0x85ebca6bu;
+        h^=h>>13;
+        h*=0xc2b2ae35u;
+        h^=h>>16;
+        return h;
+    }
+
+    // Maps a 32-bit value onto [0, n) with one multiply instead of a modulo
+    static size_t reduce(uint32_t x, size_t n){
+        return static_cast<size_t>((static_cast<uint64_t>(x)*n)>>32);
+    }
+
+    // The hash sits next to its item so a probe reads one cache line
+    struct slot {
+        uint32_t hash;
+        T item;
+    };
+
+    // One published, immutable state: the perfect-hash arrays plus the overlay of later inserts
+    struct snapshot {
+        uint32_t salt=0;    // Chosen per build; a failed build retries with another
+        std::vector<uint32_t> seeds;    // Per-bucket displacement seed
+        std::vector<slot> slots;
+
+        std::unique_ptr<uint32_t[]> overlay_hashes;
+        std::unique_ptr<T[]> overlay_items;
+        size_t overlay_capacity;
+        std::atomic<size_t> overlay_count{0};
+
+        explicit snapshot(size_t capacity):
+        overlay_hashes(new uint32_t[capacity]), overlay_items(new T[capacity]), overlay_capacity(capacity){}
+
+        size_t bucket_of(uint32_t hash) const { return reduce(mix(hash^salt), seeds.size()); }
+        size_t slot_of(uint32_t hash, uint32_t seed) const { return reduce(mix((hash+seed*GOLDEN)^~salt), slots.size()); }
+
+        // Appends to the overlay; the caller has checked there is room. Caller holds writer_mutex.
+        void append(uint32_t hash, const T& item){
+            size_t k=overlay_count.load(std::memory_order_relaxed);
+            overlay_hashes[k]=hash;
+            overlay_items[k]=item;
+            overlay_count.store(k+1, std::memory_order_release);
+        }
+
+        // Copies every item of this snapshot (slots, then overlay) into the two vectors
+        void collect(std::vector<uint32_t>& out_hashes, std::vector<T>& out_items) const {
+            for(const slot& entry:slots){
+                out_hashes.push_back(entry.hash);
+                out_items.push_back(entry.item);
+            }
+            size_t k=overlay_count.load(std::memory_order_acquire);
+            out_hashes.insert(out_hashes.end(), overlay_hashes.get(), overlay_hashes.get()+k);
+            out_items.insert(out_items.end(), overlay_items.get(), overlay_items.get()+k);
+        }
+    };
+
+    /*
+     * Tries to place `keys` (distinct hashes) with the current `salt`. Fills `s.seeds` and `slot_of_key`.
+     * Returns false if some bucket found no seed, in which case the caller retries with another salt.
+     */
+    static bool place_buckets(snapshot& s, const std::vector<uint32_t>& keys, std::vector<size_t>& slot_of_key){
+        size_t n=keys.size();
+        size_t bucket_count=s.seeds.size();
+        // Group key indexes by bucket with a counting sort: bucket b owns members[start[b], start[b+1])
+        std::vector<size_t> start(bucket_count+1, 0);
+        std::vector<size_t> bucket(n);
+        for(size_t i=0;i<n;i++){
+            bucket[i]=s.bucket_of(keys[i]);
+            start[bucket[i]+1]++;
+        }
+        for(size_t b=0;b<bucket_count;b++) start[b+1]+=start[b];
+        std::vector<size_t> members(n);
+        std::vector<size_t> fill(start.begin(), start.end()-1);
+        for(size_t i=0;i<n;i++) members[fill[bucket[i]]++]=i;
+        std::vector<size_t> order(bucket_count);
+        std::iota(order.begin(), order.end(), 0);
+        auto size_of=[&start](size_t b){ return start[b+1]-start[b]; };
+        std::stable_sort(order.begin(), order.end(), [&size_of](size_t a, size_t b){ return size_of(a)>size_of(b); });
+
+        std::vector<uint8_t> taken(n, 0);
+        std::vector<size_t> trial;
+        // Enough tries that even the last singleton, with one free slot left, is placed with overwhelming probability
+        const uint64_t max_seed=16*static_cast<uint64_t>(n)+1024;
+        for(size_t b:order){
+            if(size_of(b)==0) break;
+            const size_t* first=&members[start[b]];
+            const size_t* last=first+size_of(b);
+            bool placed=false;
+            for(uint64_t seed=0;seed<max_seed && !placed;seed++){
+                trial.clear();
+                placed=true;
+                for(const size_t* i=first;i!=last;i++){
+                    size_t slot=s.slot_of(keys[*i], static_cast<uint32_t>(seed));
+                    if(taken[slot] || std::find(trial.begin(), trial.end(), slot)!=trial.end()){
+                        placed=false;
+                        break;
+                    }
+                    trial.push_back(slot);
+                }
+                if(placed){
+                    s.seeds[b]=static_cast<uint32_t>(seed);
+                    for(size_t j=0;j<trial.size();j++){
+                        taken[trial[j]]=1;
+                        slot_of_key[first[j]]=trial[j];
+                    }
+                }
+            }
+            if(!placed) return false;
+        }
+        return true;
+    }
+
+    /*
+     * Builds a snapshot over the given items. Items whose hash repeats an earlier one go to the overlay, which gets room for
+     * `extra_capacity` more entries.
+     * Time Complexity: O(n) expected.
+     */
+    static snapshot* build(const std::vector<uint32_t>& hashes, const std::vector<T>& items, size_t extra_capacity){
+        // Separate the distinct hashes from repeats
+        std::vector<size_t> by_hash(hashes.size());
+        std::iota(by_hash.begin(), by_hash.end(), 0);
+        std::sort(by_hash.begin(), by_hash.end(), [&hashes](size_t a, size_t b){ return hashes[a]<hashes[b]; });
+        std::vector<size_t> unique, repeats;
+        for(size_t j=0;j<by_hash.size();j++){
+            if(j>0 && hashes[by_hash[j]]==hashes[by_hash[j-1]]) repeats.push_back(by_hash[j]);
+            else unique.push_back(by_hash[j]);
+        }
+
+        snapshot* s=new snapshot(repeats.size()+extra_capacity);
+        size_t n=unique.size();
+        if(n>0){
+            std::vector<uint32_t> keys(n);
+            for(size_t i=0;i<n;i++) keys[i]=hashes[unique[i]];
+            std::vector<size_t> slot_of_key(n);
+            s->slots.resize(n);
+            s->seeds.assign((n+BUCKET_SIZE-1)/BUCKET_SIZE, 0);
+            for(uint32_t attempt=1;;attempt++){
+                s->salt=mix(attempt*GOLDEN);
+                if(place_buckets(*s, keys, slot_of_key)) break;
+                std::fill(s->seeds.begin(), s->seeds.end(), 0);
+            }
+            for(size_t i=0;i<n;i++) s->slots[slot_of_key[i]]=slot{keys[i], items[unique[i]]};
+        }
+        for(size_t i:repeats) s->append(hashes[i], items[i]);
+        return s;
+    }
+
+    std::atomic<snapshot*> current;
+    std::mutex writer_mutex;    // Writers and publication only; readers never touch it
+    // Counts publications (guarded by writer_mutex). A retired snapshot's address can be reused, so a build started on
+    // one snapshot checks this, not the pointer, to see whether it is still current.
+    uint64_t generation=0;
+
+    // Background rebuild state (guarded by worker_mutex)
+    std::mutex worker_mutex;
+    std::condition_variable wake;
+    size_t pending_writes=0;
+    bool stopping=false;
+    std::thread worker;
+
+    // Overlay room for a snapshot built over `base`: what is left of `base`'s, so room made by `reserve` survives the rebuilds
+    // that run during a bulk load, but never less than OVERLAY_CAPACITY
+    static size_t room_after(const snapshot& base){
+        size_t used=base.overlay_count.load(std::memory_order_relaxed);
+        return std::max(OVERLAY_CAPACITY, base.overlay_capacity-used);
+    }
+
+    // Rebuilds over the current snapshot, whose overlay is full, and publishes the result. The new overlay gets room for a
+    // quarter of the table, so a long burst of inserts costs O(1) amortised each. Caller holds writer_mutex.
+    void rebuild_locked(){
+        snapshot* base=current.load(std::memory_order_relaxed);
+        std::vector<uint32_t> hashes;
+        std::vector<T> items;
+        base->collect(hashes, items);
+        publish(build(hashes, items, std::max(room_after(*base), hashes.size()/4)));
+    }
+
+    // Makes `fresh` the current snapshot and retires the old one. Caller holds writer_mutex.
+    void publish(snapshot* fresh){
+        snapshot* old=current.load(std::memory_order_relaxed);
+        current.store(fresh, std::memory_order_release);
+        generation++;
+        epoch_domain::instance().retire(old);
+    }
+
+    void worker_loop(){
+        std::unique_lock<std::mutex> lock(worker_mutex);
+        for(;;){
+            wake.wait(lock, [this]{ return pending_writes>0 || stopping; });
+            // Wait for the batch of writes to end: QUIET_PERIOD with no new write, unless the overlay is already long
+            while(!stopping && pending_writes<URGENT_WRITES){
+                size_t seen=pending_writes;
+                if(!wake.wait_for(lock, QUIET_PERIOD, [&]{ return stopping || pending_writes!=seen; })) break;
+            }
+            if(stopping) return;
+            pending_writes=0;
+            lock.unlock();
+            rebuild();
+            lock.lock();
+        }
+    }
+
+    // Appends to the current snapshot's overlay, rebuilding first if it is full. Caller holds writer_mutex.
+    void append_locked(uint32_t hash, const T& item){
+        snapshot* s=current.load(std::memory_order_relaxed);
+        if(s->overlay_count.load(std::memory_order_relaxed)==s->overlay_capacity){
+            rebuild_locked();
+            s=current.load(std::memory_order_relaxed);
+        }
+        s->append(hash, item);
+    }
+
+    void note_write(){
+        {
+            std::lock_guard<std::mutex> guard(worker_mutex);
+            pending_writes++;
+        }
+        wake.notify_one();
+    }
+
+public:
+    explicit perfect_storage(size_t): current(new snapshot(OVERLAY_CAPACITY)){
+        worker=std::thread([this]{ worker_loop(); });
+    }
+
+    perfect_storage(const perfect_storage&) = delete;
+    perfect_storage& operator=(const perfect_storage&) = delete;
+
+    // Stops the rebuild thread and frees the current snapshot. The items themselves are owned by the table using this storage.
+    ~perfect_storage(){
+        {
+            std::lock_guard<std::mutex> guard(worker_mutex);
+            stopping=true;
+        }
+        wake.notify_one();
+        worker.join();
+        delete current.load();
+    }
+
+    size_t size() const {
+        epoch_guard read_section;
+        const snapshot* s=current.load(std::memory_order_acquire);
+        return s->slots.size()+s->overlay_count.load(std::memory_order_acquire);
+    }
+
+    // Bytes of the current snapshot: seeds, slots and overlay room. A snapshot still waiting for readers is not counted. O(1).
+    size_t memory_bytes() const {
+        epoch_guard read_section;
+        const snapshot* s=current.load(std::memory_order_acquire);
+        return sizeof(snapshot)+s->seeds.capacity()*sizeof(uint32_t)+s->slots.capacity()*sizeof(slot)
+               +s->overlay_capacity*(sizeof(uint32_t)+sizeof(T));
+    }
+
+    // Makes room in the overlay for `expected` inserts, so loading a file never forces a rebuild per `OVERLAY_CAPACITY` items
+    void reserve(size_t expected){
+        std::lock_guard<std::mutex> guard(writer_mutex);
+        snapshot* s=current.load(std::memory_order_relaxed);
+        size_t used=s->overlay_count.load(std::memory_order_relaxed);
+        if(s->overlay_capacity-used<expected){
+            std::vector<uint32_t> hashes;
+            std::vector<T> items;
+            s->collect(hashes, items);
+            publish(build(hashes, items, expected+OVERLAY_CAPACITY));
+        }
+    }
+
+    /*
+     * Rebuilds the perfect hash over every item and empties the overlay. Normally run by the worker thread after a batch of
+     * writes; the build itself runs without holding the writer mutex.
+     * Time Complexity: O(n) expected.
+     */
+    void rebuild(){
+        std::vector<uint32_t> hashes;
+        std::vector<T> items;
+        snapshot* base;
+        uint64_t base_generation;
+        size_t included, room;
+        {
+            std::lock_guard<std::mutex> guard(writer_mutex);
+            base=current.load(std::memory_order_relaxed);
+            base_generation=generation;
+            included=base->overlay_count.load(std::memory_order_relaxed);
+            room=room_after(*base);
+            base->collect(hashes, items);
+        }
+        snapshot* fresh=build(hashes, items, room);
+        std::lock_guard<std::mutex> guard(writer_mutex);
+        if(generation!=base_generation){
+            // A writer replaced the snapshot meanwhile (its overlay filled up); that snapshot already covers everything
+            delete fresh;
+            return;
+        }
+        // Carry over what was inserted while building; `room` covers all of it, since `base` had no more room than that
+        size_t now=base->overlay_count.load(std::memory_order_relaxed);
+        for(size_t k=included;k<now;k++) fresh->append(base->overlay_hashes[k], base->overlay_items[k]);
+        publish(fresh);
+    }
+
+    /*
+     * Appends an item to the overlay and schedules a rebuild. If the overlay is full, the snapshot is rebuilt right here first.
+     * Time Complexity: O(1), or O(n) when the overlay is full.
+     */
+    void insert(uint32_t hash, const T& item){
+        {
+            std::lock_guard<std::mutex> guard(writer_mutex);
+            append_locked(hash, item);
+        }
+        note_write();
+    }
+
+    /*
+     * Inserts `item` unless an item for which `equals(item)` is true is already stored, in which case that one is copied into
+     * `existing` and false is returned. Writers are serialised, so of two concurrent calls for the same key exactly one inserts.
+     * Time Complexity: O(1), as `insert`; the check is the one-probe lookup.
+     */
+    template<typename Equals>
+    bool insert_if_absent(uint32_t hash, Equals equals, const T& item, T& existing){
+        {
+            std::lock_guard<std::mutex> guard(writer_mutex);
+            if(probe(current.load(std::memory_order_relaxed), hash, equals, existing)) return false;
+            append_locked(hash, item);
+        }
+        note_write();
+        return true;
+    }
+
+    /*
+     * Looks for the item for which `equals(item)` is true and copies it into `out`. Takes no lock.
+     * Time Complexity: O(1): one slot of the perfect hash, then the overlay (empty once a rebuild has run).
+     */
+    template<typename Equals>
+    bool find(uint32_t hash, Equals equals, T& out){
+        epoch_guard read_section;
+        return probe(current.load(std::memory_order_acquire), hash, equals, out);
+    }
+
+    /*
+     * Looks up `n` keys at once: `hashes[i]` is the hash of key `i` and `equals(i, item)` tells whether `item` is key `i`'s.
+     * `out[i]` receives the match, and is left untouched when there is none. The seeds, then the slots, of later keys are
+     * prefetched while earlier ones are resolved (see `Prefetch.hpp`). Takes no lock; the whole batch reads one snapshot.
+     * Time Complexity: O(n).
+     */
+    template<typename Equals>
+    void find_many(const uint32_t* hashes, size_t n, Equals equals, T* out){
+        epoch_guard read_section;
+        const snapshot* s=current.load(std::memory_order_acquire);
+        if(s->slots.empty()){
+            for(size_t i=0;i<n;i++) probe(s, hashes[i], [&equals, i](const T& item){ return equals(i, item); }, out[i]);
+            return;
+        }
+        batch_pipeline(n, [&](size_t i){
+            prefetch_line(&s->seeds[s->bucket_of(hashes[i])]);
+        }, [&](size_t i){
+            prefetch_line(&s->slots[s->slot_of(hashes[i], s->seeds[s->bucket_of(hashes[i])])]);
+        }, [&](size_t i){
+            probe(s, hashes[i], [&equals, i](const T& item){ return equals(i, item); }, out[i]);
+        });
+    }
+
+    /*
+     * Removes the item for which `equals(item)` is true and copies it into `out`. Returns false if there is none.
+     * The perfect hash cannot simply drop a key, so the snapshot is rebuilt over the remaining items and published here.
+     * Time Complexity: O(n) expected.
+     */
+    template<typename Equals>
+    bool erase(uint32_t hash, Equals equals, T& out){
+        std::lock_guard<std::mutex> guard(writer_mutex);
+        snapshot* base=current.load(std::memory_order_relaxed);
+        std::vector<uint32_t> hashes;
+        std::vector<T> items;
+        base->collect(hashes, items);
+        size_t i=0;
+        while(i<items.size() && !(hashes[i]==hash && equals(items[i]))) i++;
+        if(i==items.size()) return false;
+        out=items[i];
+        hashes.erase(hashes.begin()+i);
+        items.erase(items.begin()+i);
+        publish(build(hashes, items, room_after(*base)));
+        return true;
+    }
+
+    // Copies the first stored item for which `matches(item)` is true into `out`, scanning the whole table. O(N).
+    template<typename Predicate>
+    bool find_if(Predicate matches, T& out){
+        bool found=false;
+        for_each_until([&](const T& item){
+            if(matches(item)){
+                out=item;
+                found=true;
+            }
+            return found;
+        });
+        return found;
+    }
+
+    // Calls `visit(item)` for every item in the snapshot current when the scan starts
+    template<typename Visitor>
+    void for_each(Visitor visit){
+        for_each_until([&visit](const T& item){
+            visit(item);
+            return false;
+        });
+    }
+
+private:
+    // The one-probe lookup of `find` in snapshot `s`. Caller is inside an epoch_guard.
+    template<typename Equals>
+    static bool probe(const snapshot* s, uint32_t hash, Equals equals, T& out){
+        if(!s->slots.empty()){
+            const slot& entry=s->slots[s->slot_of(hash, s->seeds[s->bucket_of(hash)])];
+            if(entry.hash==hash && equals(entry.item)){
+                out=entry.item;
+                return true;
+            }
+        }
+        size_t k=s->overlay_count.load(std::memory_order_acquire);
+        for(size_t i=0;i<k;i++){
+            if(s->overlay_hashes[i]==hash && equals(s->overlay_items[i])){
+                out=s->overlay_items[i];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Visits items until `visit` returns true
+    template<typename Visitor>
+    void for_each_until(Visitor visit){
+        epoch_guard read_section;
+        const snapshot* s=current.load(std::memory_order_acquire);
+        for(const slot& entry:s->slots){
+            if(visit(entry.item)) return;
+        }
+        size_t k=s->overlay_count.load(std::memory_order_acquire);
+        for(size_t i=0;i<k;i++){
+            if(visit(s->overlay_items[i])) return;
+        }
+    }
+};
+
+/*
+ * `quiz_storage` is the layout of the quiz table. Building with `EDUMAZE_PERFECT_QUIZZES` makes it `perfect_storage`;
+ * otherwise it is the `catalog_storage` shared with the classroom table.
+ */
+#include "RcuStorage.hpp"
+#ifdef EDUMAZE_PERFECT_QUIZZES
+template<typename T>
+using quiz_storage = perfect_storage<T>;
+#else
+template<typename T>
+using quiz_storage = catalog_storage<T>;
+#endif
+
+#endif
@@ -0,0 +1,292 @@
+#ifndef QUESTION_STORE_HPP
+#define QUESTION_STORE_HPP
+
+/*
+ * Description: This header defines the process-wide `question_store`, which holds every distinct question body (the question text
+ * and its options) once, however many quizzes use it. Teachers reuse the same questions across sections and semesters; each
+ * quiz refers to the shared `question_body` and keeps only its own correct answer (see `QuizQuestions.hpp`).
+ * The bodies are saved to `Data/questions.json`, and `quizzes.json` refers to them by ID.
+ *
+ * DSA Concepts:
+ * 1.  **Content Addressing:** A body's ID is a 64-bit FNV-1a hash of its content (the text and each option, length-prefixed),
+ * so the same question always gets the same ID, in every process and in the saved files. Two different bodies whose hashes
+ * collide are told apart by comparing their content, and the later one takes the next free ID.
+ * 2.  **Hash Index:** The bodies are indexed by ID in a `table_storage`. Finding the body of some content probes IDs from its hash
+ * upwards until it finds an equal body or a free ID.
+ * 3.  **String Pool:** A body is one allocation: a header, fixed-size option records, and the text of the question and its
+ * options in one character array.
+ * 4.  **Reference Counting:** Each body counts the quizzes using it and is freed when the last one goes. Bodies are immutable,
+ * so readers need no lock; the count only changes when a quiz is built or destroyed.
+ *
+ * Thread safety: `acquire`, `release`, `load` and `drop_unused` are serialised by one mutex. Quizzes are created and deleted rarely, and
+ * reading a body's text takes no lock.
+ */
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include "HashStorage.hpp"
+#include "JsonFile.hpp"
+#include "MemoryUsage.hpp"
+#include "json.hpp"
+
+// One distinct question: its text and options in one immutable block, shared by every quiz that uses it
+class question_body {
+    friend class question_store;
+
+    struct option_record {
+        uint32_t text_offset;
+        uint32_t text_length;
+    };
+
+    uint64_t content_id;
+    uint32_t refs=0;    // Quizzes using this body; guarded by the store's mutex
+    uint32_t text_length;
+    uint32_t options;
+    // Followed in the same allocation by `options` option records and then the text pool (question text first)
+
+    question_body(uint64_t theid, uint32_t thetext_length, uint32_t theoptions): content_id(theid), text_length(thetext_length), options(theoptions){}
+
+    const option_record* option_records() const { return reinterpret_cast<const option_record*>(this+1); }
+    const char* pool() const { return reinterpret_cast<const char*>(option_records()+options); }
+
+    // Builds a body in one allocation. `option(j)` gives the text of option `j` of `option_count`.
+    template<typename Option>
+    static question_body* create(uint64_t id, std::string_view text, size_t option_count, Option option){
+        size_t chars=text.size();
+        for(size_t j=0;j<option_count;j++) chars+=option(j).size();
+        if(option_count>UINT32_MAX || chars>UINT32_MAX){
+            throw std::length_error("question_body: question too large");
+        }
+        void* memory=::operator new(sizeof(question_body)+option_count*sizeof(option_record)+chars);
+        question_body* body=new(memory) question_body(id, static_cast<uint32_t>(text.size()), static_cast<uint32_t>(option_count));
+        option_record* records=reinterpret_cast<option_record*>(body+1);
+        char* text_pool=reinterpret_cast<char*>(records+option_count);
+        if(!text.empty()) std::memcpy(text_pool, text.data(), text.size());
+        uint32_t next_char=static_cast<uint32_t>(text.size());
+        for(size_t j=0;j<option_count;j++){
+            std::string_view o=option(j);
+            if(!o.empty()) std::memcpy(text_pool+next_char, o.data(), o.size());
+            new(records+j) option_record{next_char, static_cast<uint32_t>(o.size())};
+            next_char+=static_cast<uint32_t>(o.size());
+        }
+        return body;
+    }
+
+    static void destroy(question_body* body){
+        body->~question_body();
+        ::operator delete(body);
+    }
+
+    template<typename Option>
+    bool same_content(std::string_view text, size_t option_count, Option option) const {
+        if(text!=this->text() || option_count!=options) return false;
+        for(size_t j=0;j<option_count;j++){
+            if(option(j)!=this->option(j)) return false;
+        }
+        return true;
+    }
+
+public:
+    uint64_t id() const { return content_id; }
+    std::string_view text() const { return std::string_view(pool(), text_length); }
+    size_t option_count() const { return options; }
+
+    std::string_view option(size_t j) const {
+        const option_record& o=option_records()[j];
+        return std::string_view(pool()+o.text_offset, o.text_length);
+    }
+
+    // The text form of an ID, as stored in the JSON files: 16 hex digits
+    static std::string id_text(uint64_t id){
+        static const char digits[]="0123456789abcdef";
+        std::string text(16, '0');
+        for(int i=15;i>=0;i--, id>>=4) text[i]=digits[id&15];
+        return text;
+    }
+
+    static bool parse_id(std::string_view text, uint64_t& id){
+        auto [end, error]=std::from_chars(text.data(), text.data()+text.size(), id, 16);
+        return error==std::errc() && end==text.data()+text.size();
+    }
+};
+
+class question_store {
+    table_storage<question_body*> bodies;   // Indexed by ID
+    std::mutex store_mutex;     // Serialises every change to the index and the reference counts
+
+    static uint32_t bucket_hash(uint64_t id){ return static_cast<uint32_t>(id^(id>>32)); }
+
+    // 64-bit FNV-1a of the text and options, each preceded by its length so ("ab", "c") and ("a", "bc") differ
+    template<typename Option>
+    static uint64_t content_hash(std::string_view text, size_t option_count, Option option){
+        uint64_t hash=1469598103934665603ull;
+        auto mix=[&hash](std::string_view s){
+            uint64_t length=s.size();
+            for(int i=0;i<8;i++, length>>=8){
+                hash^=length&0xff;
+                hash*=1099511628211ull;
+            }
+            for(unsigned char c:s){
+                hash^=c;
+                hash*=1099511628211ull;
+            }
+        };
+        mix(text);
+        for(size_t j=0;j<option_count;j++) mix(option(j));
+        return hash;
+    }
+
+    question_body* lookup(uint64_t id){
+        question_body* found=nullptr;
+        bodies.find(bucket_hash(id), [id](question_body* body){ return body->content_id==id; }, found);
+        return found;
+    }
+
+    void remove(question_body* body){
+        question_body* removed=nullptr;
+        bodies.erase(bucket_hash(body->content_id), [body](question_body* other){ return other==body; }, removed);
+        question_body::destroy(body);
+    }
+
+public:
+    static question_store& instance(){
+        static question_store store;
+        return store;
+    }
+
+    question_store(): bodies(256){}
+
+    question_store(const question_store&) = delete;
+    question_store& operator=(const question_store&) = delete;
+
+    ~question_store(){
+        bodies.for_each([](question_body* body){ question_body::destroy(body); });
+    }
+
+    size_t size() const { return bodies.size(); }
+
+    /*
+     * Returns the shared body with this text and these options, adding it if no quiz uses it yet, and counts one more user.
+     * `option(j)` gives the text of option `j`. Every `acquire` is matched by a `release`.
+     * Time Complexity: O(content length) average.
+     */
+    template<typename Option>
+    const question_body* acquire(std::string_view text, size_t option_count, Option option){
+        uint64_t id=content_hash(text, option_count, option);
+        std::lock_guard<std::mutex> guard(store_mutex);
+        // Probe from the hash upwards past bodies of other content that took the ID first
+        for(;;id++){
+            question_body* body=lookup(id);
+            if(!body) break;
+            if(body->same_content(text, option_count, option)){
+                body->refs++;
+                return body;
+            }
+        }
+        question_body* body=question_body::create(id, text, option_count, option);
+        body->refs=1;
+        bodies.insert(bucket_hash(id), body);
+        return body;
+    }
+
+    // Returns the body saved under `id` and counts one more user, or nullptr if there is none. O(1) average.
+    const question_body* acquire(uint64_t id){
+        std::lock_guard<std::mutex> guard(store_mutex);
+        question_body* body=lookup(id);
+        if(body) body->refs++;
+        return body;
+    }
+
+    // Counts one user fewer for each of `n` bodies and frees those no quiz uses any more. One lock for the whole quiz.
+    template<typename BodyAt>
+    void release(size_t n, BodyAt body_at){
+        std::lock_guard<std::mutex> guard(store_mutex);
+        for(size_t i=0;i<n;i++){
+            question_body* body=const_cast<question_body*>(body_at(i));
+            if(--body->refs==0) remove(body);
+        }
+    }
+
+    /*
+     * Adds the bodies saved in `path` ({"id", "questionText", "options"} objects), unused until quizzes acquire them by ID.
+     * IDs already present are skipped. A missing file is no error: a fresh install, or quizzes saved before the store existed.
+     */
+    void load(const char* path){
+        std::ifstream file(path);
+        if(!file.is_open()) return;
+        nlohmann::json saved;
+        file>>saved;
+        std::lock_guard<std::mutex> guard(store_mutex);
+        bodies.reserve(bodies.size()+saved.size());
+        for(const auto& entry:saved){
+            uint64_t id;
+            if(!question_body::parse_id(jsonText(entry.at("id")), id) || lookup(id)) continue;
+            const nlohmann::json& options=entry.at("options");
+            question_body* body=question_body::create(id, jsonText(entry.at("questionText")), options.size(),
+                                                      [&options](size_t j){ return jsonText(options[j]); });
+            bodies.insert(bucket_hash(id), body);
+        }
+    }
+
+    /*
+     * Writes `used` (the bodies referenced by a snapshot of the quizzes, duplicates allowed) to `path`. The caller keeps them
+     * alive: they belong to quizzes its read section can still see.
+     * Time Complexity: O(n log n) for n references, plus the text written.
+     */
+    static void save(const char* path, std::vector<const question_body*> used){
+        // Sorted by ID so unchanged bodies keep their place in the file
+        auto by_id=[](const question_body* a, const question_body* b){ return a->id()<b->id(); };
+        std::sort(used.begin(), used.end(), by_id);
+        used.erase(std::unique(used.begin(), used.end()), used.end());
+        nlohmann::json array=nlohmann::json::array();
+        for(const question_body* body:used){
+            nlohmann::json options=nlohmann::json::array();
+            for(size_t j=0;j<body->option_count();j++) options.push_back(std::string(body->option(j)));
+            array.push_back({
+                {"id", question_body::id_text(body->id())},
+                {"questionText", std::string(body->text())},
+                {"options", std::move(options)}
+            });
+        }
+        saveJsonFile(path, array);
+    }
+
+    // Frees the loaded bodies no quiz acquired, e.g. those left in the file by a quiz deleted before a crash
+    void drop_unused(){
+        std::lock_guard<std::mutex> guard(store_mutex);
+        std::vector<question_body*> unused;
+        bodies.for_each([&unused](question_body* body){ if(body->refs==0) unused.push_back(body); });
+        for(question_body* body:unused) remove(body);
+    }
+
+    /*
+     * Reports the bytes of the shared bodies (see `MemoryUsage.hpp`): each body's header as a record, its option table as a vector
+     * and its text pool as strings, plus the index.
+     * Time Complexity: O(n) in the number of distinct questions.
+     */
+    memory_usage memory(){
+        std::lock_guard<std::mutex> guard(store_mutex);
+        memory_usage usage;
+        usage.entities=bodies.size();
+        usage.nodes=bodies.memory_bytes();
+        bodies.for_each([&usage](question_body* body){
+            usage.records+=sizeof(question_body);
+            usage.vectors+=body->options*sizeof(question_body::option_record);
+            usage.strings+=body->text_length;
+            for(size_t j=0;j<body->options;j++) usage.strings+=body->option_records()[j].text_length;
+        });
+        return usage;
+    }
+};
+
+#endif
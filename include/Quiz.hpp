@@ -5,26 +5,41 @@
  * Description: This header defines the data structures for Quizzes and Questions, and the hash table (`quiz_hashTable`) to manage them.
  *
  * DSA Concepts:
- * 1.  **Hash Table:** `quiz_hashTable` maps a unique `quizId` (string) to the corresponding `quiz_data`. This allows for O(1) average-case lookup when a student attempts a quiz or a teacher views its results.
+ * 1.  **Hash Table:** `quiz_hashTable` maps a unique `quizId` (an `entity_id`, see `EntityId.hpp`) to the corresponding `quiz_data`. This allows for O(1) average-case lookup when a student attempts a quiz or a teacher views its results.
  * 2.  **Separate Chaining:** Collisions are handled using a linked list (`quiz_link`).
- * 3.  **Hash Function:** The `fnv1a` function is used for hashing the `quizId`.
- * 4.  **Structs & Vectors:** `quiz_data` and `Question` structs use `std::vector` to store a dynamic list of questions and options.
+ * 3.  **Read-Copy-Update:** Quizzes are read on every dashboard and leaderboard but written a few hundred times a day, so the table uses
+ * `quiz_storage`: by default the lock-free `rcu_storage` (see `RcuStorage.hpp`), or with `EDUMAZE_PERFECT_QUIZZES` a minimal perfect
+ * hash rebuilt in the background after each batch of writes, so a lookup is one probe (see `PerfectHashStorage.hpp`).
+ * 4.  **Hash Function:** The `quizId` is stored as its base-36 integer and hashed with `entity_id::hash`, so a lookup is an integer mix and compare.
+ * 5.  **Content-Addressed Questions:** A quiz's questions are one immutable array of fixed-size records (`quiz_questions`, see
+ * `QuizQuestions.hpp`) that point at shared question bodies in the `question_store` (see `QuestionStore.hpp`), keyed by a hash
+ * of their text and options. A question reused across quizzes is held, and saved, once. `Question` is only the form in which a
+ * teacher's new quiz is parsed before it is built.
+ * 6.  **Slab Allocation:** `quiz_data` records are created in the `slab_pool` of the underlying `EntityTable` (see `EntityTable.hpp`)
+ * and freed in bulk.
+ * 7.  **Ordered Index:** `by_title` is a B+ tree of the quizzes ordered by (classroom, title, quiz ID) (see `BPlusTree.hpp`), so a
+ * classroom's quizzes are one contiguous range of it, listed in title order a page at a time (`quizzesByTitle`).
  */
 
-#include "crow.h"
-#include "crow/middlewares/cookie_parser.h"
-#include "crow/middlewares/session.h"
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <fstream>
 #include <random>
 #include <sstream>
 #include "json.hpp"
+#include <mutex>
+#include "EntityTable.hpp"
+#include "PerfectHashStorage.hpp"
+#include "EntityId.hpp"
+#include "JsonFile.hpp"
+#include "QuizQuestions.hpp"
+#include "BPlusTree.hpp"
 
 using njson=nlohmann::json;
 
-// Represents a single MCQ question
+// A single MCQ question as parsed from the create-quiz form; stored quizzes hold their questions as a `quiz_questions` block
 struct Question{
     std::string questionText;
     std::vector<std::string> options;
@@ -33,24 +48,21 @@ struct Question{
 
 // Represents a full quiz
 struct quiz_data{
-    std::string quizId; // The primary key for the hash table
+    entity_id quizId; // The primary key for the hash table
     std::string quizTitle;
-    std::string classroomId;    // Links this quiz to a classroom
+    entity_id classroomId;    // Links this quiz to a classroom
     int timeLimitMins;  // Time limit for the attempt
-    std::vector<Question> questions;    // All questions for this quiz
+    quiz_questions questions;    // All questions for this quiz, in one immutable block
 
     quiz_data() = default;
 
-    quiz_data(const std::string& thequizId, const std::string& thequizTitle, const std::string& theclassroomId, int thetimeLimitMins, const std::vector<Question>& thequestions):
-    quizId(thequizId), quizTitle(thequizTitle), classroomId(theclassroomId), timeLimitMins(thetimeLimitMins), questions(thequestions){}
+    quiz_data(entity_id thequizId, std::string thequizTitle, entity_id theclassroomId, int thetimeLimitMins, quiz_questions&& thequestions):
+    quizId(thequizId), quizTitle(std::move(thequizTitle)), classroomId(theclassroomId), timeLimitMins(thetimeLimitMins), questions(std::move(thequestions)){}
 
 };
 
 // Linked list node for the quiz hash table (separate chaining)
-struct quiz_link{
-    quiz_data* data=nullptr;
-    quiz_link* next=nullptr;
-};
+using quiz_link = hash_link<quiz_data*>;
 
 void to_json(njson& j, const Question& q);
 
@@ -61,127 +73,122 @@ void to_json(njson& j, const quiz_data& q);
 void from_json(const njson& j, quiz_data& q);
 
 
-// Implements a hash table to store all quiz data.
-// The key is the `quizId`
-class quiz_hashTable {
-private:
-    quiz_link** quizzes;
-    int size;
-
-    // FNV-1a hash function
-    uint32_t fnv1a(const std::string& s) {
-        const uint32_t basis = 2166136261u;
-        const uint32_t prime = 16777619u;
-        uint32_t hash = basis;
-        for (unsigned char c : s) {
-            hash ^= c;
-            hash *= prime;
-        }
-        return hash;
-    }
-    
-    // Generates a random 6-character ID for the quiz
-    std::string generate_quiz_id() {
-        const std::string chars = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-        std::random_device rd;
-        std::mt19937 generator(rd());
-        std::uniform_int_distribution<> distribution(0, chars.size() - 1);
-        
-        std::stringstream ss;
-        for (int i = 0; i < 6; ++i) {
-            ss << chars[distribution(generator)];
-        }
-        return ss.str();
-    }
+// The quiz table is keyed by the quiz ID
+inline entity_id entity_key(const quiz_data& q) { return q.quizId; }
 
-    // Loads quiz data from JSON file and populates the hash table
-    void makeQuizzes_hashtable(int& table_size, std::ifstream& file) {
-        njson data;
+// Heap bytes a quiz owns (see `EntityTable::memory`): its title and question records. The shared question bodies are reported by
+// the question store. Neither field changes once the quiz is built, so no lock is needed.
+inline void entity_memory(const quiz_data& q, memory_usage& usage) {
+    usage.strings += heap_bytes(q.quizTitle);
+    usage.vectors += q.questions.heap_bytes();
+}
 
-        file>>data;
-        for (const auto& quiz_json : data) {
-            // 1. Deserialize JSON into quiz_data object
-            // This uses the from_json functions
-            quiz_data temp_quiz;
+// A place in the (classroom, title, quiz ID) order of `quiz_hashTable::by_title`: a quiz's own, or a cursor between pages
+struct quiz_position {
+    entity_id classroomId;
+    std::string_view title;
+    entity_id quizId;
 
-            temp_quiz.quizId = quiz_json.value("quizId", "");
-            temp_quiz.quizTitle = quiz_json.value("quizTitle", "");
-            temp_quiz.classroomId = quiz_json.value("classroomId", "");
-            temp_quiz.timeLimitMins = quiz_json.value("timeLimitMinutes", 0);
-            temp_quiz.questions = quiz_json.value("questions", std::vector<Question>{});
+    static quiz_position of(const quiz_data& q) { return quiz_position{q.classroomId, q.quizTitle, q.quizId}; }
+
+    bool operator<(const quiz_position& other) const {
+        if (classroomId.value != other.classroomId.value) return classroomId.value < other.classroomId.value;
+        if (title != other.title) return title < other.title;
+        return quizId.value < other.quizId.value;
+    }
+};
 
-            // 2. Create the data object on the heap
-            quiz_data* new_quiz = new quiz_data(temp_quiz);
+// Orders quizzes by classroom, then title, then ID. None of the three changes once a quiz is created.
+struct quiz_title_order {
+    bool operator()(const quiz_data* a, const quiz_data* b) const { return quiz_position::of(*a) < quiz_position::of(*b); }
+    bool operator()(const quiz_data* a, const quiz_position& b) const { return quiz_position::of(*a) < b; }
+    bool operator()(const quiz_position& a, const quiz_data* b) const { return a < quiz_position::of(*b); }
+};
 
-            // 3. Hash the key (quizId)
-            uint32_t index = fnv1a(new_quiz->quizId) % table_size;
+// File format of the quiz table (see `json_file_persist`). The question texts are kept in a side file, `questions_path`,
+// which quizzes.json refers into by question ID (see `QuestionStore.hpp`).
+struct quiz_file : json_file_format {
+    static constexpr const char* path = "Data/quizzes.json";
+    static constexpr const char* questions_path = "Data/questions.json";
+    static constexpr bool required = false;
 
-            // 4. Insert into hash table (add to front of list)
-            quiz_link* newnode = new quiz_link;
-            newnode->data=new_quiz;
-            if (quizzes[index]) {
-                newnode->next = quizzes[index];
-                quizzes[index]=newnode;
-            }
-            else{
-                quizzes[index] = newnode;
+    // The saved question bodies must be in the store before quizzes acquire them by ID
+    static void before_load() {
+        question_store::instance().load(questions_path);
+    }
+
+    static void after_load() {
+        question_store::instance().drop_unused();
+    }
+
+    // Writes the bodies the snapshot uses before quizzes.json itself, so the quiz file never refers to a question missing from
+    // the question file, even if the process stops between the two writes
+    static void before_write(const std::vector<quiz_data*>& quizzes) {
+        std::vector<const question_body*> used;
+        for (quiz_data* quiz : quizzes) {
+            for (quiz_questions::question_view q : quiz->questions) {
+                used.push_back(&q.body());
             }
         }
+        question_store::save(questions_path, std::move(used));
     }
 
-public:
-    // Constructor: Initializes and populates the hash table
-    quiz_hashTable() {
-        size = 50;
-        quizzes  = new quiz_link*[size];
+    template<typename Table>
+    static void read(Table& table, njson& quiz_json) {
+        // The questions are built straight from the JSON array (shared bodies acquired by ID, or from inline text), and moved
+        // into the record created in the record pool under its quizId, together with the title taken out of the element
+        auto questions = quiz_json.find("questions");
+        table.emplace(quiz_json.value("quizId", entity_id()),
+                      takeText(quiz_json, "quizTitle"),
+                      quiz_json.value("classroomId", entity_id()),
+                      quiz_json.value("timeLimitMinutes", 0),
+                      questions != quiz_json.end() ? quiz_questions::from_json(*questions) : quiz_questions());
+    }
+};
 
-        for(int i=0; i<size; i++){
-            quizzes[i]=nullptr;
-        }
-        std::ifstream quizFile("Data/quizzes.json");
-        if (quizFile.is_open()) {
-            makeQuizzes_hashtable(size, quizFile);
-        } else {
-            std::ofstream newFile("Data/quizzes.json");
-            newFile << "[]";
-            newFile.close();
+// Implements a hash table to store all quiz data.
+// The key is the `quizId`
+class quiz_hashTable {
+private:
+    // Lock-free lookups in the default (RCU) build
+    EntityTable<entity_id, quiz_data, entity_id_hash, quiz_storage, json_file_persist<quiz_file>> quizzes;
+    ordered_index<quiz_data*, quiz_title_order> by_title;   // Every quiz, by classroom and title
+
+    // Generates a random quiz ID (six base-36 characters, held as their integer value)
+    entity_id generate_quiz_id() {
+        std::random_device rd;
+        std::mt19937 generator(rd());
+        return entity_id::random(generator);
+    }
+
+public:
+    // Constructor: Initializes and populates the hash table (or creates an empty quizzes.json), then indexes the quizzes by title
+    quiz_hashTable(): quizzes(50) {
+        // Collected first: the index is never updated under the table's storage locks (see `ordered_index`)
+        std::vector<quiz_data*> loaded;
+        quizzes.for_each([&loaded](quiz_data* quiz) { loaded.push_back(quiz); });
+        for (quiz_data* quiz : loaded) {
+            by_title.insert(quiz);
         }
     }
 
     // Saves all quiz data back to the JSON file
     void saveQuizzesToFile() {
-        njson quizzes_json_array = njson::array();
-        for (int i = 0; i < size; ++i) {
-            quiz_link* curr = quizzes[i];
-            while (curr != nullptr) {
-                quizzes_json_array.push_back(*(curr->data));
-                curr = curr->next;
-            }
-        }
-        std::ofstream quizFile("Data/quizzes.json");
-        quizFile << quizzes_json_array.dump(4);
-        quizFile.close();
+        quizzes.save();
     }
 
     /*
-     * Creates a new quiz, adds it to the hash table, and returns its data.
-     * Time Complexity: O(1) average.
+     * Creates a new quiz, adds it to the hash table, and returns its data. The questions are built into the quiz's block once;
+     * the record takes the block and the title over without copying them.
+     * Time Complexity: O(1) average, plus O(total text length) to build the block and O(log n) to index the title.
      */
-    quiz_data* createQuiz(const std::string& title, const std::string& classroomId, int timeLimit, const std::vector<Question>& questions) {
-        std::string id = generate_quiz_id();
-        uint32_t index = fnv1a(id) % size;
-
-        quiz_data* new_quiz_data  = new quiz_data(id, title, classroomId, timeLimit, questions);
-        quiz_link* newnode = new quiz_link;
-        newnode->data=new_quiz_data;
-
-        // Insert at the head of the linked list
-        if (quizzes[index]) {
-            newnode->next = quizzes[index];
-        }
-        quizzes[index] = newnode;
-
-        return new_quiz_data;
+    quiz_data* createQuiz(std::string title, entity_id classroomId, int timeLimit, const std::vector<Question>& questions) {
+        // An ID already in use is caught by the atomic check-and-insert, which gives the quiz another one
+        quiz_data* quiz = quizzes.emplace_unique([this](quiz_data& taken) { taken.quizId = generate_quiz_id(); },
+                                                 generate_quiz_id(), std::move(title), classroomId, timeLimit, quiz_questions::from_questions(questions));
+        // Unless a concurrent delete has already taken it out again
+        by_title.insert_if(quiz, [this, quiz] { return quizzes.find(quiz->quizId) == quiz; });
+        return quiz;
     }
 
     /*
@@ -190,36 +197,74 @@ public:
      * - Average: O(1).
      * - Worst: O(n), where n is the total number of quizzes.
      */
-    quiz_data* findQuiz(const std::string& quizId) {
-        uint32_t index = fnv1a(quizId) % size;
-        quiz_link* node = quizzes[index];
-        while (node) {
-            if (node->data->quizId  == quizId) return node->data;
-            node = node->next;
+    quiz_data* findQuiz(entity_id quizId) {
+        return quizzes.find(quizId);
+    }
+
+    // Finds a quiz by the text of its ID (from a URL or a form). Malformed IDs are never found.
+    quiz_data* findQuiz(std::string_view quizId) {
+        entity_id id = entity_id::from_string(quizId);
+        return id.valid() ? findQuiz(id) : nullptr;
+    }
+
+    /*
+     * Finds a batch of quizzes (e.g. a classroom's `quizIds`): entry `i` is the quiz of `quizIds[i]`, or nullptr.
+     * Time Complexity: O(n) average, with the cache misses of different quizzes overlapping.
+     */
+    std::vector<quiz_data*> findQuizzes(const std::vector<entity_id>& quizIds) {
+        return quizzes.find_many(quizIds);
+    }
+
+    /*
+     * Finds a page of a classroom's quizzes in title order: up to `limit` quizzes after the cursor `after` (see `quizCursor`;
+     * empty, or not a cursor, for the first page). `more` is set if the classroom has quizzes after the page.
+     * Time Complexity: O(log n + limit), for n quizzes in the system.
+     */
+    std::vector<quiz_data*> quizzesByTitle(entity_id classroomId, std::string_view after, size_t limit, bool& more) {
+        auto in_classroom = [classroomId](const quiz_data* quiz) { return quiz->classroomId == classroomId; };
+        entity_id afterId = after.size() >= 6 ? entity_id::from_string(after.substr(0, 6)) : entity_id();
+        if (!afterId.valid()) {
+            return by_title.page_from(quiz_position{classroomId, std::string_view(), entity_id(0)}, limit, in_classroom, more);
         }
-        return nullptr;
+        return by_title.page_after(quiz_position{classroomId, after.substr(6), afterId}, limit, in_classroom, more);
     }
 
-    // Destructor: Saves data and deallocates all memory
-    ~quiz_hashTable() {
-        std::cout << "Saving quiz data to file..." << std::endl;
+    // The cursor for the page after `quiz` in `quizzesByTitle`: its six-character ID followed by its title
+    static std::string quizCursor(const quiz_data& quiz) {
+        return quiz.quizId.to_string() + quiz.quizTitle;
+    }
 
-        njson quizzes_json_array = njson::array();
-        for (int i = 0; i < size; ++i) {
-            quiz_link* curr = quizzes[i];
-            while (curr != nullptr) {
-                quizzes_json_array.push_back(*(curr->data));
-                quiz_link* next = curr->next;
-                delete curr->data;
-                delete curr;
-                curr = next;
-            }
+    /*
+     * Removes a quiz. Returns false if it is already gone. The caller takes it out of its classroom's `quizIds`.
+     * Time Complexity: O(log n) average; O(n) with `EDUMAZE_PERFECT_QUIZZES`, whose perfect hash is rebuilt without it.
+     */
+    bool removeQuiz(entity_id quizId) {
+        // Keeps the record alive while its title is compared on its way out of the index, even outside a request
+        epoch_guard read_section;
+        quiz_data* quiz = quizzes.find(quizId);
+        if (!quiz) {
+            return false;
         }
-        std::ofstream quizFile("Data/quizzes.json");
-        quizFile << quizzes_json_array.dump(4);
-        quizFile.close();
+        return by_title.erase_with(quiz, [this, quizId] { return quizzes.erase(quizId); });
+    }
+
+    // Bytes held by the quiz table, for the memory report (see `MemoryUsage.hpp`). O(n).
+    memory_usage memoryUsage() {
+        memory_usage usage = quizzes.memory();
+        usage.nodes += by_title.memory_bytes();
+        return usage;
+    }
+
+    // Bytes held by the shared question bodies. O(n) in the number of distinct questions.
+    memory_usage questionMemoryUsage() {
+        return question_store::instance().memory();
+    }
 
-        delete[] quizzes;
+    // Destructor: Saves data and deallocates all memory
+    ~quiz_hashTable() {
+        std::cout << "Saving quiz data to file..." << std::endl;
+        saveQuizzesToFile();
+        // The table destructs its own records
     }
 };
 
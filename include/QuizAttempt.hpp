@@ -5,9 +5,11 @@
  * Description: This header defines the data structure for a student's quiz result/attempt (`quiz_result_data`) and the hash table (`quiz_result_hashTable`) to manage all results.
  *
  * DSA Concepts:
- * 1.  **Hash Table:** `quiz_result_hashTable` maps a unique `resultId` (string) to the `quiz_result_data`.
- * 2.  **Separate Chaining:** Collisions are handled with `quiz_result_link`.
- * 3.  **Hash Function:** `fnv1a` is used to hash the `resultId`.
+ * 1.  **Hash Table:** `quiz_result_hashTable` maps a unique `resultId` (an `entity_id`, see `EntityId.hpp`) to the `quiz_result_data`.
+ * 2.  **Separate Chaining:** Collisions are handled with `quiz_result_link`. The bucket array (`table_storage`) grows incrementally with the load factor.
+ * 3.  **Hash Function:** The `resultId` is stored as its base-36 integer and hashed with `entity_id::hash`.
+ * 4.  **Slab Allocation:** `quiz_result_data` records are created in the `slab_pool` of the underlying `EntityTable` (see
+ * `EntityTable.hpp`) and freed in bulk.
  *
  * DSA Note on Lookups:
  * This implementation uses `resultId` as the primary key. This is O(1) for adding a new result.
@@ -15,37 +17,40 @@
  (`findResultsForQuiz`) or checking if a *student has attempted* a quiz (`hasStudentAttempted`) requires iterating over the *entire hash table* (all buckets and all chains). This is an O(N) operation, where N is the total number of results in the system.
  */
 
-#include "crow.h"
 #include "json.hpp"
+#include <algorithm>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <fstream>
 #include <sstream>
 #include <random>
 #include <iostream>
+#include <mutex>
+#include "EntityTable.hpp"
+#include "EntityId.hpp"
+#include "SymbolTable.hpp"
+#include "JsonFile.hpp"
 
 using njson=nlohmann::json;
 
 // Struct to represent a single completed quiz attempt by a student
 struct quiz_result_data{
-    std::string resultId;   // Primary key for the hash table
-    std::string quizId; // Foreign key to the quiz
-    std::string studentUsername;
+    entity_id resultId;   // Primary key for the hash table
+    entity_id quizId; // Foreign key to the quiz
+    symbol_id studentUsername;  // Interned
     int score;  // Foreign key to the student
     double timeTakenSeconds;
     std::vector<int> submittedAnswers;   // Index=Q#, Value=Option# (-1 if unanswered)
 
     quiz_result_data(): score(0), timeTakenSeconds(0.0){}
 
-    quiz_result_data(const std::string& resId, const std::string& qId, const std::string& sUsername, int s, double t, const std::vector<int>& answers):
-    resultId(resId), quizId(qId), studentUsername(sUsername), score(s), timeTakenSeconds(t), submittedAnswers(answers){}
+    quiz_result_data(entity_id resId, entity_id qId, symbol_id sUsername, int s, double t, std::vector<int> answers):
+    resultId(resId), quizId(qId), studentUsername(sUsername), score(s), timeTakenSeconds(t), submittedAnswers(std::move(answers)){}
 };
 
 // Linked list node for the quiz result hash table
-struct quiz_result_link{
-    quiz_result_data* data=nullptr;
-    quiz_result_link* next=nullptr;
-};
+using quiz_result_link = hash_link<quiz_result_data*>;
 
 // JSON serialization for quiz_result_data
 inline void to_json(njson& j, const quiz_result_data& r){
@@ -61,145 +66,79 @@ inline void to_json(njson& j, const quiz_result_data& r){
 
 // JSON deserialization for quiz_result_data
 inline void from_json(const njson& j, quiz_result_data& r){
-    r.resultId = j.value("resultId", "");
-    r.quizId = j.value("quizId", "");
-    r.studentUsername = j.value("studentUsername", "");
+    r.resultId = j.value("resultId", entity_id());
+    r.quizId = j.value("quizId", entity_id());
+    r.studentUsername = j.value("studentUsername", symbol_id());
     r.score = j.value("score", 0);
     r.timeTakenSeconds = j.value("timeTakenSeconds", 0.0);
     r.submittedAnswers = j.value("submittedAnswers", std::vector<int>{});
 }
 
-// Implements a hash table to store all quiz attempts.
-// The key is the `resultId`.
-class quiz_result_hashTable{
-private:
-    quiz_result_link** quiz_results;
-    int size;
-
-    // FNV-1a hash function
-    uint32_t fnv1a(const std::string& s) {
-        const uint32_t basis = 2166136261u;
-        const uint32_t prime = 16777619u;
-        uint32_t hash = basis;
-        for (unsigned char c : s) {
-            hash ^= c;
-            hash *= prime;
-        }
-        return hash;
-    }
-    
-    // Generates a random 6-character ID for the result
-    std::string generate_result_id() {
-        const std::string chars = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-        std::random_device rd;
-        std::mt19937 generator(rd());
-        std::uniform_int_distribution<> distribution(0, chars.size() - 1);
-        
-        std::stringstream ss;
-        for (int i = 0; i < 6; ++i) {
-            ss << chars[distribution(generator)];
-        }
-        return ss.str();
-    }
+// The result table is keyed by the result ID
+inline entity_id entity_key(const quiz_result_data& r){ return r.resultId; }
 
-    // Loads result data from JSON file and populates the hash table
-    void makeResults_hashtable(int& table_size, std::ifstream& file){
-        njson data;
+// Heap bytes a result owns (see `EntityTable::memory`): the submitted answers, which never change once it is added
+inline void entity_memory(const quiz_result_data& r, memory_usage& usage){
+    usage.vectors+=heap_bytes(r.submittedAnswers);
+}
 
-        file>>data;
-        for (const auto& res_json : data) {
-            // 1. Deserialize JSON into object
-            quiz_result_data temp_res;
-            from_json(res_json, temp_res);
+// File format of the result table (see `json_file_persist`)
+struct quiz_result_file : json_file_format {
+    static constexpr const char* path = "Data/quiz_results.json";
+    static constexpr bool required = false;
 
-            // 2. Create heap-allocated object
-            quiz_result_data* new_result=new quiz_result_data(temp_res);
+    template<typename Table>
+    static void read(Table& table, njson& res_json){
+        // 1. Deserialize JSON into object
+        quiz_result_data temp_res;
+        from_json(res_json, temp_res);
 
-            // 3. Hash the key (resultId)
-            uint32_t index = fnv1a(new_result->resultId) % table_size;
+        // 2. Move the object into the record pool and insert it under its resultId
+        table.emplace(std::move(temp_res));
+    }
+};
 
-            // 4. Insert into hash table
-            quiz_result_link* newnode=new quiz_result_link;
-            newnode->data=new_result;
+// Implements a hash table to store all quiz attempts.
+// The key is the `resultId`.
+class quiz_result_hashTable{
+private:
+    EntityTable<entity_id, quiz_result_data, entity_id_hash, table_storage, json_file_persist<quiz_result_file>> quiz_results;
 
-            if (quiz_results[index]) {
-                newnode->next = quiz_results[index];
-                quiz_results[index] = newnode;
-            } else {
-                quiz_results[index] = newnode;
-            }
-        }
+    // Generates a random result ID (six base-36 characters, held as their integer value)
+    entity_id generate_result_id() {
+        std::random_device rd;
+        std::mt19937 generator(rd());
+        return entity_id::random(generator);
     }
 
 public:
-    // Constructor: Initializes and populates the hash table
-    quiz_result_hashTable(int table_size=50): size(table_size){
-        quiz_results=new quiz_result_link*[size];
-        for(int i=0; i<size; i++){
-            quiz_results[i]=nullptr;
-        }
-
-        std::ifstream resultsFile("Data/quiz_results.json");
-        if (resultsFile.is_open()) {
-            makeResults_hashtable(size, resultsFile);
-            resultsFile.close();
-        } else {
-            std::ofstream newFile("Data/quiz_results.json");
-            newFile << "[]";
-            newFile.close();
-        }
-    }
+    // Constructor: Initializes and populates the hash table (or creates an empty quiz_results.json)
+    quiz_result_hashTable(int table_size=50): quiz_results(table_size){}
 
-    // Destructor: Saves data and deallocates memory
+    // Destructor: Saves data. The table destructs its own records.
     ~quiz_result_hashTable() {
         std::cout << "Saving quiz results to file..." << std::endl;
         saveResultsToFile();    // Save one last time
-        for (int i = 0; i < size; ++i) {
-            quiz_result_link* curr = quiz_results[i];
-            while (curr != nullptr) {
-                quiz_result_link* next = curr->next;
-                delete curr->data;
-                delete curr;
-                curr = next;
-            }
-        }
-        delete[] quiz_results;
     }
 
-    // Saves all quiz result data back to the JSON file
+    // Saves all quiz result data back to the JSON file.
     void saveResultsToFile() {
-        njson results_json_array = njson::array();
-        for (int i = 0; i < size; ++i) {
-            quiz_result_link* curr = quiz_results[i];
-            while (curr != nullptr) {
-                results_json_array.push_back(*(curr->data));
-                curr = curr->next;
-            }
-        }
-        std::ofstream resultsFile("Data/quiz_results.json");
-        resultsFile << results_json_array.dump(4);
-        resultsFile.close();
+        quiz_results.save();
     }
 
     /*
-     * Adds a new quiz result to the hash table.
+     * Adds a new quiz result to the hash table. The answers are moved into the record.
      * Time Complexity: O(1) average.
      */
-    quiz_result_data* addResult(const std::string& quizId, const std::string& studentUsername, int score, double timeTaken, const std::vector<int>& answers) {
-        std::string resId = generate_result_id();
-        quiz_result_data* new_result = new quiz_result_data(resId, quizId, studentUsername, score, timeTaken, answers);
-
-        uint32_t index = fnv1a(resId) % size;
-        quiz_result_link* newnode = new quiz_result_link;
-        newnode->data = new_result;
-
-        // Insert at the head of the list
-        if (quiz_results[index]) {
-            newnode->next = quiz_results[index];
-        }
-        quiz_results[index] = newnode;
+    quiz_result_data* addResult(entity_id quizId, symbol_id studentUsername, int score, double timeTaken, std::vector<int> answers) {
+        // An ID already in use is caught by the atomic check-and-insert, which gives the result another one
+        return quiz_results.emplace_unique([this](quiz_result_data& taken) { taken.resultId = generate_result_id(); },
+                                           generate_result_id(), quizId, studentUsername, score, timeTaken, std::move(answers));
+    }
 
-        return new_result;
+    // Same, for a username as it arrives from the session
+    quiz_result_data* addResult(entity_id quizId, std::string_view studentUsername, int score, double timeTaken, std::vector<int> answers) {
+        return addResult(quizId, symbol_table::instance().intern(studentUsername), score, timeTaken, std::move(answers));
     }
 
     /*
@@ -208,38 +147,78 @@ public:
      * in the system. This function must iterate through every single bucket
      * and every single node in the hash table to find matches.
      */
-    std::vector<quiz_result_data*> findResultsForQuiz(const std::string& quizId) {
+    std::vector<quiz_result_data*> findResultsForQuiz(entity_id quizId) {
         std::vector<quiz_result_data*> quiz_attempts;
-        // Iterate over the array
-        for (int i = 0; i < size; ++i) {
-            quiz_result_link* curr = quiz_results[i];
-            // Iterate over the linked list at this index
-            while (curr != nullptr) {
-                if (curr->data->quizId == quizId) {
-                    quiz_attempts.push_back(curr->data);
-                }
-                curr = curr->next;
+        // Iterate over every bucket and the linked list at each index
+        quiz_results.for_each([&](quiz_result_data* result) {
+            if (result->quizId == quizId) {
+                quiz_attempts.push_back(result);
             }
-        }
+        });
         return quiz_attempts;
     }
 
+    // Finds all results for a quiz given the text of its ID. Malformed IDs have no results.
+    std::vector<quiz_result_data*> findResultsForQuiz(std::string_view quizId) {
+        entity_id id = entity_id::from_string(quizId);
+        return id.valid() ? findResultsForQuiz(id) : std::vector<quiz_result_data*>{};
+    }
+
     /*
      * Checks if a specific student has already attempted a specific quiz.
      * Time Complexity: O(N), same as `findResultsForQuiz`. It must
      * iterate through the entire table to find a potential match.
      */
-    bool hasStudentAttempted(const std::string& studentUsername, const std::string& quizId) {
-        for (int i = 0; i < size; ++i) {
-            quiz_result_link* curr = quiz_results[i];
-            while (curr != nullptr) {
-                if (curr->data->studentUsername == studentUsername && curr->data->quizId == quizId) {
-                    return true;
-                }
-                curr = curr->next;
+    bool hasStudentAttempted(symbol_id studentUsername, entity_id quizId) {
+        return quiz_results.find_if([&](quiz_result_data* result) {
+            return result->studentUsername == studentUsername && result->quizId == quizId;
+        }) != nullptr;
+    }
+
+    // Same, for a username as it arrives from the session. A name that was never interned has no results.
+    bool hasStudentAttempted(std::string_view studentUsername, entity_id quizId) {
+        symbol_id student = symbol_table::instance().find(studentUsername);
+        return student.valid() && hasStudentAttempted(student, quizId);
+    }
+
+    /*
+     * Removes every result of the given (deleted) quizzes, e.g. all quizzes of a deleted classroom, and returns how many there were.
+     * Time Complexity: O(N * q) for one scan of all N results against the q quiz IDs, plus O(1) average per removed result.
+     */
+    size_t removeResultsForQuizzes(const std::vector<entity_id>& quizIds) {
+        std::vector<quiz_result_data*> attempts;
+        quiz_results.for_each([&](quiz_result_data* result) {
+            if (std::find(quizIds.begin(), quizIds.end(), result->quizId) != quizIds.end()) {
+                attempts.push_back(result);
+            }
+        });
+        return removeResults(attempts);
+    }
+
+    // Removes every result of a deleted student. O(N), like `findResultsForQuiz`.
+    size_t removeResultsForStudent(symbol_id studentUsername) {
+        std::vector<quiz_result_data*> attempts;
+        quiz_results.for_each([&](quiz_result_data* result) {
+            if (result->studentUsername == studentUsername) {
+                attempts.push_back(result);
             }
+        });
+        return removeResults(attempts);
+    }
+
+    // Bytes held by the result table, for the memory report (see `MemoryUsage.hpp`). O(n).
+    memory_usage memoryUsage() {
+        return quiz_results.memory();
+    }
+
+private:
+    // Erases the given results; ones already removed by a concurrent request are not counted
+    size_t removeResults(const std::vector<quiz_result_data*>& results) {
+        size_t removed = 0;
+        for (quiz_result_data* result : results) {
+            removed += quiz_results.erase(result->resultId);
         }
-        return false;
+        return removed;
     }
 };
 
@@ -0,0 +1,192 @@
+#ifndef QUIZ_QUESTIONS_HPP
+#define QUIZ_QUESTIONS_HPP
+
+/*
+ * Description: This header defines `quiz_questions`, the immutable storage of a quiz's questions. A quiz holds one array of
+ * fixed-size question records, built once when the quiz is created or loaded and never changed afterwards. Each record points at
+ * the shared, immutable `question_body` (text and options) in the `question_store` (see `QuestionStore.hpp`) and holds the quiz's
+ * own correct answer, so a question reused by many quizzes is stored once.
+ *
+ * DSA Concepts:
+ * 1.  **Fixed-Size Records:** Question `i` is element `i` of one array, so a quiz of 100 questions with four options each costs one
+ * allocation of its own instead of about 200 `std::string`s and vectors, and `attempt_quiz` and grading walk it with
+ * `std::string_view`s and no allocation.
+ * 2.  **Content-Addressed Sharing:** The text lives in the question store, keyed by a hash of the content; identical questions in
+ * different quizzes share one body, in memory and in `Data/questions.json`.
+ * 3.  **Immutability:** Nothing is written after the quiz is built, so any number of requests can read its questions at once
+ * without a lock.
+ *
+ * In `quizzes.json` a question is saved as {"questionId", "correctAnswerIndex"}. A quiz saved before the store existed, with
+ * the text inline ({"questionText", "options", "correctAnswerIndex"}), still loads; its questions join the store. The two files
+ * belong together: an ID that `questions.json` does not hold is a load error, so the server refuses to start rather than save
+ * the quizzes back without that question.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "json.hpp"
+#include "JsonFile.hpp"
+#include "QuestionStore.hpp"
+
+class quiz_questions {
+    struct question_record {
+        const question_body* body;  // Shared; one reference of the store's count is this record's
+        int32_t correct_answer;
+    };
+
+    std::unique_ptr<question_record[]> records;     // Null for a quiz without questions
+    size_t count=0;     // Records built so far; all of them once building finishes
+
+    void release(){
+        if(count) question_store::instance().release(count, [this](size_t i){ return records[i].body; });
+        records.reset();
+        count=0;
+    }
+
+    /*
+     * Builds the records for `n` questions. `saved(i, by_id)` sets `by_id` if question `i` refers to the store by ID and then
+     * returns the body it acquired (nullptr if the ID is unknown, which fails the build). Otherwise the body is acquired from
+     * the content `text(i)`, `option_count(i)` and `option(i, j)`. `correct(i)` is the quiz's answer to question `i`.
+     */
+    template<typename Saved, typename Text, typename OptionCount, typename Option, typename Correct>
+    static quiz_questions build(size_t n, Saved saved, Text text, OptionCount option_count, Option option, Correct correct){
+        quiz_questions built;
+        if(n==0) return built;
+        built.records.reset(new question_record[n]);
+        // If an acquire throws, the destructor releases the bodies acquired so far
+        for(size_t i=0;i<n;i++){
+            bool by_id=false;
+            const question_body* body=saved(i, by_id);
+            if(!by_id){
+                body=question_store::instance().acquire(text(i), option_count(i), [&option, i](size_t j){ return option(i, j); });
+            }
+            else if(!body){
+                // Skipping it would drop the question from quizzes.json at the next save, so loading stops instead
+                throw std::runtime_error("A quiz refers to a question missing from Data/questions.json; "
+                                         "restore that file from the same save as Data/quizzes.json");
+            }
+            built.records[built.count++]=question_record{body, static_cast<int32_t>(correct(i))};
+        }
+        return built;
+    }
+
+public:
+    // A read-only view of one question. Valid as long as the `quiz_questions` it came from.
+    class question_view {
+        const question_record* record;
+
+    public:
+        explicit question_view(const question_record* therecord): record(therecord){}
+
+        std::string_view text() const { return record->body->text(); }
+        size_t option_count() const { return record->body->option_count(); }
+        std::string_view option(size_t j) const { return record->body->option(j); }
+        int correct_answer() const { return record->correct_answer; }
+        const question_body& body() const { return *record->body; }
+    };
+
+    class iterator {
+        const question_record* record;
+
+    public:
+        explicit iterator(const question_record* therecord): record(therecord){}
+        question_view operator*() const { return question_view(record); }
+        iterator& operator++(){ record++; return *this; }
+        bool operator!=(const iterator& other) const { return record!=other.record; }
+    };
+
+    quiz_questions() = default;
+
+    quiz_questions(quiz_questions&& other) noexcept: records(std::move(other.records)), count(other.count){
+        other.count=0;
+    }
+
+    quiz_questions& operator=(quiz_questions&& other) noexcept {
+        if(this!=&other){
+            release();
+            records=std::move(other.records);
+            count=other.count;
+            other.count=0;
+        }
+        return *this;
+    }
+
+    // Gives the quiz's references back to the store, which frees the bodies no other quiz uses
+    ~quiz_questions(){
+        release();
+    }
+
+    /*
+     * Builds the questions from authored ones, e.g. the `Question`s parsed from the create-quiz form. `QuestionList` is any
+     * indexable list of objects with `questionText`, `options` and `correctAnswerIndex`.
+     * Time Complexity: O(total text length) average.
+     */
+    template<typename QuestionList>
+    static quiz_questions from_questions(const QuestionList& list){
+        return build(list.size(),
+            [](size_t, bool&) -> const question_body* { return nullptr; },
+            [&](size_t i){ return std::string_view(list[i].questionText); },
+            [&](size_t i){ return list[i].options.size(); },
+            [&](size_t i, size_t j){ return std::string_view(list[i].options[j]); },
+            [&](size_t i){ return list[i].correctAnswerIndex; });
+    }
+
+    /*
+     * Builds the questions from the "questions" array of a quiz in quizzes.json: by "questionId" from the store (loaded first, see
+     * `quiz_file`), or from inline text, read in place without a per-question copy. Missing inline fields read as they did for
+     * `Question`: empty text, no options, answer 0.
+     * Time Complexity: O(n) average by ID; O(total text length) inline.
+     */
+    static quiz_questions from_json(const nlohmann::json& list){
+        if(!list.is_array()) return quiz_questions();
+        auto text=[](const nlohmann::json& q, const char* key){
+            auto field=q.find(key);
+            return field!=q.end() ? jsonText(*field) : std::string_view();
+        };
+        auto options=[](const nlohmann::json& q) -> const nlohmann::json* {
+            auto field=q.find("options");
+            return field!=q.end() && field->is_array() ? &*field : nullptr;
+        };
+        return build(list.size(),
+            [&](size_t i, bool& by_id) -> const question_body* {
+                auto saved_id=list[i].find("questionId");
+                by_id=saved_id!=list[i].end();
+                uint64_t id;
+                if(!by_id || !question_body::parse_id(jsonText(*saved_id), id)) return nullptr;
+                return question_store::instance().acquire(id);
+            },
+            [&](size_t i){ return text(list[i], "questionText"); },
+            [&](size_t i){ const nlohmann::json* o=options(list[i]); return o ? o->size() : 0; },
+            [&](size_t i, size_t j){ return jsonText((*options(list[i]))[j]); },
+            [&](size_t i){ return list[i].value("correctAnswerIndex", 0); });
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count==0; }
+
+    // Heap bytes of the record array; the bodies belong to the question store. O(1).
+    size_t heap_bytes() const { return count*sizeof(question_record); }
+
+    // Question `i` of `size()`. O(1).
+    question_view operator[](size_t i) const { return question_view(&records[i]); }
+
+    iterator begin() const { return iterator(records.get()); }
+    iterator end() const { return iterator(records.get()+count); }
+};
+
+// Writes each question as its store ID and this quiz's answer; the text goes to questions.json (see `quiz_file::before_write`)
+inline void to_json(nlohmann::json& j, const quiz_questions& questions){
+    j=nlohmann::json::array();
+    for(quiz_questions::question_view q:questions){
+        j.push_back({
+            {"questionId", question_body::id_text(q.body().id())},
+            {"correctAnswerIndex", q.correct_answer()}
+        });
+    }
+}
+
+#endif
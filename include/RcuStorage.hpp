@@ -0,0 +1,276 @@
+#ifndef RCU_STORAGE_HPP
+#define RCU_STORAGE_HPP
+
+/*
+ * Description: This header defines `rcu_storage`, a read-copy-update variant of `chained_storage` for the read-mostly catalogs
+ * (`classroom_hashTable` and `quiz_hashTable`). It has the same interface as the other storages.
+ *
+ * DSA Concepts:
+ * 1.  **Read-Copy-Update (RCU):** Readers never take a lock. They load the current `version` (bucket array) with one atomic read
+ * and walk chains whose nodes never change after they are published.
+ * 2.  **Atomic Publication:** A writer fully builds a node before linking it in with one release store of the bucket head.
+ * Growing the table builds a complete new version (new array, copied nodes) and publishes it with one store of `current`.
+ * A reader therefore sees either the old or the new state, never a half-built one.
+ * 3.  **Epoch-Based Reclamation:** The replaced version cannot be freed while readers may still be walking it. It is retired to
+ * `epoch_domain` (see `EpochReclaim.hpp`) and freed once every reader that could have seen it has finished.
+ * Readers only write to their own per-thread epoch slot, never to a shared cache line.
+ *
+ * 4.  **Path Copying:** Nodes are never changed in place, so an erase rebuilds the part of the chain in front of the erased node
+ * (copies pointing at the node after it) and publishes it with one store of the bucket head. The erased node and the replaced copies
+ * are retired to `epoch_domain` one by one.
+ *
+ * Writers are serialised by one mutex and a resize copies the whole chain set. That cost is fine for catalogs that see a few
+ * hundred writes a day, and is the price of lock-free reads. The loaders' `reserve` calls keep resizes off the request path at startup.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include "HashStorage.hpp"
+#include "EpochReclaim.hpp"
+#include "Prefetch.hpp"
+
+template<typename T>
+class rcu_storage {
+    // Nodes are immutable once published
+    struct node {
+        T data;
+        node* next;
+        uint32_t hash;
+    };
+
+    // One published state of the table: a bucket array and the chains hanging off it
+    struct version {
+        std::atomic<node*>* buckets;
+        size_t bucket_count;
+
+        explicit version(size_t n): buckets(new std::atomic<node*>[n]), bucket_count(n){
+            for(size_t i=0;i<n;i++) buckets[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        // Runs once no reader can reach this version any more
+        ~version(){
+            for(size_t i=0;i<bucket_count;i++){
+                node* curr=buckets[i].load(std::memory_order_relaxed);
+                while(curr){
+                    node* next=curr->next;
+                    delete curr;
+                    curr=next;
+                }
+            }
+            delete[] buckets;
+        }
+    };
+
+    // Grow once the table holds more than 3 items per 4 buckets
+    static constexpr size_t MAX_LOAD_NUM = 3;
+    static constexpr size_t MAX_LOAD_DEN = 4;
+
+    std::atomic<version*> current;
+    std::atomic<size_t> count{0};
+    std::mutex writer_mutex;    // Writers only; readers never touch it
+
+    static size_t round_up_pow2(size_t n){
+        size_t p=16;
+        while(p<n) p<<=1;
+        return p;
+    }
+
+    // Copies every node into a new version of `new_count` buckets and publishes it. Caller holds writer_mutex.
+    void publish_resized(size_t new_count){
+        version* old_version=current.load(std::memory_order_relaxed);
+        version* fresh=new version(new_count);
+        for(size_t i=0;i<old_version->bucket_count;i++){
+            for(node* n=old_version->buckets[i].load(std::memory_order_relaxed); n; n=n->next){
+                std::atomic<node*>& head=fresh->buckets[n->hash&(new_count-1)];
+                head.store(new node{n->data, head.load(std::memory_order_relaxed), n->hash}, std::memory_order_relaxed);
+            }
+        }
+        current.store(fresh, std::memory_order_release);
+        epoch_domain::instance().retire(old_version);
+    }
+
+    // Grows the table if needed and publishes a node for the item. Caller holds writer_mutex.
+    void insert_locked(uint32_t hash, const T& item){
+        version* v=current.load(std::memory_order_relaxed);
+        if((count.load(std::memory_order_relaxed)+1)*MAX_LOAD_DEN > v->bucket_count*MAX_LOAD_NUM){
+            publish_resized(v->bucket_count*2);
+            v=current.load(std::memory_order_relaxed);
+        }
+        std::atomic<node*>& head=v->buckets[hash&(v->bucket_count-1)];
+        head.store(new node{item, head.load(std::memory_order_relaxed), hash}, std::memory_order_release);
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+public:
+    explicit rcu_storage(size_t initial_buckets): current(new version(round_up_pow2(initial_buckets))){}
+
+    rcu_storage(const rcu_storage&) = delete;
+    rcu_storage& operator=(const rcu_storage&) = delete;
+
+    // Frees the current version's nodes. The items themselves are owned by the table using this storage.
+    ~rcu_storage(){
+        delete current.load();
+    }
+
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+
+    // Bytes of the current version: its bucket array and one node per item. Versions still waiting for readers are not counted. O(1).
+    size_t memory_bytes(){
+        std::lock_guard<std::mutex> guard(writer_mutex);
+        version* v=current.load(std::memory_order_relaxed);
+        return sizeof(version)+v->bucket_count*sizeof(std::atomic<node*>)+count.load(std::memory_order_relaxed)*sizeof(node);
+    }
+
+    // Presizes the table for `expected` items
+    void reserve(size_t expected){
+        std::lock_guard<std::mutex> guard(writer_mutex);
+        size_t needed=round_up_pow2(expected*MAX_LOAD_DEN/MAX_LOAD_NUM+1);
+        if(needed>current.load(std::memory_order_relaxed)->bucket_count){
+            publish_resized(needed);
+        }
+    }
+
+    /*
+     * Inserts an item at the head of its bucket's list. The node is fully built before the release store that publishes it.
+     * Time Complexity: O(1) amortised; a resize is O(n) on the writer only.
+     */
+    void insert(uint32_t hash, const T& item){
+        std::lock_guard<std::mutex> guard(writer_mutex);
+        insert_locked(hash, item);
+    }
+
+    /*
+     * Inserts `item` unless an item for which `equals(item)` is true is already stored, in which case that one is copied into
+     * `existing` and false is returned. Writers are serialised, so of two concurrent calls for the same key exactly one inserts.
+     * Time Complexity: O(1) amortised.
+     */
+    template<typename Equals>
+    bool insert_if_absent(uint32_t hash, Equals equals, const T& item, T& existing){
+        std::lock_guard<std::mutex> guard(writer_mutex);
+        version* v=current.load(std::memory_order_relaxed);
+        for(node* n=v->buckets[hash&(v->bucket_count-1)].load(std::memory_order_relaxed); n; n=n->next){
+            if(n->hash==hash && equals(n->data)){
+                existing=n->data;
+                return false;
+            }
+        }
+        insert_locked(hash, item);
+        return true;
+    }
+
+    /*
+     * Looks for the item for which `equals(item)` is true and copies it into `out`. Takes no lock.
+     * Time Complexity: O(1) average.
+     */
+    template<typename Equals>
+    bool find(uint32_t hash, Equals equals, T& out){
+        epoch_guard read_section;
+        version* v=current.load(std::memory_order_acquire);
+        for(node* n=v->buckets[hash&(v->bucket_count-1)].load(std::memory_order_acquire); n; n=n->next){
+            if(n->hash==hash && equals(n->data)){
+                out=n->data;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*
+     * Looks up `n` keys at once: `hashes[i]` is the hash of key `i` and `equals(i, item)` tells whether `item` is key `i`'s.
+     * `out[i]` receives the match, and is left untouched when there is none. The bucket heads and first nodes of later keys are
+     * prefetched while earlier ones are resolved (see `Prefetch.hpp`). Takes no lock; the whole batch reads one version.
+     * Time Complexity: O(n) average.
+     */
+    template<typename Equals>
+    void find_many(const uint32_t* hashes, size_t n, Equals equals, T* out){
+        epoch_guard read_section;
+        version* v=current.load(std::memory_order_acquire);
+        size_t mask=v->bucket_count-1;
+        batch_pipeline(n, [&](size_t i){
+            prefetch_line(&v->buckets[hashes[i]&mask]);
+        }, [&](size_t i){
+            node* head=v->buckets[hashes[i]&mask].load(std::memory_order_acquire);
+            if(head) prefetch_line(head);
+        }, [&](size_t i){
+            for(node* curr=v->buckets[hashes[i]&mask].load(std::memory_order_acquire); curr; curr=curr->next){
+                if(curr->hash==hashes[i] && equals(i, curr->data)){
+                    out[i]=curr->data;
+                    break;
+                }
+            }
+        });
+    }
+
+    /*
+     * Removes the item for which `equals(item)` is true and copies it into `out`. Returns false if there is none.
+     * The nodes in front of it are copied, so readers already walking the chain still see a complete one.
+     * Time Complexity: O(1) average.
+     */
+    template<typename Equals>
+    bool erase(uint32_t hash, Equals equals, T& out){
+        std::lock_guard<std::mutex> guard(writer_mutex);
+        version* v=current.load(std::memory_order_relaxed);
+        std::atomic<node*>& head=v->buckets[hash&(v->bucket_count-1)];
+        node* first=head.load(std::memory_order_relaxed);
+        node* target=first;
+        while(target && !(target->hash==hash && equals(target->data))) target=target->next;
+        if(!target) return false;
+        out=target->data;
+
+        // Copy the prefix back to front, so each copy is complete before anything points at it
+        std::vector<node*> prefix;
+        for(node* n=first; n!=target; n=n->next) prefix.push_back(n);
+        node* rest=target->next;
+        for(size_t i=prefix.size(); i-->0;) rest=new node{prefix[i]->data, rest, prefix[i]->hash};
+        head.store(rest, std::memory_order_release);
+        count.fetch_sub(1, std::memory_order_relaxed);
+
+        epoch_domain& domain=epoch_domain::instance();
+        for(node* n:prefix) domain.retire(n);
+        domain.retire(target);
+        return true;
+    }
+
+    // Copies the first stored item for which `matches(item)` is true into `out`, scanning the whole table. O(N).
+    template<typename Predicate>
+    bool find_if(Predicate matches, T& out){
+        epoch_guard read_section;
+        version* v=current.load(std::memory_order_acquire);
+        for(size_t i=0;i<v->bucket_count;i++){
+            for(node* n=v->buckets[i].load(std::memory_order_acquire); n; n=n->next){
+                if(matches(n->data)){
+                    out=n->data;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Calls `visit(item)` for every item in the version current when the scan starts
+    template<typename Visitor>
+    void for_each(Visitor visit){
+        epoch_guard read_section;
+        version* v=current.load(std::memory_order_acquire);
+        for(size_t i=0;i<v->bucket_count;i++){
+            for(node* n=v->buckets[i].load(std::memory_order_acquire); n; n=n->next) visit(n->data);
+        }
+    }
+};
+
+/*
+ * `catalog_storage` is the layout of the read-mostly tables (classrooms and quizzes).
+ * It is `rcu_storage` when built with `EDUMAZE_RCU_CATALOGS` (the CMake default), otherwise the same layout as every other table.
+ */
+#ifdef EDUMAZE_RCU_CATALOGS
+template<typename T>
+using catalog_storage = rcu_storage<T>;
+#else
+template<typename T>
+using catalog_storage = table_storage<T>;
+#endif
+
+#endif
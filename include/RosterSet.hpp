@@ -0,0 +1,194 @@
+#ifndef ROSTER_SET_HPP
+#define ROSTER_SET_HPP
+
+/*
+ * Description: This header defines `roster_set`, the enrollment list of a classroom (`classroom_data::student_usernames`).
+ * It keeps the students in the order they joined, for classrooms.json, and indexes them in a small hash set, so "is this
+ * student enrolled" is O(1) however large the class: the check behind every `/join_classroom_post` during the first-week rush
+ * into lecture classes of thousands, and behind every quiz attempt (see `classroom_hashTable::isEnrolled`). A B+ tree keeps them
+ * in username order as well, for the roster page, which shows one page of names at a time (`page_by_name`).
+ *
+ * DSA Concepts:
+ * 1.  **Open Addressing:** The set is one power-of-two array of 4-byte `symbol_id`s, probed linearly from the id's hash; a free slot
+ * holds `symbol_id::INVALID`. It is grown (doubled and rehashed) when it would be more than half full, so probes stay short.
+ * 2.  **Fibonacci Hashing:** Interned ids are dense (0, 1, 2, ...), so the id is multiplied by 2^64 / phi and the top bits taken as
+ * the slot, which spreads neighbouring ids across the array.
+ * 3.  **Backward-Shift Deletion:** Erasing moves later entries of the same probe run back into the gap instead of leaving a
+ * tombstone, so the set never fills up with deleted slots as students leave.
+ * 4.  **Ordered Index:** `by_name` is a `bplus_tree` of the same ids ordered by username (see `BPlusTree.hpp`), so a page of the
+ * alphabetical roster after any name costs O(log n + page size), without sorting the class on every view.
+ *
+ * Thread safety: none of its own; the classroom's `lock` guards it like the other lists of `classroom_data`.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "SymbolTable.hpp"
+#include "BPlusTree.hpp"
+#include "json.hpp"
+
+class roster_set {
+    std::vector<symbol_id> order;   // The students in the order they joined
+    std::unique_ptr<uint32_t[]> slots;  // The hash set of `order`; null while the roster is empty
+    size_t slot_bits=0;     // The set has 2^slot_bits slots
+    bplus_tree<symbol_id, symbol_order> by_name;    // `order` sorted by username
+
+    size_t slot_mask() const { return (size_t(1)<<slot_bits)-1; }
+
+    size_t home_slot(uint32_t id) const {
+        return static_cast<size_t>((id*0x9E3779B97F4A7C15ull)>>(64-slot_bits));
+    }
+
+    // The slot holding `id`, or the free slot where it would go
+    size_t probe(uint32_t id) const {
+        size_t i=home_slot(id);
+        while(slots[i]!=symbol_id::INVALID && slots[i]!=id) i=(i+1)&slot_mask();
+        return i;
+    }
+
+    // Replaces the set with an empty one with room for `n` students at no more than half load
+    void reset_slots(size_t n){
+        size_t bits=3;
+        while((size_t(1)<<bits)<2*n) bits++;
+        slot_bits=bits;
+        slots.reset(new uint32_t[size_t(1)<<bits]);
+        for(size_t i=0;i<=slot_mask();i++) slots[i]=symbol_id::INVALID;
+    }
+
+    // Rebuilds the set of `order` with room for `n` students
+    void rehash(size_t n){
+        reset_slots(n);
+        for(symbol_id student:order) slots[probe(student.value)]=student.value;
+    }
+
+public:
+    roster_set() = default;
+
+    roster_set(const roster_set& other): order(other.order){
+        if(!order.empty()) rehash(order.size());
+        for(symbol_id student:order) by_name.insert(student);
+    }
+
+    roster_set& operator=(const roster_set& other){
+        if(this!=&other){
+            order=other.order;
+            if(order.empty()){
+                slots.reset();
+                slot_bits=0;
+            }
+            else rehash(order.size());
+            by_name.clear();
+            for(symbol_id student:order) by_name.insert(student);
+        }
+        return *this;
+    }
+
+    roster_set(roster_set&&) noexcept = default;
+    roster_set& operator=(roster_set&&) noexcept = default;
+
+    /*
+     * Replaces the roster, e.g. with the list saved in classrooms.json, taking over the vector as the join order.
+     * Repeated and invalid ids are dropped.
+     * Time Complexity: O(n log n).
+     */
+    void assign(std::vector<symbol_id>&& students){
+        order=std::move(students);
+        slots.reset();
+        slot_bits=0;
+        by_name.clear();
+        if(order.empty()) return;
+        reset_slots(order.size());
+        size_t kept=0;
+        for(symbol_id student:order){
+            if(!student.valid()) continue;
+            size_t slot=probe(student.value);
+            if(slots[slot]==student.value) continue;
+            slots[slot]=student.value;
+            order[kept++]=student;
+            by_name.insert(student);
+        }
+        order.resize(kept);
+    }
+
+    void assign(const std::vector<symbol_id>& students){
+        assign(std::vector<symbol_id>(students));
+    }
+
+    // Whether `student` is enrolled. O(1) average.
+    bool contains(symbol_id student) const {
+        if(!slots || !student.valid()) return false;
+        return slots[probe(student.value)]==student.value;
+    }
+
+    /*
+     * Enrolls `student` at the end of the roster. Returns false, and changes nothing, if they are already enrolled.
+     * Time Complexity: O(1) amortised for the set, O(log n) for the name order.
+     */
+    bool insert(symbol_id student){
+        if(!student.valid() || contains(student)) return false;
+        order.push_back(student);
+        by_name.insert(student);
+        if(2*order.size()>(slots ? slot_mask()+1 : 0)) rehash(order.size());
+        else slots[probe(student.value)]=student.value;
+        return true;
+    }
+
+    /*
+     * Removes `student`, keeping the others in order. Returns false if they were not enrolled.
+     * Time Complexity: O(1) average for the set, O(n) to close the gap in the ordered list.
+     */
+    bool erase(symbol_id student){
+        if(!contains(student)) return false;
+        size_t gap=probe(student.value);
+        // Shift back each later entry of the probe run that may live in the gap, i.e. whose home slot is not in (gap, j]
+        for(size_t j=(gap+1)&slot_mask(); slots[j]!=symbol_id::INVALID; j=(j+1)&slot_mask()){
+            size_t home=home_slot(slots[j]);
+            if(((j-home)&slot_mask())>=((j-gap)&slot_mask())){
+                slots[gap]=slots[j];
+                gap=j;
+            }
+        }
+        slots[gap]=symbol_id::INVALID;
+        by_name.erase(student);
+        for(size_t i=0;i<order.size();i++){
+            if(order[i]==student){
+                order.erase(order.begin()+i);
+                break;
+            }
+        }
+        return true;
+    }
+
+    // The students in the order they joined
+    const std::vector<symbol_id>& members() const { return order; }
+
+    /*
+     * Up to `limit` students in username order, after the username `after` (from the start if it is empty). `more` is set if
+     * there are students after the page; the next page starts after the last username returned.
+     * Time Complexity: O(log n + limit).
+     */
+    std::vector<symbol_id> page_by_name(std::string_view after, size_t limit, bool& more) const {
+        auto from=after.empty() ? by_name.begin() : by_name.upper_bound(after);
+        return by_name.page(from, limit, [](symbol_id){ return true; }, more);
+    }
+
+    size_t size() const { return order.size(); }
+    bool empty() const { return order.empty(); }
+
+    // Heap bytes of the join-order list, the set and the name order, for the memory report (see `MemoryUsage.hpp`). O(1).
+    size_t heap_bytes() const {
+        return order.capacity()*sizeof(symbol_id)+(slots ? (slot_mask()+1)*sizeof(uint32_t) : 0)+by_name.memory_bytes();
+    }
+
+    std::vector<symbol_id>::const_iterator begin() const { return order.begin(); }
+    std::vector<symbol_id>::const_iterator end() const { return order.end(); }
+};
+
+// Saved as the plain list of usernames, in join order
+inline void to_json(nlohmann::json& j, const roster_set& roster){
+    j=roster.members();
+}
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef SYMBOL_TABLE_HPP
+#define SYMBOL_TABLE_HPP
+
+/*
+ * Description: This header defines the process-wide `symbol_table` that interns usernames. Each distinct username is stored once
+ * and given a dense 32-bit `symbol_id`. Records refer to users through that id instead of holding their own copy of the name:
+ * `student_data::username`, `classroom_data::student_usernames`, `classroom_data::teacher_username` and
+ * `quiz_result_data::studentUsername`.
+ *
+ * DSA Concepts:
+ * 1.  **String Interning:** Equal strings map to the same id, so "is this the same user" is one integer compare and a roster of
+ * 30 students is 120 bytes instead of 30 `std::string`s.
+ * 2.  **Dense Ids:** Ids are handed out as 0, 1, 2, ... so the text of id `i` is found by plain array indexing. The array is split into
+ * fixed-size chunks that are allocated on demand and never move, so reading a name takes no lock.
+ * 3.  **Hash Index:** Going from text to id uses a `table_storage` of ids hashed with the shared `key_hash` policy. The equality
+ * callback compares against the interned text, so the index stores nothing but the 4-byte ids.
+ *
+ * Lifetime: an interned name is never released. Deleting an account leaves its username's text and index entry behind, so the
+ * table grows with the number of distinct usernames ever registered, not with the live accounts. An id cannot be recycled
+ * safely without counting every holder: rosters, results and classrooms keep ids without a reference count, and a reused id
+ * would show a stale entry under another user's name. A name that is registered again gets its old id back. Signups bound to
+ * fail on a taken email are turned away before their username is interned (see `user_hashTable::addUser`).
+ *
+ * Thread safety: `find` and `name` are lock-free apart from the index's own stripe lock. `intern` serialises inserts with one mutex
+ * and re-checks the index under it, so two threads interning the same new name get the same id.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "HashStorage.hpp"
+#include "KeyHash.hpp"
+#include "MemoryUsage.hpp"
+#include "json.hpp"
+
+struct symbol_id {
+    static constexpr uint32_t INVALID = UINT32_MAX;     // Id of a name that was never interned (or an empty name)
+
+    uint32_t value=INVALID;
+
+    constexpr symbol_id() = default;
+    constexpr explicit symbol_id(uint32_t v): value(v){}
+
+    constexpr bool valid() const { return value!=INVALID; }
+
+    // The interned text; "" for an invalid id. Valid for the lifetime of the process.
+    std::string_view view() const;
+    std::string str() const { return std::string(view()); }
+
+    constexpr bool operator==(const symbol_id& other) const { return value==other.value; }
+    constexpr bool operator!=(const symbol_id& other) const { return value!=other.value; }
+};
+
+// Rosters and results hold symbol ids by value: one 4-byte word, copied with `memmove`
+static_assert(sizeof(symbol_id)==sizeof(uint32_t), "a symbol_id is one 4-byte word");
+static_assert(std::is_trivially_copyable_v<symbol_id>, "rosters must copy with memmove");
+
+class symbol_table {
+    static constexpr size_t CHUNK_BITS = 12;
+    static constexpr size_t CHUNK_SIZE = size_t(1)<<CHUNK_BITS;    // Names per chunk
+    static constexpr size_t MAX_CHUNKS = 4096;  // Room for 16M distinct names
+
+    std::atomic<std::string*> chunks[MAX_CHUNKS];  // Chunk `c` holds the names of ids [c * CHUNK_SIZE, (c + 1) * CHUNK_SIZE)
+    std::atomic<uint32_t> count{0};
+    table_storage<uint32_t> index;  // Text -> id
+    std::mutex intern_mutex;    // Serialises `intern`
+
+    const std::string& text(uint32_t id) const {
+        return chunks[id>>CHUNK_BITS].load(std::memory_order_acquire)[id&(CHUNK_SIZE-1)];
+    }
+
+    bool lookup(std::string_view name, uint32_t hash, uint32_t& out){
+        return index.find(hash, [this, name](uint32_t id){ return text(id)==name; }, out);
+    }
+
+public:
+    static symbol_table& instance(){
+        static symbol_table table;
+        return table;
+    }
+
+    symbol_table(): index(1024){
+        for(auto& chunk:chunks) chunk.store(nullptr, std::memory_order_relaxed);
+    }
+
+    symbol_table(const symbol_table&) = delete;
+    symbol_table& operator=(const symbol_table&) = delete;
+
+    ~symbol_table(){
+        for(auto& chunk:chunks) delete[] chunk.load();
+    }
+
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+
+    /*
+     * Returns the id of `name`, or an invalid id if it was never interned. Never adds anything.
+     * Time Complexity: O(1) average.
+     */
+    symbol_id find(std::string_view name){
+        uint32_t id;
+        if(name.empty() || !lookup(name, key_hash::hash(name), id)) return symbol_id();
+        return symbol_id(id);
+    }
+
+    /*
+     * Returns the id of `name`, adding it if this is the first time it is seen. The empty name maps to the invalid id.
+     * Time Complexity: O(1) average.
+     */
+    symbol_id intern(std::string_view name){
+        if(name.empty()) return symbol_id();
+        uint32_t hash=key_hash::hash(name);
+        uint32_t id;
+        if(lookup(name, hash, id)) return symbol_id(id);
+
+        std::lock_guard<std::mutex> guard(intern_mutex);
+        // Another thread may have added the same name while we waited
+        if(lookup(name, hash, id)) return symbol_id(id);
+        id=count.load(std::memory_order_relaxed);
+        size_t chunk=id>>CHUNK_BITS;
+        if(chunk>=MAX_CHUNKS){
+            throw std::length_error("symbol table is full");
+        }
+        std::string* names=chunks[chunk].load(std::memory_order_relaxed);
+        if(!names){
+            names=new std::string[CHUNK_SIZE];
+            chunks[chunk].store(names, std::memory_order_release);
+        }
+        names[id&(CHUNK_SIZE-1)]=std::string(name);
+        count.store(id+1, std::memory_order_release);
+        // The text is in place before the id becomes findable
+        index.insert(hash, id);
+        return symbol_id(id);
+    }
+
+    /*
+     * Reports the bytes held for the interned names (see `MemoryUsage.hpp`): the chunks as records, the text of names too long for
+     * the small-string buffer, and the index. Interned text is never changed, so it is read without a lock.
+     * Time Complexity: O(n).
+     */
+    memory_usage memory(){
+        memory_usage usage;
+        uint32_t n=count.load(std::memory_order_acquire);
+        usage.entities=n;
+        usage.nodes=index.memory_bytes();
+        usage.records=(n+CHUNK_SIZE-1)/CHUNK_SIZE*CHUNK_SIZE*sizeof(std::string);
+        for(uint32_t id=0;id<n;id++) usage.strings+=heap_bytes(text(id));
+        return usage;
+    }
+
+    // The text of an id. O(1), no lock.
+    std::string_view name(symbol_id id) const {
+        if(!id.valid()) return std::string_view();
+        return text(id.value);
+    }
+};
+
+inline std::string_view symbol_id::view() const {
+    return symbol_table::instance().name(*this);
+}
+
+// Orders interned ids by their text (alphabetical usernames), and compares them with plain text, e.g. a cursor from a URL
+struct symbol_order {
+    bool operator()(symbol_id a, symbol_id b) const { return a.view()<b.view(); }
+    bool operator()(symbol_id a, std::string_view b) const { return a.view()<b; }
+    bool operator()(std::string_view a, symbol_id b) const { return a<b.view(); }
+};
+
+// Symbols are stored in the JSON files as their text, so the file format is unchanged
+inline void to_json(nlohmann::json& j, const symbol_id& id){
+    j=std::string(id.view());
+}
+
+inline void from_json(const nlohmann::json& j, symbol_id& id){
+    id=j.is_string() ? symbol_table::instance().intern(j.get_ref<const std::string&>()) : symbol_id();
+}
+
+#endif
@@ -5,79 +5,167 @@
  * Description: This header file defines the data structures for users (students and teachers and the hash table class (`user_hashTable`) to manage them.
  * DSA Concepts:
  * 1.  **Hash Table:** The `user_hashTable` class is a hash table. This is chosen for its excellent average-case time complexity for lookups, insertions, and deletions, which is O(1).
- * 2.  **Separate Chaining:** The hash table resolves collisions using separate chaining. Each index in the `students`, `teachers`, and `emails` arrays is a pointer to the head of a linked list (`student_link`, `teacher_link`, `email_link`).
- * 3.  **Hash Function:** A custom hash function (`fnv1a`) is used to map string keys (like username and email) to an integer index in the table.
+ * 2.  **Separate Chaining:** The hash table resolves collisions using separate chaining. `students`, `teachers`, and `emails` are `table_storage` bucket arrays whose buckets point to the head of a linked list (`student_link`, `teacher_link`, `email_link`).
+ * Building with `EDUMAZE_FLAT_TABLES` swaps them for the open-addressing `flat_storage`, and building with `EDUMAZE_CUCKOO_LOGIN`
+ * for `cuckoo_storage` (see `CuckooStorage.hpp`), whose lookups read at most two buckets however many users there are.
+ * The arrays grow automatically when their load factor passes the threshold in `HashStorage.hpp`, moving a few buckets per operation.
+ * 3.  **Hash Function:** The shared, seeded `key_hash` policy (see `KeyHash.hpp`) maps string keys (like username and email) to an integer index
+ * in the table. It hashes a `std::string_view`, so looking up a key never copies it.
  * 4.  **Linked List:** The `_link` structs act as nodes in a singly linked list.
- 
+ * 5.  **Concurrency:** The tables are safe to use from Crow's worker threads (see the lock striping in `HashStorage.hpp`).
+ * Each record also carries its own reader-writer `lock` for the fields routes change later; hold it shared while reading them.
+ * 6.  **Slab Allocation:** Records are created in the `slab_pool` of their `EntityTable` (see `SlabPool.hpp`), so loading a user costs
+ * no individual heap allocation for the record or its nodes. The table owns every record it holds.
+ * 7.  **Secondary Index:** The `emails` table stores no strings of its own: each entry points at the owning record's `email`,
+ * which never moves or changes once the record is created, and holds its interned username.
+ * 8.  **String Interning:** A username is stored once, in the process-wide `symbol_table` (see `SymbolTable.hpp`). Records hold its
+ * 4-byte `symbol_id`, and joined/created classrooms are held as 4-byte `entity_id` codes.
+ * 9.  **Shared Username Namespace:** `usernames` is a set of the interned usernames held by either table, so a student and a
+ * teacher can never register the same name: a signup claims the name there with one atomic check-and-insert.
+ * 10. **Hot/Cold Splitting:** A record keeps the fields every request reads in its first cache line and moves `email` and
+ * `password`, which only login and password change read, to a separately allocated `user_credentials`. `classroomIds` is an
+ * `id_list` (see `IdList.hpp`) that is read without a lock, so the dashboards and rosters never touch the record's `lock`.
  */
 
 #include<iostream>
 #include<string>
 #include<vector>
+#include<optional>
+#include<string_view>
+#include<memory>
 #include "json.hpp"
 #include <fstream> 
+#include <mutex>
+#include <shared_mutex>
+#include "HashStorage.hpp"
+#include "EntityTable.hpp"
+#include "CuckooStorage.hpp"
+#include "KeyHash.hpp"
+#include "SymbolTable.hpp"
+#include "EntityId.hpp"
+#include "IdList.hpp"
+#include "JsonFile.hpp"
 using njson = nlohmann::json;
 
-// Struct to represent the data for a single student
-struct student_data {
-    std::string name;
-    std::string username;   // Primary key for the student hash table
+/*
+ * The cold part of a user record: only signup, login, password change, account deletion and saving read it.
+ * It lives in its own allocation so the two strings stay out of the cache lines the dashboards and rosters read.
+ * `email` never changes once the record is created (the email index points at it); `password` is guarded by the record's `lock`.
+ */
+struct user_credentials {
     std::string email;  // Primary key for the email hash table
     std::string password;
-    std::vector<std::string> classroomIds;  // Stores codes of all joined classrooms
+
+    user_credentials(std::string theemail, std::string thepassword): email(std::move(theemail)), password(std::move(thepassword)){}
+};
+
+/*
+ * Struct to represent the data for a single student.
+ * The fields requests read (`username`, `name`, `classroomIds` and the `credentials` pointer) fill the first 64-byte cache line
+ * of the record, and the record is aligned to one. A dashboard or roster lookup reads that line and writes nothing: `name`
+ * never changes and `classroomIds` is read without a lock. `lock` fills the second line, which only the writers (joining,
+ * leaving, deleting) and login and password change, which read the password under it, touch.
+ */
+struct alignas(64) student_data {
+    symbol_id username;   // Primary key for the student hash table (interned)
+    std::string name;
+    id_list classroomIds;  // Stores codes of all joined classrooms; changed only under `lock`
+    std::unique_ptr<user_credentials> credentials;  // Cold: login and password change only
+    mutable std::shared_mutex lock;     // Guards `credentials->password` and serialises changes to `classroomIds`
     
-    student_data(const std:: string& thename,const std::string& theusername,const std::string& theemail,const std::string& thepassword, const std::vector<std::string>& theclassroomIds={}):
-    name(thename),
-    username(theusername),
-    email(theemail), 
-    password(thepassword),
-    classroomIds(theclassroomIds)
+    student_data(std::string thename, std::string_view theusername, std::string theemail, std::string thepassword, const std::vector<entity_id>& theclassroomIds={}):
+    username(symbol_table::instance().intern(theusername)),
+    name(std::move(thename)),
+    classroomIds(theclassroomIds),
+    credentials(std::make_unique<user_credentials>(std::move(theemail), std::move(thepassword)))
     {}
 };
 
 // Represents a node in the linked list for the student hash table (for separate chaining)
-struct student_link{
-    student_data* data=nullptr;
-    student_link* next=NULL;
-};
+using student_link = hash_link<student_data*>;
 
-// Struct to represent the data for a single teacher
-struct teacher_data {
+// Struct to represent the data for a single teacher, split into hot and cold parts like `student_data`
+struct alignas(64) teacher_data {
+    symbol_id username;   // Interned
     std::string name;
-    std::string username;
-    std::string email;
-    std::string password;
-    std::vector<std::string> classroomIds;  // Stores codes of all created classrooms
+    id_list classroomIds;  // Stores codes of all created classrooms; changed only under `lock`
+    std::unique_ptr<user_credentials> credentials;  // Cold: login and password change only
+    mutable std::shared_mutex lock;     // Guards `credentials->password` and serialises changes to `classroomIds`
     
-    teacher_data(const std:: string& thename,const std::string& theusername,const std::string& theemail,const std::string& thepassword, const std::vector<std::string>& theclassroomIds={}):
-    name(thename),
-    username(theusername),
-    email(theemail), 
-    password(thepassword),
-    classroomIds(theclassroomIds)
+    teacher_data(std::string thename, std::string_view theusername, std::string theemail, std::string thepassword, const std::vector<entity_id>& theclassroomIds={}):
+    username(symbol_table::instance().intern(theusername)),
+    name(std::move(thename)),
+    classroomIds(theclassroomIds),
+    credentials(std::make_unique<user_credentials>(std::move(theemail), std::move(thepassword)))
     {}
 };
 
 // Represents a node in the linked list for the teacher hash table (for separate chaining)
-struct teacher_link{
-    teacher_data* data=nullptr;
-    teacher_link* next=NULL;
-};
+using teacher_link = hash_link<teacher_data*>;
 
 /*
  * This struct is for a separate hash table used for email lookups.
  * It allows for O(1) average-case checking if an email is already in use and finding a username by email.
+ * `email` points at the `user_credentials` of the owning `student_data`/`teacher_data` and `username` is its interned id, so the index holds no copies.
  */
-struct email_link{
-    std::string* username=nullptr;
-    std::string* email=nullptr;
-    email_link* next=NULL;
+struct email_entry{
+    symbol_id username;
+    const std::string* email=nullptr;
 };
 
+// Represents a node in the linked list for the email hash table
+using email_link = hash_link<email_entry>;
+
 void to_json(njson &j, const student_data &s);
 
 void to_json(njson &j, const teacher_data &s);
 
+// Both user tables are keyed by the interned username
+inline symbol_id entity_key(const student_data& s){ return s.username; }
+inline symbol_id entity_key(const teacher_data& t){ return t.username; }
+
+// Heap bytes a user record owns (see `EntityTable::memory`): the credentials block, its strings, the name and the classroom list
+template<typename User>
+void userMemory(const User& user, memory_usage& usage){
+    std::shared_lock<std::shared_mutex> guard(user.lock);
+    usage.records+=sizeof(user_credentials);
+    usage.strings+=heap_bytes(user.name)+heap_bytes(user.credentials->email)+heap_bytes(user.credentials->password);
+    usage.vectors+=user.classroomIds.heap_bytes();
+}
+
+inline void entity_memory(const student_data& s, memory_usage& usage){ userMemory(s, usage); }
+inline void entity_memory(const teacher_data& t, memory_usage& usage){ userMemory(t, usage); }
+
+// Reads one user object of students.json / teachers.json into `table`
+// The strings are moved out of the parsed element into the record; the codes go through a scratch list reused for every user,
+// so the record's `id_list` block is the only allocation for them
+template<typename Table>
+void readUser(Table& table, njson& user){
+    thread_local std::vector<entity_id> classrooms;
+    classrooms.clear();
+    if(user.contains("classroomIds") && user["classroomIds"].is_array()){
+        for(const njson& code:user["classroomIds"]) classrooms.push_back(code.get<entity_id>());
+    }
+    table.emplace(takeText(user, "name"), jsonText(user["username"]), takeText(user, "email"), takeText(user, "password"), classrooms);
+}
+
+// File formats of the two user tables (see `json_file_persist`). Both files must exist.
+struct student_file : json_file_format {
+    static constexpr const char* path = "Data/students.json";
+    static constexpr bool required = true;
+    template<typename Table> static void read(Table& table, njson& user){ readUser(table, user); }
+};
+
+struct teacher_file : json_file_format {
+    static constexpr const char* path = "Data/teachers.json";
+    static constexpr bool required = true;
+    template<typename Table> static void read(Table& table, njson& user){ readUser(table, user); }
+};
+
+// Login reads these two tables and the email index, so all three use `login_storage` (cuckoo hashing with EDUMAZE_CUCKOO_LOGIN)
+using student_table = EntityTable<symbol_id, student_data, symbol_hash, login_storage, json_file_persist<student_file>>;
+using teacher_table = EntityTable<symbol_id, teacher_data, symbol_hash, login_storage, json_file_persist<teacher_file>>;
+
 /*
  * Class: user_hashTable
  *
@@ -86,146 +174,104 @@ void to_json(njson &j, const teacher_data &s);
  * 1. `students`: Maps `username` to `student_data`
  * 2. `teachers`: Maps `username` to `teacher_data`
  * 3. `emails`:   Maps `email` to `username` (for quick email existence checks)
+ * 4. `usernames`: The set of usernames taken by any student or teacher
+ * The first two are `EntityTable`s (see `EntityTable.hpp`), which load themselves from their files; the email index is rebuilt
+ * from them.
  */
 class user_hashTable{
-    student_link** students;    // Array of pointers to student linked lists
-    teacher_link** teachers;  // Array of pointers to teacher linked lists  
-    email_link** emails;    // Array of pointers to email linked lists
-    int size;
-
-
-    // FNV-1a hash function.
-    uint32_t fnv1a(std::string s){
-        const uint32_t bais=2166136261u;
-        const uint32_t prime=16777619u;
-        uint32_t hash=bais;
-        for(unsigned char c:s){
-            hash^=c;
-            hash*=prime;
-        }
-        return hash;
+    student_table students;
+    teacher_table teachers;
+    login_storage<email_entry> emails;    // Buckets of email linked lists
+    table_storage<symbol_id> usernames;   // Every username held by a student or a teacher: one namespace for both tables
+
+
+    // Adds an email -> username entry to the `emails` hash table, referencing the strings of the record that owns them
+    void addEmail(const std::string& email, symbol_id username){
+        email_entry entry;
+        entry.email=&email;
+        entry.username=username;
+        emails.insert(key_hash::hash(email), entry);
     }
 
-    // Loads student data from JSON file and populates the hash tables
-    void makeStudent_hashtable(int& size, std::ifstream &file){
-        njson data;
-        
-        file>>data;
-        for(const auto& user:data){
-            // 1. Create the student_data object
-            uint32_t index=fnv1a(user["username"])%size;
-
-            std::vector<std::string> classrooms;
-            if(user.contains("classroomIds") && user["classroomIds"].is_array()){
-                classrooms = user["classroomIds"].get<std::vector<std::string>>();
-            }
-
-            student_data* new_user=new student_data(user["name"], user["username"],user["email"],user["password"], classrooms);
-            
-            // 2. Insert into the `students` hash table (using separate chaining)
-            student_link* newnode=new student_link;
-            newnode->data=new_user;
-            // Add to the front of the linked list at this index
-            if(students[index]){
-                newnode->next = students[index];
-                students[index] = newnode;
-            }
-            else{
-                students[index]=newnode;
-            }
-
-            // 3. Insert into the `emails` hash table
-            index=fnv1a(user["email"])%(size*2);
-            std::string* new_email=new std::string(user["email"]);
-            std::string* new_username=new std::string(user["username"]);
-            email_link* email_node=new email_link;
-            email_node->email=new_email;
-            email_node->username=new_username;
-            // Add to the front of the linked list
-            if(emails[index]){
-                email_node->next=emails[index];
-                emails[index]=email_node;
-            }
-            else{
-                emails[index]=email_node;
-            }
-        }
+    // Claims `email` for `username` unless any user already has it: the check and the insert are one atomic storage operation
+    bool claimEmail(const std::string& email, symbol_id username){
+        email_entry entry;
+        entry.email=&email;
+        entry.username=username;
+        email_entry existing;
+        return emails.insert_if_absent(key_hash::hash(email), [&email](const email_entry& other){ return *(other.email)==email; }, entry, existing);
     }
 
-    // Loads teacher data from JSON file and populates the hash tables
-    void makeTeacher_hashtable(int& size, std::ifstream &file){
-        njson data;
-        
-        file>>data;
-        for(const auto& user:data){
-            // 1. Create the teacher_data object
-            uint32_t index=fnv1a(user["username"])%size;
-
-            std::vector<std::string> classrooms;
-            if(user.contains("classroomIds") && user["classroomIds"].is_array()){
-                classrooms = user["classroomIds"].get<std::vector<std::string>>();
-            }
-            teacher_data* new_user=new teacher_data(user["name"], user["username"],user["email"],user["password"], classrooms);
-
-            // 2. Insert into the `teachers` hash table
-            teacher_link* newnode=new teacher_link;
-            newnode->data=new_user;
-            if(teachers[index]){
-                newnode->next = teachers[index];
-                teachers[index] = newnode;
-            }
-            else{
-                teachers[index]=newnode;
-            }
-
-            // 3. Insert into the `emails` hash table
-            index=fnv1a(user["email"])%(size*2);
-            std::string* new_email=new std::string(user["email"]);
-            std::string* new_username=new std::string(user["username"]);
-            email_link* email_node=new email_link;
-            email_node->email=new_email;
-            email_node->username=new_username;
-            if(emails[index]){
-                email_node->next=emails[index];
-                emails[index]=email_node;
-            }
-            else{
-                emails[index]=email_node;
-            }
-        }
+    // Claims `username` for a new student or teacher unless any user already holds it: one atomic check-and-insert
+    bool claimUsername(symbol_id username){
+        symbol_id existing;
+        return usernames.insert_if_absent(symbol_hash::hash(username), [username](symbol_id other){ return other==username; }, username, existing);
     }
 
-public:
-    // Constructor: Initializes and populates the hash tables from files
-    user_hashTable(){
-        size=100;
-        // Allocate memory for the arrays of linked list heads
-        emails=new email_link*[size*2];
-        students=new student_link*[size];
-        teachers=new teacher_link*[size];
-
-        // Initialize all heads to nullptr
-        for(int i=0;i<size*2;i++){
-            emails[i]=nullptr;
-        }
-        for (int i = 0; i < size; ++i) {
-            students[i] = nullptr;
-            teachers[i] = nullptr;
-        }
+    // Gives back a claim taken by `claimUsername`
+    void dropUsernameClaim(symbol_id username){
+        symbol_id removed;
+        usernames.erase(symbol_hash::hash(username), [username](symbol_id other){ return other==username; }, removed);
+    }
 
-        // Open and read data files
-        std::ifstream studentFile("Data/students.json");
-        if(!studentFile.is_open()){
-            throw std::runtime_error("Could not open students.json");
-        }
+    // Gives `username` back once neither table has a record under it. Callers erase their record first, so of two records
+    // sharing a name (possible only in files written before names were shared) the last one erased releases it.
+    void releaseUsername(symbol_id username){
+        if(students.find(username) || teachers.find(username)) return;
+        dropUsernameClaim(username);
+    }
 
-        std::ifstream teacherFile("Data/teachers.json");
-        if(!teacherFile.is_open()){
-            throw std::runtime_error("Could not open teachers.json");
+    /*
+     * Creates a user in `table` unless the username is taken by any student or teacher or the email by any user, and returns
+     * nullptr in that case. `name`, `email` and `password` are moved into the record.
+     * The username is claimed first, then the record is inserted into `table`, then the email is claimed, each with one atomic
+     * check-and-insert, so of two concurrent signups with the same one only one succeeds, whichever tables they go to. A signup
+     * that loses the username never creates a record, so no other request can find one. A step that fails undoes the earlier
+     * ones in reverse order, and the claim this signup took is always the one it gives back. The record cannot be logged into
+     * before the email claim succeeds (login goes through the email).
+     */
+    template<typename Table>
+    typename Table::value_type* addUser(Table& table, std::string name, std::string_view username, std::string email, std::string password){
+        // The claims below decide; this early-out only keeps a signup with a taken email from interning a name that is never
+        // released (see `symbol_table`)
+        if(findUsername(email)) return nullptr;
+        symbol_id id=symbol_table::instance().intern(username);
+        if(!claimUsername(id)) return nullptr;
+        auto [new_user, inserted]=table.insert_if_absent(std::move(name), username, std::move(email), std::move(password));
+        if(!inserted){
+            dropUsernameClaim(id);
+            return nullptr;
         }
+        if(!claimEmail(new_user->credentials->email, id)){
+            table.erase(id);
+            dropUsernameClaim(id);
+            return nullptr;
+        }
+        return new_user;
+    }
 
-        makeStudent_hashtable(size, studentFile);
-        makeTeacher_hashtable(size, teacherFile);
+    // Removes the email entry that points at `email`, the text inside one record's credentials. Matching the entry by that
+    // address, not by username, never takes out another account's entry: a student and a teacher may share a username.
+    void removeEmail(const std::string& email){
+        email_entry removed;
+        emails.erase(key_hash::hash(email), [&email](const email_entry& entry){ return entry.email==&email; }, removed);
+    }
+
+public:
+    // Constructor: Initializes and populates the hash tables from files
+    // The initial bucket counts are only a floor; the tables presize from the files and grow on demand.
+    user_hashTable(): students(100), teachers(100), emails(200), usernames(200){
+        // Presize the email index and the username set from the record counts so building them never triggers a resize
+        emails.reserve(students.size()+teachers.size());
+        usernames.reserve(students.size()+teachers.size());
+        students.for_each([this](student_data* data){
+            addEmail(data->credentials->email, data->username);
+            claimUsername(data->username);
+        });
+        teachers.for_each([this](teacher_data* data){
+            addEmail(data->credentials->email, data->username);
+            claimUsername(data->username);
+        });
     }
 
 
@@ -237,195 +283,155 @@ public:
      * all students hash to the same index (a very bad hash function or
      * extreme bad luck).
      */
-    student_data* findStudent(const std::string& s){
-        uint32_t index=fnv1a(s)%size;
-        student_link* node=students[index];
-        // Traverse the linked list at this index
-        while(node){
-            if(node->data->username==s) return node->data;
-            node=node->next;
-        }
-        return nullptr; // Not found
+    student_data* findStudent(std::string_view s){
+        return students.find(s);    // nullptr if not found
+    }
+
+    // Finds a student by interned username (e.g. from a classroom roster); candidates are compared as integers
+    student_data* findStudent(symbol_id username){
+        return students.find(username);
+    }
+
+    /*
+     * Finds the students of a roster in one batch: entry `i` is the record of `usernames[i]`, or nullptr.
+     * Time Complexity: O(n) average, with the cache misses of different students overlapping (see `EntityTable::find_many`).
+     */
+    std::vector<student_data*> findStudents(const std::vector<symbol_id>& usernames){
+        return students.find_many(usernames);
     }
 
     // Finds a teacher by username. Same O(1) average complexity.
-    teacher_data* findTeacher(std::string& s){
-        uint32_t index=fnv1a(s)%size;
-        teacher_link* node=teachers[index];
-        while(node){
-            if(node->data->username==s) return node->data;
-            node=node->next;
-        }
-        return nullptr;
+    teacher_data* findTeacher(std::string_view s){
+        return teachers.find(s);
     }
 
     /*
-     * Adds a new student to the hash tables.
-     * Time Complexity: O(1) average. Involves two hash calculations
-     * and two O(1) linked list insertions (at the head).
+     * Whether `student` is still in the table, i.e. has not been erased. A route linking the student to another record checks
+     * this while holding the student's lock: the removal erases the record before it reads `classroomIds` under that lock to
+     * clean up, and changes to the list are only made under it, so the link is either made in time to be seen by the cleanup
+     * or not made at all.
+     * Time Complexity: O(1) average.
      */
-    void addStudent(student_data* new_user){
-        // Add to `students` table
-        uint32_t index=fnv1a(new_user->username)%size;
-        student_link* newnode=new student_link;
-        newnode->data=new_user;
-        if(students[index]){
-            newnode->next = students[index];
-            students[index] = newnode;
-        }
-        else{
-            students[index]=newnode;
-        }
+    bool isLive(const student_data& student){
+        return students.find(student.username)==&student;
+    }
 
-        // Add to `emails` table
-        index=fnv1a(new_user->email)%(size*2);
-        std::string* new_email=new std::string(new_user->email);
-        std::string* new_username=new std::string(new_user->username);
-        email_link* email_node=new email_link;
-        email_node->email=new_email;
-        email_node->username=new_username;
-        if(emails[index]){
-            email_node->next=emails[index];
-            emails[index]=email_node;
-        }
-        else{
-            emails[index]=email_node;
-        }
-        saveStudentsToFile();   // Persist change
+    // Same for a teacher, checked under the teacher's lock before linking a new classroom. O(1) average.
+    bool isLive(const teacher_data& teacher){
+        return teachers.find(teacher.username)==&teacher;
     }
 
-    // Adds a new teacher to the hash tables. O(1) average complexity.
-    void addTeacher(teacher_data* new_user){
-        // Add to `teachers` table
-        uint32_t index=fnv1a(new_user->username)%size;
-        teacher_link* newnode=new teacher_link;
-        newnode->data=new_user;
-        if(teachers[index]){
-            newnode->next = teachers[index];
-            teachers[index] = newnode;
-        }
-        else{
-            teachers[index]=newnode;
+    /*
+     * Creates a new student and adds it to the hash tables. The record is owned by the table.
+     * Returns nullptr if any student or teacher has the username or any user has the email; this holds under concurrent signups.
+     * Time Complexity: O(1) average. Involves two hash calculations (username and email)
+     * and three O(1) check-and-insert operations.
+     */
+    student_data* addStudent(std::string name, std::string_view username, std::string email, std::string password){
+        student_data* new_user=addUser(students, std::move(name), username, std::move(email), std::move(password));
+        if(new_user){
+            saveStudentsToFile();   // Persist change
         }
+        return new_user;
+    }
 
-        // Add to `emails` table
-        index=fnv1a(new_user->email)%(size*2);
-        std::string* new_email=new std::string(new_user->email);
-        std::string* new_username=new std::string(new_user->username);
-        email_link* email_node=new email_link;
-        email_node->email=new_email;
-        email_node->username=new_username;
-        if(emails[index]){
-            email_node->next=emails[index];
-            emails[index]=email_node;
-        }
-        else{
-            emails[index]=email_node;
+    // Creates a new teacher and adds it to the hash tables, or returns nullptr if the username (by any user) or email is taken. O(1) average complexity.
+    teacher_data* addTeacher(std::string name, std::string_view username, std::string email, std::string password){
+        teacher_data* new_user=addUser(teachers, std::move(name), username, std::move(email), std::move(password));
+        if(new_user){
+            saveTeachersToFile();   // Persist change
         }
+        return new_user;
+    }
+
+    /*
+     * Removes a student and their email entry. Returns false if the student is already gone (e.g. deleted by a concurrent request).
+     * The email entry goes first, while the record is still live: a request that starts after the record is retired must not
+     * find the entry any more, because it reads `credentials->email` of the record it points into, and epoch reclamation only
+     * waits for requests that began before the retire.
+     * The record stays readable until the caller's request ends (see `EntityTable::erase`), so the caller can still walk its
+     * `classroomIds` to take the student off those rosters.
+     * Time Complexity: O(1) average.
+     */
+    bool removeStudent(const student_data& student){
+        removeEmail(student.credentials->email);
+        if(!students.erase(student.username)) return false;
+        releaseUsername(student.username);
+        saveStudentsToFile();   // Persist change
+        return true;
+    }
+
+    // Removes a teacher and their email entry, in the same order as `removeStudent`. O(1) average complexity; the caller deals
+    // with the teacher's classrooms.
+    bool removeTeacher(const teacher_data& teacher){
+        removeEmail(teacher.credentials->email);
+        if(!teachers.erase(teacher.username)) return false;
+        releaseUsername(teacher.username);
         saveTeachersToFile();   // Persist change
+        return true;
     }
 
     /*
      * Finds a username by email. Used for checking if email is taken.
+     * Returns a view of the owning record's username (no copy is made), or nothing if the email is not registered.
      * Time Complexity: O(1) average.
      */
-    std::string* findUsername(std::string& theEmail){
-        uint32_t index=fnv1a(theEmail)%(size*2);
-        email_link* node=emails[index];
-        while(node){
-            if(*(node->email)==theEmail) return node->username;
-            node=node->next;
+    std::optional<std::string_view> findUsername(std::string_view theEmail){
+        email_entry found;
+        if(!emails.find(key_hash::hash(theEmail), [theEmail](const email_entry& entry){ return *(entry.email)==theEmail; }, found)){
+            return std::nullopt;
         }
-        return nullptr;
+        return found.username.view();
     }
 
-    // Saves all student data back to the JSON file
+    /*
+     * Saves all student data back to the JSON file.
+     * The record pointers are collected first and serialised after the table locks are released, because `to_json` takes each
+     * record's lock. Saves are serialised so an older snapshot never overwrites a newer one.
+     */
     void saveStudentsToFile(){
-        njson j = njson::array();
-        // Traverse the entire hash table array
-        for(int i=0;i<size;i++){ student_link* curr=students[i]; 
-            // Traverse each linked list
-            while(curr){ 
-                j.push_back(*(curr->data)); curr=curr->next;
-            } 
-        }
-        std::ofstream("Data/students.json") << j.dump(4);
+        students.save();
     }
 
     // Saves all teacher data back to the JSON file
     void saveTeachersToFile(){
-        njson j = njson::array();
-        for(int i=0;i<size;i++){ teacher_link* curr=teachers[i]; 
-            while(curr){
-                j.push_back(*(curr->data)); curr=curr->next; 
-            } 
-        }
-        std::ofstream("Data/teachers.json") << j.dump(4);
+        teachers.save();
+    }
+
+
+    // Bytes held by each table, for the memory report (see `MemoryUsage.hpp`). O(n) in the table's size.
+    memory_usage studentMemory(){
+        return students.memory();
+    }
+
+    memory_usage teacherMemory(){
+        return teachers.memory();
+    }
+
+    // The email index holds no text of its own, only its nodes. O(1).
+    memory_usage emailMemory(){
+        memory_usage usage;
+        usage.entities=emails.size();
+        usage.nodes=emails.memory_bytes();
+        return usage;
     }
 
+    // Likewise the set of taken usernames, whose text is in the `symbol_table`. O(1).
+    memory_usage usernameClaimMemory(){
+        memory_usage usage;
+        usage.entities=usernames.size();
+        usage.nodes=usernames.memory_bytes();
+        return usage;
+    }
 
-    // Destructor: Cleans up all dynamically allocated memory
+    // Destructor: Saves the data. The tables destruct their own records; the email entries only point into the records.
     ~user_hashTable(){
 
         std::cout<<"Saving user data to files..."<<std::endl;
 
         //saving
-        njson students_json_array=njson::array();
-        for(int i=0; i<size; ++i){
-            student_link* curr=students[i];
-            while(curr!=nullptr){
-                students_json_array.push_back(*(curr->data));
-                curr=curr->next;
-            }
-        }
-        std::ofstream studentFile("Data/students.json");
-        studentFile<<students_json_array.dump(4);
-        studentFile.close();
-
-        njson teachers_json_array=njson::array();
-        for(int i=0; i<size; ++i){
-            teacher_link* curr=teachers[i];
-            while(curr!=nullptr){
-                teachers_json_array.push_back(*(curr->data));
-                curr=curr->next;
-            }
-        }
-        std::ofstream teacherFile("Data/teachers.json");
-        teacherFile<<teachers_json_array.dump(4);
-        teacherFile.close();
-
-        // Deallocate students and teachers tables
-        for(int i=0;i<size;i++){
-            student_link* curr1=students[i];
-            while(curr1){
-                student_link* next=curr1->next;
-                delete curr1->data;
-                delete curr1;
-                curr1=next;
-            }
-            teacher_link* curr2=teachers[i];
-            while(curr2){
-                teacher_link* next=curr2->next;
-                delete curr2->data;
-                delete curr2;
-                curr2=next;
-            }
-        }
-        delete[] students;
-        delete[] teachers;
-
-        // Deallocate emails table
-        for(int i=0;i<size*2;i++){
-            email_link* curr=emails[i];
-            while(curr){
-                email_link* next=curr->next;
-                delete curr->email;
-                delete curr->username;
-                delete curr;
-                curr=next;
-            }
-        }
-        delete[] emails;
+        saveStudentsToFile();
+        saveTeachersToFile();
     }
 };
 
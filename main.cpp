@@ -33,8 +33,8 @@ int main(){
     // Tell Crow where to find the HTML template files
     crow::mustache::set_base("templates");
 
-    // Initialize the Crow application with Cookie and Session middleware
-    crow::App<crow::CookieParser,Session> app;
+    // Initialize the Crow application with Cookie and Session middleware, and one epoch read section per request (see `App`)
+    App app;
 
     // Enable the session middleware
     app.get_middleware<Session>();
@@ -96,10 +96,10 @@ int main(){
         std::string role=req_body.get("role");
 
         // O(1) average-case lookup in the `emails` hash table.
-        // This finds the username associated with the email.
-        std::string* user=user_table.findUsername(email);
+        // This finds the username associated with the email (a view into the user's record).
+        std::optional<std::string_view> found_user=user_table.findUsername(email);
 
-        if(!user){
+        if(!found_user){
             // Email not found in the hash table
             res.code = 303;
             res.add_header("Location", "/error");
@@ -109,25 +109,33 @@ int main(){
         bool login_success=false;
 
         std::string destination;
+        std::string user(*found_user);  // The one copy, kept for the session
 
         // Now that we have the username, we check the correct user type table
-        if(user){
+        // Students and teachers share one username namespace, so with the wrong role the lookup finds no record
+        {
             if(role=="student"){
                 // O(1) average-case lookup in the `students` hash table.
-                student_data* data=user_table.findStudent(*user);
+                student_data* data=user_table.findStudent(user);
                 // Check if the student exists and the password matches
-                if(data && data->password==pass){
-                    login_success=true;
-                    destination="student_dashboard";
+                if(data){
+                    std::shared_lock<std::shared_mutex> guard(data->lock);
+                    if(data->credentials->password==pass){
+                        login_success=true;
+                        destination="student_dashboard";
+                    }
                 }
             }
             else if(role=="teacher"){
                 // O(1) average-case lookup in the `teachers` hash table.
-                teacher_data* data=user_table.findTeacher(*user);
+                teacher_data* data=user_table.findTeacher(user);
                 // Check if the teacher exists and the password matches
-                if(data && data->password==pass){
-                    login_success=true;
-                    destination="teacher_dashboard";
+                if(data){
+                    std::shared_lock<std::shared_mutex> guard(data->lock);
+                    if(data->credentials->password==pass){
+                        login_success=true;
+                        destination="teacher_dashboard";
+                    }
                 }
             }
         }
@@ -135,7 +143,7 @@ int main(){
         if(login_success){
             // Store user info in the session
             auto& session=app.get_context<Session>(req);
-            session.set("username",*user);
+            session.set("username",user);
             session.set("user_type",role);
 
             res.code=303;
@@ -173,30 +181,26 @@ int main(){
         std::string pass=req_body.get("password");
         std::string role=req_body.get("role");
 
-        // O(1) average-case lookup to check if email is already taken.
-        if(user_table.findUsername(email)){
-            res.code = 303;
-            res.add_header("Location", "/error");
-            return res;
-        }
-
-        // Create the session for the new user
-        auto& session=app.get_context<Session>(req);
-        session.set("username",username);
-        session.set("user_type",role);
         res.code=303;
 
+        // O(1) average-case check-and-insert into both the user table and the `emails` table.
+        // Fails if the username or the email is already taken, even by a signup running at the same moment.
+        // The name, email and password are moved into the new record; only `username` is used afterwards.
+        bool created;
         if(role=="student"){
-            student_data* new_user=new student_data(name,username,email,pass);
-            // O(1) average-case insertion into both `students` and `emails` tables.
-            user_table.addStudent(new_user);
-            res.add_header("Location","/student_dashboard");
+            created=user_table.addStudent(std::move(name),username,std::move(email),std::move(pass))!=nullptr;
+            res.add_header("Location", created ? "/student_dashboard" : "/error");
         }
         else{
-            teacher_data* new_user=new teacher_data(name,username,email,pass);
-            // O(1) average-case insertion into both `teachers` and `emails` tables.
-            user_table.addTeacher(new_user);
-            res.add_header("Location","/teacher_dashboard");
+            created=user_table.addTeacher(std::move(name),username,std::move(email),std::move(pass))!=nullptr;
+            res.add_header("Location", created ? "/teacher_dashboard" : "/error");
+        }
+
+        // Create the session for the new user
+        if(created){
+            auto& session=app.get_context<Session>(req);
+            session.set("username",username);
+            session.set("user_type",role);
         }
         return res;
     });
@@ -296,10 +300,15 @@ int main(){
                 return crow::response(303, "/change_password?error=notfound");
             }
             // Check if the current password is correct
-            if (student->password == current_pass) {
-                student->password = new_pass; // Update password in memory
-                user_table.saveStudentsToFile(); // Save to students.json
-                password_updated = true;
+            {
+                std::unique_lock<std::shared_mutex> guard(student->lock);
+                if (student->credentials->password == current_pass) {
+                    student->credentials->password = new_pass; // Update password in memory
+                    password_updated = true;
+                }
+            }
+            if (password_updated) {
+                user_table.saveStudentsToFile(); // Save to students.json (after releasing the record lock)
             }
 
         } else if (user_type == "teacher") {
@@ -309,10 +318,15 @@ int main(){
                 return crow::response(303, "/change_password?error=notfound");
             }
             // Check if the current password is correct
-            if (teacher->password == current_pass) {
-                teacher->password = new_pass; // Update password in memory
-                user_table.saveTeachersToFile(); // Save to teachers.json
-                password_updated = true;
+            {
+                std::unique_lock<std::shared_mutex> guard(teacher->lock);
+                if (teacher->credentials->password == current_pass) {
+                    teacher->credentials->password = new_pass; // Update password in memory
+                    password_updated = true;
+                }
+            }
+            if (password_updated) {
+                user_table.saveTeachersToFile(); // Save to teachers.json (after releasing the record lock)
             }
         }
 
@@ -335,7 +349,11 @@ int main(){
 
     registerQuizRoutes(app,user_table, classroom_table, quiz_table);
 
-    registerQuizAttemptRoutes(app, quiz_table, result_table);
+    registerQuizAttemptRoutes(app, classroom_table, quiz_table, result_table);
+
+    registerRemovalRoutes(app, user_table, classroom_table, quiz_table, result_table);
+
+    registerAdminRoutes(app, user_table, classroom_table, quiz_table, result_table);
 
     // Start Server
     std::cout << "Server running at http://localhost:18080\n";
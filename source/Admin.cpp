@@ -0,0 +1,148 @@
+/*
+ * Description: Registers the admin-only Crow routes. `/admin/memory` reports how much memory each table holds, split into index
+ * nodes, records, strings and vectors (see `MemoryUsage.hpp`), with the bytes per entity and the size each table would reach at
+ * a given growth factor, so the servers can be sized from the figures of a real install.
+ *
+ * There are no admin accounts. An admin is a logged-in teacher whose username is listed, comma-separated, in the `EDUMAZE_ADMINS`
+ * environment variable, and who also sends the secret of `EDUMAZE_ADMIN_TOKEN` in the `X-Admin-Token` header. A username alone
+ * is not enough: a listed name that is not registered yet, or whose account was deleted, can be signed up by anyone. Both
+ * variables are read when the server starts; with either unset every request is refused.
+ *
+ * The report walks every table once (O(n) in the number of records) when it is requested; nothing is counted on other requests.
+ */
+
+#include "Common_Route.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <unordered_set>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace {
+
+// The usernames in `EDUMAZE_ADMINS`, e.g. "alice,bob"
+std::unordered_set<std::string> readAdmins(){
+    std::unordered_set<std::string> admins;
+    const char* list=std::getenv("EDUMAZE_ADMINS");
+    if(!list) return admins;
+    std::string_view rest(list);
+    while(!rest.empty()){
+        size_t comma=rest.find(',');
+        std::string_view name=rest.substr(0, comma);
+        if(!name.empty()) admins.emplace(name);
+        if(comma==std::string_view::npos) break;
+        rest.remove_prefix(comma+1);
+    }
+    return admins;
+}
+
+// Compares a secret in time independent of where the first difference is, so the response time leaks nothing about `expected`
+bool sameSecret(std::string_view given, std::string_view expected){
+    unsigned char diff=given.size()==expected.size() ? 0 : 1;
+    for(size_t i=0;i<expected.size();i++){
+        diff|=static_cast<unsigned char>(expected[i]^(i<given.size() ? given[i] : 0));
+    }
+    return diff==0;
+}
+
+// Resident set size of the server process, to compare with what the tables account for; 0 if it cannot be read (or off Linux)
+size_t residentBytes(){
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    size_t pages=0, resident=0;
+    if(!(statm>>pages>>resident)) return 0;
+    return resident*static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+// One table's row of the report. `growth` scales the current entity count for the projection.
+njson usageRow(const memory_usage& usage, double growth){
+    double per_entity=usage.entities ? static_cast<double>(usage.total())/usage.entities : 0.0;
+    return njson{
+        {"entities", usage.entities},
+        {"bytes", {
+            {"nodes", usage.nodes},
+            {"records", usage.records},
+            {"strings", usage.strings},
+            {"vectors", usage.vectors},
+            {"total", usage.total()}
+        }},
+        {"bytes_per_entity", per_entity},
+        {"projected", {
+            {"entities", static_cast<size_t>(usage.entities*growth)},
+            {"bytes", static_cast<size_t>(usage.total()*growth)}
+        }}
+    };
+}
+
+}
+
+/*
+ * Registers all admin-only routes.
+ */
+void registerAdminRoutes(App& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table, quiz_result_hashTable& results_table){
+    // Read once: changing the admins or the token takes a restart
+    static const std::unordered_set<std::string> admins=readAdmins();
+    static const std::string token=[]{
+        const char* secret=std::getenv("EDUMAZE_ADMIN_TOKEN");
+        return std::string(secret ? secret : "");
+    }();
+    // Projections beyond this many times the current size are not a sizing question any more
+    static constexpr double MAX_GROWTH=1000.0;
+
+    /*
+     * Route: /admin/memory?growth=<factor>
+     * Description: (Admin) Reports the memory held by each table as JSON, and the projected size of each at `growth` times its
+     * current entity count (default 2, at most MAX_GROWTH). The projection is linear in the bytes per entity measured now.
+     */
+    CROW_ROUTE(app, "/admin/memory")
+    ([&app, &user_table, &classroom_table, &quiz_table, &results_table](const crow::request& req) -> crow::response {
+        auto& session=app.get_context<Session>(req);
+        std::string username=session.get<std::string>("username");
+        if(session.get<std::string>("user_type")!="teacher" || username.empty() || !admins.count(username)
+           || token.empty() || !sameSecret(req.get_header_value("X-Admin-Token"), token)){
+            return crow::response(403, "Admins only.");
+        }
+
+        double growth=2.0;
+        if(const char* factor=req.url_params.get("growth")){
+            char* end=nullptr;
+            growth=std::strtod(factor, &end);
+            // Rejects "inf" and "nan" too: the projected sizes are converted to integers
+            if(end==factor || *end!='\0' || !std::isfinite(growth) || growth<=0.0 || growth>MAX_GROWTH){
+                return crow::response(400, "growth must be a number greater than 0 and at most 1000.");
+            }
+        }
+
+        std::pair<const char*, memory_usage> tables[]={
+            {"students", user_table.studentMemory()},
+            {"teachers", user_table.teacherMemory()},
+            {"emails", user_table.emailMemory()},
+            {"username_claims", user_table.usernameClaimMemory()},
+            {"usernames", symbol_table::instance().memory()},
+            {"classrooms", classroom_table.memoryUsage()},
+            {"quizzes", quiz_table.memoryUsage()},
+            {"questions", quiz_table.questionMemoryUsage()},
+            {"results", results_table.memoryUsage()}
+        };
+
+        njson report;
+        memory_usage all;
+        for(const auto& [name, usage]:tables){
+            report["tables"][name]=usageRow(usage, growth);
+            all+=usage;
+        }
+        report["total_bytes"]=all.total();
+        report["projected_total_bytes"]=static_cast<size_t>(all.total()*growth);
+        report["growth"]=growth;
+        report["process_resident_bytes"]=residentBytes();
+
+        crow::response res(200, report.dump(2));
+        res.set_header("Content-Type", "application/json");
+        return res;
+    });
+}
@@ -3,14 +3,39 @@
  */
 
 #include "Common_Route.hpp"
+#include <cctype>
 
 using njson = nlohmann::json;
 
+namespace {
+
+// Students and quizzes shown per page of `/classroom/<code>`
+constexpr size_t CLASSROOM_PAGE_SIZE = 50;
+
+// Percent-encodes `text` for a query parameter (a pagination cursor holds a username or a quiz title)
+std::string urlEncode(std::string_view text) {
+    static const char digits[] = "0123456789ABCDEF";
+    std::string encoded;
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            encoded += static_cast<char>(c);
+        } else {
+            encoded += '%';
+            encoded += digits[c >> 4];
+            encoded += digits[c & 15];
+        }
+    }
+    return encoded;
+}
+
+}
+
 /*
  * `to_json` overload for `classroom_data`.
  * Called by nlohmann::json when serializing a classroom (e.g., saving to file).
  */
 void to_json(njson& j, const classroom_data& c) {
+    std::shared_lock<std::shared_mutex> guard(c.lock);
     j = njson{
         {"class_name", c.class_name},
         {"subject", c.subject},
@@ -24,7 +49,7 @@ void to_json(njson& j, const classroom_data& c) {
 /*
  * Registers all routes related to classroom management (for both teachers and students).
  */
-void registerClassroomRoutes(crow::App<crow::CookieParser,Session>& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table){
+void registerClassroomRoutes(App& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table){
 
     /*
      * Route: /create_classroom (GET)
@@ -79,11 +104,25 @@ void registerClassroomRoutes(crow::App<crow::CookieParser,Session>& app, user_ha
             return res;
         }
 
-        // O(1) average-case insertion
-        std::string new_class_code=classroom_table.addClassroom(classname,subject,teacher);
-
-        // Link the new classroom to the teacher
-        teacher->classroomIds.push_back(new_class_code);
+        // O(1) average-case insertion; the name and subject are moved into the new record
+        entity_id new_class_code=classroom_table.addClassroom(std::move(classname),std::move(subject),teacher);
+
+        // Link the new classroom to the teacher, unless the teacher's account was deleted meanwhile: its cleanup would never see
+        // the new code, so the classroom is taken out again instead
+        bool linked;
+        {
+            std::unique_lock<std::shared_mutex> guard(teacher->lock);
+            linked=user_table.isLive(*teacher);
+            if(linked){
+                teacher->classroomIds.push_back(new_class_code);
+            }
+        }
+        if(!linked){
+            classroom_table.removeClassroom(new_class_code);
+            crow::response res(303);
+            res.add_header("Location", "/error");
+            return res;
+        }
 
         // Persist changes
         user_table.saveTeachersToFile();
@@ -91,7 +130,7 @@ void registerClassroomRoutes(crow::App<crow::CookieParser,Session>& app, user_ha
 
         // Redirect to a success page displaying the new code
         crow::response res(303);
-        res.add_header("Location","/classroom_created?code="+new_class_code);
+        res.add_header("Location","/classroom_created?code="+new_class_code.to_string());
         return res;
 
     });
@@ -103,7 +142,7 @@ void registerClassroomRoutes(crow::App<crow::CookieParser,Session>& app, user_ha
     CROW_ROUTE(app,"/classroom_created")([](const crow::request& req){
         const char* code = req.url_params.get("code");
 
-        if (!code || std::string(code).empty()) {
+        if (!code || code[0] == '\0') {
             crow::response res(303);
             res.add_header("Location", "/error");
             return res;
@@ -137,21 +176,17 @@ void registerClassroomRoutes(crow::App<crow::CookieParser,Session>& app, user_ha
         }
 
         crow::mustache::context ctx;
-        ctx["teacher_username"] = teacher->username;
+        ctx["teacher_username"] = teacher->username.str();
 
         std::vector<crow::json::wvalue> classrooms_list;
 
-        // Iterate through the teacher's list of class codes
-        for (const auto& class_code : teacher->classroomIds) {
-            // O(1) average-case lookup for each class
-            classroom_data* room = classroom_table.findClassroom(class_code);
-            if (room) {
-                crow::json::wvalue classroom_obj;
-                classroom_obj["class_name"] = room->class_name;
-                classroom_obj["subject"] = room->subject;
-                classroom_obj["class_code"] = room->class_code;
-                classrooms_list.push_back(std::move(classroom_obj));
-            }
+        // One range scan of the name index gives the teacher's classrooms already sorted by name
+        for (classroom_data* room : classroom_table.classroomsByName(teacher->username)) {
+            crow::json::wvalue classroom_obj;
+            classroom_obj["class_name"] = room->class_name;
+            classroom_obj["subject"] = room->subject;
+            classroom_obj["class_code"] = room->class_code.to_string();
+            classrooms_list.push_back(std::move(classroom_obj));
         }
 
         if (!classrooms_list.empty()) {
@@ -164,9 +199,10 @@ void registerClassroomRoutes(crow::App<crow::CookieParser,Session>& app, user_ha
 
 
     /*
-     * Route: /classroom/<string>
+     * Route: /classroom/<string>?students_after=<username>&quizzes_after=<cursor>
      * Description: (Teacher) Displays a detailed view of a single classroom,
-     * showing the list of students and quizzes.
+     * showing the list of students (by username) and quizzes (by title), one page of each at a time.
+     * A page starts after the cursor in its query parameter; the page's "next" link carries the cursor of its last entry.
      */
     CROW_ROUTE(app, "/classroom/<string>")
     ([&app, &user_table, &classroom_table, &quiz_table](const crow::request& req, const std::string& class_code) -> crow::response {
@@ -186,40 +222,65 @@ void registerClassroomRoutes(crow::App<crow::CookieParser,Session>& app, user_ha
         crow::mustache::context ctx;
         ctx["class_name"] = room->class_name;
         ctx["subject"] = room->subject;
-        ctx["class_code"] = room->class_code;
+        std::string code_text = room->class_code.to_string();
+        ctx["class_code"] = code_text;
+
+        // The cursors of the pages shown; each list's "next" link keeps the other list where it is
+        const char* students_after = req.url_params.get("students_after");
+        const char* quizzes_after = req.url_params.get("quizzes_after");
+        std::string students_at = students_after ? students_after : "";
+        std::string quizzes_at = quizzes_after ? quizzes_after : "";
+
+        // One page of the roster in username order, from the classroom's ordered index
+        std::vector<symbol_id> roster_page;
+        bool more_students = false;
+        {
+            std::shared_lock<std::shared_mutex> room_guard(room->lock);
+            ctx["student_count"] = room->student_usernames.size();
+            roster_page = room->student_usernames.page_by_name(students_at, CLASSROOM_PAGE_SIZE, more_students);
+        }
 
-        // Populate the list of students in the classroom
+        // Populate the list of students on this page
+        // One batched lookup for the page, so the students' cache misses overlap
         std::vector<crow::json::wvalue> students_list;
-        for (const auto& student_username : room->student_usernames) {
-            // O(1) average-case lookup for each student
-            student_data* student = user_table.findStudent(student_username);
+        for (student_data* student : user_table.findStudents(roster_page)) {
             if (student) {
                 crow::json::wvalue student_obj;
                 student_obj["name"] = student->name;
-                student_obj["username"] = student->username;
+                student_obj["username"] = student->username.str();
                 students_list.push_back(std::move(student_obj));
             }
         }
         if (!students_list.empty()) {
             ctx["students"] = std::move(students_list);
         }
+        if (more_students) {
+            ctx["students_next"] = "/classroom/" + code_text + "?students_after=" + urlEncode(roster_page.back().view()) +
+                                   "&quizzes_after=" + urlEncode(quizzes_at);
+        }
 
-        // Populate the list of quizzes in the classroom
+        // Populate the list of quizzes on this page: a range scan of the quiz table's (classroom, title) index
+        bool more_quizzes = false;
+        std::vector<quiz_data*> quiz_page = quiz_table.quizzesByTitle(room->class_code, quizzes_at, CLASSROOM_PAGE_SIZE, more_quizzes);
         std::vector<crow::json::wvalue> quizzes_list;
-        for (const auto& quiz_id : room->quizIds) {
-            // O(1) average-case lookup for each quiz
-            quiz_data* quiz = quiz_table.findQuiz(quiz_id);
-            if (quiz) {
-                crow::json::wvalue quiz_obj;
-                quiz_obj["quizTitle"] = quiz->quizTitle;
-                quiz_obj["quizId"] = quiz->quizId;
-                quiz_obj["quizLink"] = "/quiz_leaderboard/" + quiz->quizId;
-                quizzes_list.push_back(std::move(quiz_obj));
-            }
+        for (quiz_data* quiz : quiz_page) {
+            crow::json::wvalue quiz_obj;
+            quiz_obj["quizTitle"] = quiz->quizTitle;
+            std::string quiz_id_text = quiz->quizId.to_string();
+            quiz_obj["quizId"] = quiz_id_text;
+            quiz_obj["quizLink"] = "/quiz_leaderboard/" + quiz_id_text;
+            quizzes_list.push_back(std::move(quiz_obj));
         }
         if (!quizzes_list.empty()) {
             ctx["quizzes"] = std::move(quizzes_list);
         }
+        if (more_quizzes) {
+            ctx["quizzes_next"] = "/classroom/" + code_text + "?students_after=" + urlEncode(students_at) +
+                                  "&quizzes_after=" + urlEncode(quiz_hashTable::quizCursor(*quiz_page.back()));
+        }
+        if (!students_at.empty() || !quizzes_at.empty()) {
+            ctx["first_page"] = "/classroom/" + code_text;
+        }
 
         auto page = crow::mustache::load("teacher/classroom_details.html");
         return crow::response(page.render(ctx));
@@ -269,7 +330,7 @@ void registerClassroomRoutes(crow::App<crow::CookieParser,Session>& app, user_ha
             res.add_header("Location", "/error");
             return res;
         }
-        std::string class_code(code_cstr);
+        std::string_view class_code(code_cstr);
 
         // O(1) average-case lookup to find the classroom
         classroom_data* classroom=classroom_table.findClassroom(class_code);
@@ -287,22 +348,30 @@ void registerClassroomRoutes(crow::App<crow::CookieParser,Session>& app, user_ha
             return res;
         }
 
-        // Check if student is already in the class
-        auto& students_in_class=classroom->student_usernames;
-        if (std::find(students_in_class.begin(), students_in_class.end(), username) != students_in_class.end()) {
-            return crow::response(303, "You are already in this classroom.");
+        // Add the student to the class unless they are already in it: an O(1) check in the roster's set.
+        // Both sides of the link are made under both locks (user first, then classroom), so two concurrent joins by the same
+        // student cannot both succeed, and a concurrent delete of the student or the classroom either sees the link when it
+        // cleans up or has already erased the record, in which case nothing is linked.
+        {
+            std::unique_lock<std::shared_mutex> student_guard(student->lock);
+            std::unique_lock<std::shared_mutex> room_guard(classroom->lock);
+            if (!user_table.isLive(*student) || !classroom_table.isLive(*classroom)) {
+                crow::response res(303);
+                res.add_header("Location", "/error");
+                return res;
+            }
+            if (!classroom->student_usernames.insert(student->username)) {
+                return crow::response(303, "You are already in this classroom.");
+            }
+            student->classroomIds.push_back(classroom->class_code);    // Add class to student
         }
 
-        // Create the two-way link
-        classroom->student_usernames.push_back(username);   // Add student to class
-        student->classroomIds.push_back(class_code);    // Add class to student
-
         // Persist changes
         classroom_table.saveClassroomsToFile();
         user_table.saveStudentsToFile();
 
         crow::response res(303);
-        res.add_header("Location", "/classroom_joined?code="+class_code);
+        res.add_header("Location", "/classroom_joined?code="+classroom->class_code.to_string());
         return res;
 
     });
@@ -322,7 +391,7 @@ void registerClassroomRoutes(crow::App<crow::CookieParser,Session>& app, user_ha
         const char* class_code = req.url_params.get("code");
 
         // O(1) average-case lookup
-        classroom_data* room=classroom_table.findClassroom(class_code);
+        classroom_data* room=class_code ? classroom_table.findClassroom(class_code) : nullptr;
         if(!room){
             crow::response res(303);
             res.add_header("Location", "/error");
@@ -331,7 +400,7 @@ void registerClassroomRoutes(crow::App<crow::CookieParser,Session>& app, user_ha
 
         crow::mustache::context ctx;
         ctx["class_name"]=room->class_name;
-        ctx["class_code"]=room->class_code;
+        ctx["class_code"]=room->class_code.to_string();
 
         auto page=crow::mustache::load("student/classroom_joined.html");
         return crow::response(page.render(ctx));
@@ -357,20 +426,21 @@ void registerClassroomRoutes(crow::App<crow::CookieParser,Session>& app, user_ha
 
         crow::mustache::context ctx;
         ctx["class_name"]=room->class_name;
-        ctx["class_code"]=room->class_code;
+        ctx["class_code"]=room->class_code.to_string();
         ctx["subject"]=room->subject;
 
         std::vector<crow::json::wvalue> quizzes_list;
         // Iterate through the classroom's quiz IDs
-        for(const auto& quiz_id: room->quizIds){
-            // O(1) average-case lookup for each quiz
-            quiz_data* quiz=quiz_table.findQuiz(quiz_id);
+        std::shared_lock<std::shared_mutex> room_guard(room->lock);
+        // One batched lookup for all of them
+        for(quiz_data* quiz: quiz_table.findQuizzes(room->quizIds)){
             if(quiz){
                 crow::json::wvalue quiz_obj;
                 quiz_obj["quizTitle"]=quiz->quizTitle;
-                quiz_obj["quizId"]=quiz->quizId;
+                std::string quiz_id_text=quiz->quizId.to_string();
+                quiz_obj["quizId"]=quiz_id_text;
                 quiz_obj["timeLimitMins"]=quiz->timeLimitMins;
-                quiz_obj["quizLink"] = "/student/attempt_quiz/" + quiz->quizId;
+                quiz_obj["quizLink"] = "/student/attempt_quiz/" + quiz_id_text;
                 quizzes_list.push_back(std::move(quiz_obj));
             }
         }
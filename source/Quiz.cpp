@@ -9,7 +9,7 @@ using njson=nlohmann::json;
 
 /*
  * `to_json` overload for `Question`.
- * Used when serializing a `quiz_data` object, which contains a vector of Questions.
+ * Stored quizzes hold a `quiz_questions` block instead, which writes the same format (see `QuizQuestions.hpp`).
  */
 void to_json(njson& j, const Question& q) {
     j=njson{
@@ -48,17 +48,18 @@ void to_json(njson& j, const quiz_data& q) {
  * Called by nlohmann::json when deserializing a quiz (e.g., loading from file).
  */
 void from_json(const njson& j, quiz_data& q) {
-    q.quizId = j.value("quizId", "");
+    q.quizId = j.value("quizId", entity_id());
     q.quizTitle = j.value("quizTitle", "");
-    q.classroomId = j.value("classroomId", "");
+    q.classroomId = j.value("classroomId", entity_id());
     q.timeLimitMins = j.value("timeLimitMinutes", 0);
-    q.questions = j.value("questions", std::vector<Question>{});
+    auto questions = j.find("questions");
+    q.questions = questions != j.end() ? quiz_questions::from_json(*questions) : quiz_questions();
 }
 
 /*
  * Registers all routes related to quiz creation.
  */
-void registerQuizRoutes(crow::App<crow::CookieParser,Session>& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table){
+void registerQuizRoutes(App& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table){
 
     /*
      * Route: /create_quiz (GET)
@@ -89,14 +90,14 @@ void registerQuizRoutes(crow::App<crow::CookieParser,Session>& app, user_hashTab
         crow::mustache::context ctx;
         std::vector<crow::json::wvalue> classrooms_for_template;
 
-        // Iterate through the teacher's classrooms to list them in the form
-        for(const auto& class_code: teacher->classroomIds){
+        // Iterate through the teacher's classrooms to list them in the form (a snapshot, read without the teacher's lock)
+        for(const auto& class_code: teacher->classroomIds.read()){
             // O(1) average-case lookup for each classroom
             classroom_data* room = classroom_table.findClassroom(class_code);
 
             if(room){
                 crow::json::wvalue classroom_obj = crow::json::wvalue::object();
-                classroom_obj["class_code"] = room->class_code;
+                classroom_obj["class_code"] = room->class_code.to_string();
                 classroom_obj["class_name"] = room->class_name;
                 classroom_obj["subject"] = room->subject;
                 classrooms_for_template.push_back(std::move(classroom_obj));
@@ -132,7 +133,10 @@ void registerQuizRoutes(crow::App<crow::CookieParser,Session>& app, user_hashTab
             time_limit = std::stoi(body_params.get("time_limit"));
         }
 
-        if (quiz_title.empty() || classroom_id.empty() || time_limit <= 0) {
+        // Class codes are decoded once here; the tables key on the integer form
+        entity_id classroom_key = entity_id::from_string(classroom_id);
+
+        if (quiz_title.empty() || !classroom_key.valid() || time_limit <= 0) {
             return crow::response(400, "Invalid form data.");
         }
 
@@ -151,32 +155,45 @@ void registerQuizRoutes(crow::App<crow::CookieParser,Session>& app, user_hashTab
             std::string correct_ans_key = "correct_answer_" + std::to_string(i);
             new_question.correctAnswerIndex = std::stoi(body_params.get(correct_ans_key));
 
-            // Parse the 4 options for this question
+            // Parse the 4 options for this question, constructing each string in place
+            new_question.options.reserve(4);
             for (int j = 0; j < 4; ++j) {
                 std::string option_key = "option_" + std::to_string(i) + "_" + std::to_string(j);
-                new_question.options.push_back(body_params.get(option_key));
+                new_question.options.emplace_back(body_params.get(option_key));
             }
-            questions_list.push_back(new_question);
+            // Moved, not copied, into the list
+            questions_list.push_back(std::move(new_question));
         }
 
         if (questions_list.empty()) {
             return crow::response(400, "A quiz must have at least one question.");
         }
 
-        // O(1) average-case insertion into the quiz hash table
-        quiz_data* new_quiz = quiz_table.createQuiz(quiz_title, classroom_id, time_limit, questions_list);
-
         // O(1) average-case lookup to find the classroom
-        classroom_data* classroom = classroom_table.findClassroom(classroom_id);
-
-        if (classroom) {
-            // Link the quiz to the classroom
-            classroom->quizIds.push_back(new_quiz->quizId);
-        } else {
+        classroom_data* classroom = classroom_table.findClassroom(classroom_key);
+        if (!classroom) {
             // This should ideally not happen if the form is correct
             return crow::response(500, "Could not find classroom.");
         }
 
+        // O(1) average-case insertion into the quiz hash table; the title is moved into the new record
+        quiz_data* new_quiz = quiz_table.createQuiz(std::move(quiz_title), classroom_key, time_limit, questions_list);
+
+        // Link the quiz to the classroom, unless the classroom was deleted meanwhile: its cleanup would never see the new quiz,
+        // so the quiz is taken out again instead
+        bool linked;
+        {
+            std::unique_lock<std::shared_mutex> room_guard(classroom->lock);
+            linked = classroom_table.isLive(*classroom);
+            if (linked) {
+                classroom->quizIds.push_back(new_quiz->quizId);
+            }
+        }
+        if (!linked) {
+            quiz_table.removeQuiz(new_quiz->quizId);
+            return crow::response(500, "Could not find classroom.");
+        }
+
         // Persist the changes to disk
         quiz_table.saveQuizzesToFile();
         classroom_table.saveClassroomsToFile();
@@ -91,7 +91,8 @@ std::map<int, int> parseQuizAnswers(const std::string& body) {
  * Registers all routes related to a student taking a quiz.
  */
 void registerQuizAttemptRoutes(
-    crow::App<crow::CookieParser,Session>& app, 
+    App& app, 
+    classroom_hashTable& classroom_table,
     quiz_hashTable& quiz_table,
     quiz_result_hashTable& results_table
 ) {
@@ -102,7 +103,7 @@ void registerQuizAttemptRoutes(
      * This is where the student actively takes the quiz.
      */
     CROW_ROUTE(app, "/student/attempt_quiz/<string>")
-    ([&app, &quiz_table, &results_table](const crow::request& req, const std::string& quiz_id) -> crow::response {
+    ([&app, &classroom_table, &quiz_table, &results_table](const crow::request& req, const std::string& quiz_id) -> crow::response {
         auto& session = app.get_context<Session>(req);
         std::string user_type = session.get<std::string>("user_type");
         std::string username = session.get<std::string>("username");
@@ -111,9 +112,11 @@ void registerQuizAttemptRoutes(
             return crow::response(303, "/error");
         }
 
+        entity_id quiz_key = entity_id::from_string(quiz_id);
+
         // O(N) Hash Table Scan
         // Check if the student has already taken this quiz.
-        if (results_table.hasStudentAttempted(username, quiz_id)) {
+        if (results_table.hasStudentAttempted(username, quiz_key)) {
             // Redirect to leaderboard if already taken
             crow::response res(303);
             res.add_header("Location", "/quiz_leaderboard/" + quiz_id + "?error=attempted");
@@ -121,14 +124,19 @@ void registerQuizAttemptRoutes(
         }
 
         // O(1) average-case lookup
-        quiz_data* quiz = quiz_table.findQuiz(quiz_id);
+        quiz_data* quiz = quiz_table.findQuiz(quiz_key);
         if (!quiz) {
             return crow::response(404, "/error");
         }
 
+        // O(1) average-case check in the classroom's roster set: only its students may take its quizzes
+        if (!classroom_table.isEnrolled(quiz->classroomId, symbol_table::instance().find(username))) {
+            return crow::response(403, "/error");
+        }
+
         crow::mustache::context ctx;
         ctx["quizTitle"] = quiz->quizTitle;
-        ctx["quizId"] = quiz->quizId;
+        ctx["quizId"] = quiz_id;
         ctx["timeLimitMins"] = quiz->timeLimitMins;
 
         // Capture the start time (in seconds) to calculate total time taken
@@ -138,21 +146,22 @@ void registerQuizAttemptRoutes(
         ctx["startTime"] = std::to_string(startTime);
 
         // Prepare quiz questions for the HTML template
+        // The texts are read as views into the quiz's question block; only the template context copies them
         std::vector<crow::json::wvalue> questions_list;
+        questions_list.reserve(quiz->questions.size());
         int q_index = 0;
-        for (const auto& q : quiz->questions) {
+        for (quiz_questions::question_view q : quiz->questions) {
             crow::json::wvalue question_obj;
-            question_obj["questionText"] = q.questionText;
+            question_obj["questionText"] = std::string(q.text());
             question_obj["questionIndex"] = q_index;
 
             std::vector<crow::json::wvalue> options_list;
-            int o_index = 0;
-            for (const auto& opt : q.options) {
+            options_list.reserve(q.option_count());
+            for (size_t o_index = 0; o_index < q.option_count(); ++o_index) {
                 crow::json::wvalue option_obj;
-                option_obj["optionText"] = opt;
-                option_obj["optionIndex"] = o_index;
+                option_obj["optionText"] = std::string(q.option(o_index));
+                option_obj["optionIndex"] = static_cast<int>(o_index);
                 options_list.push_back(std::move(option_obj));
-                o_index++;
             }
             question_obj["options"] = std::move(options_list);
             questions_list.push_back(std::move(question_obj));
@@ -170,7 +179,7 @@ void registerQuizAttemptRoutes(
      * It calculates the score, saves the result, and redirects to the leaderboard.
      */
     CROW_ROUTE(app, "/student/submit_quiz").methods("POST"_method)
-    ([&app, &quiz_table, &results_table](const crow::request& req) -> crow::response {
+    ([&app, &classroom_table, &quiz_table, &results_table](const crow::request& req) -> crow::response {
         auto& session = app.get_context<Session>(req);
         std::string user_type = session.get<std::string>("user_type");
         std::string username = session.get<std::string>("username");
@@ -203,9 +212,14 @@ void registerQuizAttemptRoutes(
         if (!quiz) {
             return crow::response(404, "Quiz not found.");
         }
+
+        // A student who left the classroom (or never joined it) cannot submit its quizzes
+        if (!classroom_table.isEnrolled(quiz->classroomId, symbol_table::instance().find(username))) {
+            return crow::response(403, "You are not enrolled in this quiz's classroom.");
+        }
         
         // Check for re-submission just in case
-        if (results_table.hasStudentAttempted(username, quiz_id)) {
+        if (results_table.hasStudentAttempted(username, quiz->quizId)) {
              return crow::response(303, "/quiz_leaderboard/" + quiz_id);
         }
 
@@ -220,14 +234,14 @@ void registerQuizAttemptRoutes(
                 int chosen_option = submitted_answers_map[i];
                 submitted_answers_vec[i] = chosen_option;   // Store their answer
                 // Check if the answer was correct
-                if (chosen_option == quiz->questions[i].correctAnswerIndex) {
+                if (chosen_option == quiz->questions[i].correct_answer()) {
                     score++;
                 }
             }
         }
 
-        // Save the result
-        results_table.addResult(quiz_id, username, score, timeTaken, submitted_answers_vec);
+        // Save the result; the answers are moved into it
+        results_table.addResult(quiz->quizId, username, score, timeTaken, std::move(submitted_answers_vec));
         results_table.saveResultsToFile(); 
 
         // Redirect to leaderboard
@@ -262,7 +276,7 @@ void registerQuizAttemptRoutes(
 
         // O(N) Hash Table Scan
         // Get all results for this specific quiz.
-        std::vector<quiz_result_data*> results = results_table.findResultsForQuiz(quiz_id);
+        std::vector<quiz_result_data*> results = results_table.findResultsForQuiz(quiz->quizId);
 
         // --- Use Priority Queue for Sorting ---
         // Time: O(k log k), where k is the number of results for *this* quiz.
@@ -295,7 +309,7 @@ void registerQuizAttemptRoutes(
 
             crow::json::wvalue res_obj;
             res_obj["rank"] = rank++;
-            res_obj["studentUsername"] = top_result->studentUsername;
+            res_obj["studentUsername"] = top_result->studentUsername.str();
             res_obj["score"] = top_result->score;
             
             // Format timeTaken to M:SS
@@ -0,0 +1,247 @@
+/*
+ * Description: Registers the Crow routes that delete things: a quiz, a classroom, a student leaving a classroom, and a whole account.
+ * Each route erases the record from its table and then removes every reference other records hold to it (`classroomIds`,
+ * `student_usernames`, `quizIds`, results, the email index), so no list is left pointing at something that no longer exists.
+ *
+ * Erased records are retired, not destroyed (see `EntityTable::erase`): other requests that already hold a pointer to one can
+ * finish with it, and the route itself reads the erased record's lists to know what to clean up.
+ * Locks are taken one record at a time here. Where two are held, as by /join_classroom_post, a user's is taken before a
+ * classroom's, never the other way round.
+ *
+ * Each route erases a record before it reads that record's lists under the record's lock. The routes that add to those lists
+ * (joining a classroom, creating a classroom or a quiz) check under the same lock that the record is still in its table
+ * (`isLive`), so a link made concurrently is either seen by the cleanup or never made.
+ */
+
+#include "Common_Route.hpp"
+#include <algorithm>
+
+namespace {
+
+crow::response redirectTo(const std::string& location){
+    crow::response res(303);
+    res.add_header("Location", location);
+    return res;
+}
+
+// Removes every occurrence of `value` from `list`; returns whether there was one
+template<typename T>
+bool eraseValue(std::vector<T>& list, const T& value){
+    auto tail=std::remove(list.begin(), list.end(), value);
+    bool found=tail!=list.end();
+    list.erase(tail, list.end());
+    return found;
+}
+
+/*
+ * Cleans up after a classroom that has been erased from its table: takes it off its students' `classroomIds` and deletes
+ * its quizzes and their results. The teacher's `classroomIds` is left to the caller.
+ * Time Complexity: O(S + q + N), for S students, q quizzes and N results in the system.
+ */
+void dropClassroom(classroom_data& room, user_hashTable& user_table, quiz_hashTable& quiz_table, quiz_result_hashTable& results_table){
+    // Copy the lists first, so no student lock is taken while the classroom's is held
+    std::vector<symbol_id> roster;
+    std::vector<entity_id> quiz_ids;
+    {
+        std::shared_lock<std::shared_mutex> room_guard(room.lock);
+        roster=room.student_usernames.members();
+        quiz_ids=room.quizIds;
+    }
+
+    for(student_data* student:user_table.findStudents(roster)){
+        if(!student) continue;
+        std::unique_lock<std::shared_mutex> student_guard(student->lock);
+        student->classroomIds.erase(room.class_code);
+    }
+
+    results_table.removeResultsForQuizzes(quiz_ids);
+    for(entity_id quizId:quiz_ids){
+        quiz_table.removeQuiz(quizId);
+    }
+}
+
+}
+
+/*
+ * Registers all routes that delete records and clean up their references.
+ */
+void registerRemovalRoutes(App& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table, quiz_result_hashTable& results_table){
+
+    /*
+     * Route: /delete_quiz/<string> (POST)
+     * Description: (Teacher) Deletes a quiz of one of their classrooms, with all its results.
+     */
+    CROW_ROUTE(app, "/delete_quiz/<string>").methods("POST"_method)
+    ([&app, &classroom_table, &quiz_table, &results_table](const crow::request& req, const std::string& quiz_id) -> crow::response {
+        auto& session=app.get_context<Session>(req);
+        std::string username=session.get<std::string>("username");
+        if(session.get<std::string>("user_type")!="teacher" || username.empty()){
+            return redirectTo("/error");
+        }
+
+        // O(1) average-case lookups of the quiz and the classroom it belongs to
+        quiz_data* quiz=quiz_table.findQuiz(quiz_id);
+        if(!quiz){
+            return redirectTo("/error");
+        }
+        classroom_data* room=classroom_table.findClassroom(quiz->classroomId);
+        // Only the teacher who owns the classroom may delete its quizzes
+        if(!room || room->teacher_username.view()!=username){
+            return redirectTo("/error");
+        }
+
+        // Of two concurrent deletes, only one gets past this
+        if(!quiz_table.removeQuiz(quiz->quizId)){
+            return redirectTo("/error");
+        }
+        {
+            std::unique_lock<std::shared_mutex> room_guard(room->lock);
+            eraseValue(room->quizIds, quiz->quizId);
+        }
+        results_table.removeResultsForQuizzes({quiz->quizId});
+
+        // Persist changes
+        quiz_table.saveQuizzesToFile();
+        classroom_table.saveClassroomsToFile();
+        results_table.saveResultsToFile();
+
+        return redirectTo("/classroom/"+room->class_code.to_string());
+    });
+
+    /*
+     * Route: /delete_classroom/<string> (POST)
+     * Description: (Teacher) Deletes one of their classrooms, its quizzes and their results, and takes it off every student's list.
+     */
+    CROW_ROUTE(app, "/delete_classroom/<string>").methods("POST"_method)
+    ([&app, &user_table, &classroom_table, &quiz_table, &results_table](const crow::request& req, const std::string& class_code) -> crow::response {
+        auto& session=app.get_context<Session>(req);
+        std::string username=session.get<std::string>("username");
+        if(session.get<std::string>("user_type")!="teacher" || username.empty()){
+            return redirectTo("/error");
+        }
+
+        teacher_data* teacher=user_table.findTeacher(username);
+        classroom_data* room=classroom_table.findClassroom(class_code);
+        if(!teacher || !room || room->teacher_username!=teacher->username){
+            return redirectTo("/error");
+        }
+
+        if(!classroom_table.removeClassroom(room->class_code)){
+            return redirectTo("/error");
+        }
+        dropClassroom(*room, user_table, quiz_table, results_table);
+        {
+            std::unique_lock<std::shared_mutex> teacher_guard(teacher->lock);
+            teacher->classroomIds.erase(room->class_code);
+        }
+
+        // Persist changes
+        classroom_table.saveClassroomsToFile();
+        user_table.saveStudentsToFile();
+        user_table.saveTeachersToFile();
+        quiz_table.saveQuizzesToFile();
+        results_table.saveResultsToFile();
+
+        return redirectTo("/my_classrooms");
+    });
+
+    /*
+     * Route: /leave_classroom/<string> (POST)
+     * Description: (Student) Leaves a classroom. Their past results stay on its leaderboards.
+     */
+    CROW_ROUTE(app, "/leave_classroom/<string>").methods("POST"_method)
+    ([&app, &user_table, &classroom_table](const crow::request& req, const std::string& class_code) -> crow::response {
+        auto& session=app.get_context<Session>(req);
+        std::string username=session.get<std::string>("username");
+        if(session.get<std::string>("user_type")!="student" || username.empty()){
+            return redirectTo("/error");
+        }
+
+        student_data* student=user_table.findStudent(username);
+        classroom_data* room=classroom_table.findClassroom(class_code);
+        if(!student || !room){
+            return redirectTo("/error");
+        }
+
+        // Undo both sides of the link made by /join_classroom_post, user first
+        {
+            std::unique_lock<std::shared_mutex> student_guard(student->lock);
+            if(!student->classroomIds.erase(room->class_code)){
+                return redirectTo("/error");
+            }
+        }
+        {
+            std::unique_lock<std::shared_mutex> room_guard(room->lock);
+            room->student_usernames.erase(student->username);
+        }
+
+        // Persist changes
+        classroom_table.saveClassroomsToFile();
+        user_table.saveStudentsToFile();
+
+        return redirectTo("/student_dashboard");
+    });
+
+    /*
+     * Route: /delete_account (POST)
+     * Description: Deletes the logged-in user and logs them out.
+     * - A student is taken off every classroom roster, and their results are deleted.
+     * - A teacher's classrooms are deleted as by /delete_classroom.
+     */
+    CROW_ROUTE(app, "/delete_account").methods("POST"_method)
+    ([&app, &user_table, &classroom_table, &quiz_table, &results_table](const crow::request& req) -> crow::response {
+        auto& session=app.get_context<Session>(req);
+        std::string user_type=session.get<std::string>("user_type");
+        std::string username=session.get<std::string>("username");
+
+        if(user_type=="student"){
+            student_data* student=user_table.findStudent(username);
+            // Erase first: a concurrent delete of the same account stops here
+            if(!student || !user_table.removeStudent(*student)){
+                return redirectTo("/error");
+            }
+            std::vector<entity_id> codes;
+            {
+                std::shared_lock<std::shared_mutex> student_guard(student->lock);
+                codes=student->classroomIds.read().to_vector();
+            }
+            for(classroom_data* room:classroom_table.findClassrooms(codes)){
+                if(!room) continue;
+                std::unique_lock<std::shared_mutex> room_guard(room->lock);
+                room->student_usernames.erase(student->username);
+            }
+            results_table.removeResultsForStudent(student->username);
+        }
+        else if(user_type=="teacher"){
+            teacher_data* teacher=user_table.findTeacher(username);
+            if(!teacher || !user_table.removeTeacher(*teacher)){
+                return redirectTo("/error");
+            }
+            std::vector<entity_id> codes;
+            {
+                std::shared_lock<std::shared_mutex> teacher_guard(teacher->lock);
+                codes=teacher->classroomIds.read().to_vector();
+            }
+            for(classroom_data* room:classroom_table.findClassrooms(codes)){
+                if(room && classroom_table.removeClassroom(room->class_code)){
+                    dropClassroom(*room, user_table, quiz_table, results_table);
+                }
+            }
+            quiz_table.saveQuizzesToFile();
+            user_table.saveStudentsToFile();
+        }
+        else{
+            return redirectTo("/error");
+        }
+
+        // Persist changes
+        classroom_table.saveClassroomsToFile();
+        results_table.saveResultsToFile();
+
+        // Log out, as /logout does
+        for(const auto& key:session.keys()){
+            session.remove(key);
+        }
+        return redirectTo("/welcome_page");
+    });
+}
@@ -11,10 +11,11 @@ using njson = nlohmann::json;
  * Called by nlohmann::json when serializing a student (e.g., saving to file).
  */
 void to_json(njson &j, const student_data &s){
+    std::shared_lock<std::shared_mutex> guard(s.lock);
     j=njson{
         {"name", s.name},
-        {"email", s.email},
-        {"password", s.password},
+        {"email", s.credentials->email},
+        {"password", s.credentials->password},
         {"username", s.username},
         {"classroomIds", s.classroomIds}
     };
@@ -23,7 +24,7 @@ void to_json(njson &j, const student_data &s){
 /*
  * Registers all routes that are primarily accessed by a student.
  */
-void registerStudentsRoutes(crow::App<crow::CookieParser,Session>& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table){
+void registerStudentsRoutes(App& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table){
 
     /*
      * Route: /student_dashboard
@@ -51,19 +52,19 @@ void registerStudentsRoutes(crow::App<crow::CookieParser,Session>& app, user_has
         }
         crow::mustache::context ctx;
         ctx["student_name"] = data->name;
-        ctx["student_username"] = data->username;
+        ctx["student_username"] = data->username.str();
 
         std::vector<crow::json::wvalue> classrooms_list;
 
-        // Iterate through the vector of class codes stored in the student's data
-        for(const auto& class_code: data->classroomIds){
+        // Iterate through the class codes stored in the student's data (a snapshot, read without the student's lock)
+        for(const auto& class_code: data->classroomIds.read()){
             // O(1) average-case hash table lookup for each classroom
             classroom_data* room=classroom_table.findClassroom(class_code);
             if(room){
                 crow::json::wvalue classroom_obj;
                 classroom_obj["class_name"]=room->class_name;
                 classroom_obj["subject"]=room->subject;
-                classroom_obj["class_code"]=room->class_code;
+                classroom_obj["class_code"]=room->class_code.to_string();
                 classrooms_list.push_back(std::move(classroom_obj));
             }
         }
@@ -102,29 +103,40 @@ void registerStudentsRoutes(crow::App<crow::CookieParser,Session>& app, user_has
         }
 
         crow::mustache::context ctx;
-        ctx["student_username"] = student->username;
+        ctx["student_username"] = student->username.str();
         
         std::vector<crow::json::wvalue> classrooms_list;
 
-        // Loop through all classrooms the student is in
-        for (const auto& class_code : student->classroomIds) {
-            // O(1) average-case lookup
-            classroom_data* room = classroom_table.findClassroom(class_code);
-            if (!room) continue;
+        // Loop through all classrooms the student is in (a snapshot of the list, read without the student's lock)
+        std::vector<classroom_data*> rooms = classroom_table.findClassrooms(student->classroomIds.read());
+
+        // Gather the quiz IDs of every classroom first so all the quizzes are looked up in one batch
+        std::vector<entity_id> quiz_ids;
+        std::vector<size_t> quiz_ends;  // quiz_ids[quiz_ends[r-1], quiz_ends[r]) belong to rooms[r]
+        for (classroom_data* room : rooms) {
+            if (room) {
+                std::shared_lock<std::shared_mutex> room_guard(room->lock);
+                quiz_ids.insert(quiz_ids.end(), room->quizIds.begin(), room->quizIds.end());
+            }
+            quiz_ends.push_back(quiz_ids.size());
+        }
+        std::vector<quiz_data*> quizzes = quiz_table.findQuizzes(quiz_ids);
+
+        for (size_t r = 0; r < rooms.size(); r++) {
+            if (!rooms[r]) continue;
 
             crow::json::wvalue classroom_obj;
-            classroom_obj["class_name"] = room->class_name;
+            classroom_obj["class_name"] = rooms[r]->class_name;
             
             std::vector<crow::json::wvalue> quizzes_list;
             
-            // Loop through all quizzes in that classroom
-            for (const auto& quiz_id : room->quizIds) {
-                // O(1) average-case lookup
-                quiz_data* quiz = quiz_table.findQuiz(quiz_id);
+            // The quizzes of this classroom, already looked up
+            for (size_t q = (r == 0 ? 0 : quiz_ends[r - 1]); q < quiz_ends[r]; q++) {
+                quiz_data* quiz = quizzes[q];
                 if (quiz) {
                     crow::json::wvalue quiz_obj;
                     quiz_obj["quizTitle"] = quiz->quizTitle;
-                    quiz_obj["quizLink"] = "/quiz_leaderboard/" + quiz->quizId; 
+                    quiz_obj["quizLink"] = "/quiz_leaderboard/" + quiz->quizId.to_string();
                     quizzes_list.push_back(std::move(quiz_obj));
                 }
             }
@@ -11,10 +11,11 @@ using njson = nlohmann::json;
  * This function is automatically called by the nlohmann::json library whenever a `teacher_data` object is serialized to JSON (e.g., when saving to a file).
  */
 void to_json(njson &j, const teacher_data &s){
+    std::shared_lock<std::shared_mutex> guard(s.lock);
     j=njson{
         {"name", s.name},
-        {"email", s.email},
-        {"password", s.password},
+        {"email", s.credentials->email},
+        {"password", s.credentials->password},
         {"username", s.username},
         {"classroomIds", s.classroomIds}
     };
@@ -24,7 +25,7 @@ void to_json(njson &j, const teacher_data &s){
  * Registers all routes that are primarily accessed by a teacher.
  * This function is called once from main.cpp to set up the web server.
  */
-void registerTeachersRoutes(crow::App<crow::CookieParser,Session>& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table){
+void registerTeachersRoutes(App& app, user_hashTable& user_table, classroom_hashTable& classroom_table, quiz_hashTable& quiz_table){
 
     /*
      * Route: /teacher_dashboard
@@ -55,7 +56,7 @@ void registerTeachersRoutes(crow::App<crow::CookieParser,Session>& app, user_has
         // Pass data to the HTML template
         crow::mustache::context ctx;
         ctx["teacher_name"] = data->name;
-        ctx["teacher_username"] = data->username;
+        ctx["teacher_username"] = data->username.str();
 
         auto page=crow::mustache::load("teacher/teacher_dashboard.html");
         return crow::response(page.render(ctx));
@@ -87,30 +88,41 @@ void registerTeachersRoutes(crow::App<crow::CookieParser,Session>& app, user_has
         }
 
         crow::mustache::context ctx;
-        ctx["teacher_username"] = teacher->username;
+        ctx["teacher_username"] = teacher->username.str();
 
         std::vector<crow::json::wvalue> classrooms_list;
 
-        // Iterate through the vector of class codes stored in the teacher's data
-        for (const auto& class_code : teacher->classroomIds) {
-            // O(1) average-case hash table lookup for each classroom
-            classroom_data* room = classroom_table.findClassroom(class_code);
-            if (!room) continue;
+        // Iterate through the class codes stored in the teacher's data (a snapshot, read without the teacher's lock)
+        std::vector<classroom_data*> rooms = classroom_table.findClassrooms(teacher->classroomIds.read());
+
+        // Gather the quiz IDs of every classroom first so all the quizzes are looked up in one batch
+        std::vector<entity_id> quiz_ids;
+        std::vector<size_t> quiz_ends;  // quiz_ids[quiz_ends[r-1], quiz_ends[r]) belong to rooms[r]
+        for (classroom_data* room : rooms) {
+            if (room) {
+                std::shared_lock<std::shared_mutex> room_guard(room->lock);
+                quiz_ids.insert(quiz_ids.end(), room->quizIds.begin(), room->quizIds.end());
+            }
+            quiz_ends.push_back(quiz_ids.size());
+        }
+        std::vector<quiz_data*> quizzes = quiz_table.findQuizzes(quiz_ids);
+
+        for (size_t r = 0; r < rooms.size(); r++) {
+            if (!rooms[r]) continue;
 
             crow::json::wvalue classroom_obj;
-            classroom_obj["class_name"] = room->class_name;
+            classroom_obj["class_name"] = rooms[r]->class_name;
             
             std::vector<crow::json::wvalue> quizzes_list;
             
-            // Iterate through the vector of quiz IDs stored in the classroom's data
-            for (const auto& quiz_id : room->quizIds) {
-                // O(1) average-case hash table lookup for each quiz
-                quiz_data* quiz = quiz_table.findQuiz(quiz_id);
+            // The quizzes of this classroom, already looked up
+            for (size_t q = (r == 0 ? 0 : quiz_ends[r - 1]); q < quiz_ends[r]; q++) {
+                quiz_data* quiz = quizzes[q];
                 if (quiz) {
                     crow::json::wvalue quiz_obj;
                     quiz_obj["quizTitle"] = quiz->quizTitle;
                     // Provide a direct link to the leaderboard for this specific quiz
-                    quiz_obj["quizLink"] = "/quiz_leaderboard/" + quiz->quizId; 
+                    quiz_obj["quizLink"] = "/quiz_leaderboard/" + quiz->quizId.to_string();
                     quizzes_list.push_back(std::move(quiz_obj));
                 }
             }